@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2018, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2018, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -23,10 +23,36 @@
 #include <config.h>
 #endif /* HAVE_CONFIG_H */
 
+#include <glib.h>
+
 #include "appliance.hh"
 #include "messages.h"
 
-static bool set_state(Maybe<bool> &state, bool new_state, const char *what)
+constexpr size_t AudioPath::StateTime::NUMBER_OF_VALUES;
+
+void AudioPath::StateTime::set(const Maybe<bool> &state, int64_t now_us)
+{
+    const Value value = state == true
+        ? Value::YES
+        : (state == false ? Value::NO : Value::UNKNOWN);
+
+    if(value == current_)
+        return;
+
+    if(now_us > since_us_)
+        total_us_[size_t(current_)] += now_us - since_us_;
+
+    current_ = value;
+    since_us_ = now_us;
+}
+
+AudioPath::Appliance::Appliance():
+    power_state_time_(g_get_monotonic_time()),
+    audio_path_state_time_(g_get_monotonic_time())
+{}
+
+static bool set_state(Maybe<bool> &state, bool new_state, const char *what,
+                      AudioPath::StateTime &state_time)
 {
     if(state == new_state)
     {
@@ -35,6 +61,7 @@ static bool set_state(Maybe<bool> &state, bool new_state, const char *what)
     }
 
     state = new_state;
+    state_time.set(state, g_get_monotonic_time());
 
     return true;
 }
@@ -42,29 +69,35 @@ static bool set_state(Maybe<bool> &state, bool new_state, const char *what)
 void AudioPath::Appliance::set_power_state_unknown()
 {
     is_up_and_running_.set_unknown();
+    power_state_time_.set(is_up_and_running_, g_get_monotonic_time());
 }
 
 bool AudioPath::Appliance::set_suspend_mode()
 {
-    return set_state(is_up_and_running_, false, "suspend mode");
+    return set_state(is_up_and_running_, false, "suspend mode",
+                     power_state_time_);
 }
 
 bool AudioPath::Appliance::set_up_and_running()
 {
-    return set_state(is_up_and_running_, true, "powered mode");
+    return set_state(is_up_and_running_, true, "powered mode",
+                     power_state_time_);
 }
 
 void AudioPath::Appliance::set_audio_path_unknown()
 {
     is_ready_for_playback_.set_unknown();
+    audio_path_state_time_.set(is_ready_for_playback_, g_get_monotonic_time());
 }
 
 bool AudioPath::Appliance::set_audio_path_ready()
 {
-    return set_state(is_ready_for_playback_, true, "audio path ready");
+    return set_state(is_ready_for_playback_, true, "audio path ready",
+                     audio_path_state_time_);
 }
 
 bool AudioPath::Appliance::set_audio_path_blocked()
 {
-    return set_state(is_ready_for_playback_, false, "audio path blocked");
+    return set_state(is_ready_for_playback_, false, "audio path blocked",
+                     audio_path_state_time_);
 }
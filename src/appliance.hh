@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2018, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2018, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -27,26 +27,87 @@
  */
 /*!@{*/
 
+#include <array>
+#include <cstdint>
+
 #include "maybe.hh"
 
 namespace AudioPath
 {
 
+/*!
+ * Time spent in each value of a state which may be unknown.
+ */
+class StateTime
+{
+  public:
+    enum class Value
+    {
+        UNKNOWN,
+        NO,
+        YES,
+
+        LAST_VALUE = YES,
+    };
+
+    static constexpr size_t NUMBER_OF_VALUES = size_t(Value::LAST_VALUE) + 1;
+
+  private:
+    std::array<uint64_t, NUMBER_OF_VALUES> total_us_;
+    Value current_;
+    int64_t since_us_;
+
+  public:
+    StateTime(const StateTime &) = delete;
+    StateTime &operator=(const StateTime &) = delete;
+
+    explicit StateTime(int64_t now_us):
+        current_(Value::UNKNOWN),
+        since_us_(now_us)
+    {
+        total_us_.fill(0);
+    }
+
+    void set(const Maybe<bool> &state, int64_t now_us);
+
+    /*!
+     * Total time spent in given value, including the current stretch.
+     */
+    uint64_t get_us(Value value, int64_t now_us) const
+    {
+        return total_us_[size_t(value)] +
+               (value == current_ && now_us > since_us_ ? now_us - since_us_ : 0);
+    }
+};
+
 class Appliance
 {
   private:
     Maybe<bool> is_up_and_running_;
     Maybe<bool> is_ready_for_playback_;
 
+    StateTime power_state_time_;
+    StateTime audio_path_state_time_;
+
   public:
     Appliance(const Appliance &) = delete;
     Appliance &operator=(const Appliance &) = delete;
 
-    explicit Appliance() {}
+    explicit Appliance();
 
     const Maybe<bool> &is_up_and_running() const { return is_up_and_running_; }
     const Maybe<bool> &is_audio_path_ready() const { return is_ready_for_playback_; }
 
+    /*!
+     * Time spent in suspend mode (\c NO) and up and running (\c YES).
+     */
+    const StateTime &get_power_state_time() const { return power_state_time_; }
+
+    /*!
+     * Time spent with the audio path blocked (\c NO) and ready (\c YES).
+     */
+    const StateTime &get_audio_path_state_time() const { return audio_path_state_time_; }
+
     void set_power_state_unknown();
     bool set_suspend_mode();
     bool set_up_and_running();
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -26,6 +26,9 @@
 #include <algorithm>
 
 #include "audiopath.hh"
+#include "probes.hh"
+
+constexpr size_t AudioPath::Paths::DEFAULT_CHANGE_LOG_CAPACITY;
 
 namespace AudioPath
 {
@@ -33,15 +36,21 @@ namespace AudioPath
 template <>
 struct AddItemTraits<Player>
 {
-    using MapType = std::map<const std::string, Player>;
+    using MapType = RegistryStorage<Player>;
     static MapType &get_map(Paths &paths) { return paths.players_; }
+    static void inserted(Paths &, const Player &) {}
 };
 
 template <>
 struct AddItemTraits<Source>
 {
-    using MapType = std::map<const std::string, Source>;
+    using MapType = RegistryStorage<Source>;
     static MapType &get_map(Paths &paths) { return paths.sources_; }
+
+    static void inserted(Paths &paths, const Source &source)
+    {
+        paths.sources_by_player_.emplace(source.player_id_, source.id_);
+    }
 };
 
 }
@@ -51,41 +60,63 @@ const T &AudioPath::Paths::add_item(T &&item, bool &inserted)
 {
     using Traits = AudioPath::AddItemTraits<T>;
 
-    std::string key(item.id_);
-
+    const ID key(item.id_);
     auto &map(Traits::get_map(*this));
-    auto it(map.find(key));
+    T *existing(map.find(key));
+
+    ++generation_;
 
-    if(it == map.end())
+    if(existing == nullptr)
     {
         inserted = true;
-        const auto result(map.emplace(std::move(key), std::move(item)));
-        return result.first->second;
+        const T &result(map.insert(std::move(item)));
+        Traits::inserted(*this, result);
+        return result;
     }
     else
     {
         inserted = false;
-        it->second.take_proxy_from(item);
-        return it->second;
+        existing->take_proxy_from(item);
+        return *existing;
     }
 }
 
 AudioPath::Paths::AddResult
 AudioPath::Paths::add_player(AudioPath::Player &&player)
 {
+    const auto *previous(players_.find(player.id_));
+    const bool revived(previous != nullptr && !previous->is_alive());
     bool inserted;
     const auto &p(add_item(std::move(player), inserted));
-    const bool have_path = std::find_if(sources_.begin(), sources_.end(),
-                                        [&p] (const decltype(Paths::sources_)::value_type &src)
-                                        {
-                                            return src.second.player_id_ == p.id_;
-                                        }) != sources_.end();
+    const auto range(sources_by_player_.equal_range(p.id_));
+    bool have_path = false;
 
-
-    if(!inserted)
-        return have_path ? AddResult::UPDATED_PATH : AddResult::UPDATED_COMPONENT;
+    if(range.first == range.second)
+        log_change(ID(), p.id_, false);
     else
-        return have_path ? AddResult::NEW_PATH : AddResult::NEW_COMPONENT;
+    {
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            /* dead audio sources are not listed as paths */
+            if(!sources_.find(it->second)->is_alive())
+                continue;
+
+            have_path = true;
+
+            if(inserted || revived)
+                log_change(it->second, ID(), true);
+
+            log_change(it->second, p.id_, false);
+        }
+    }
+
+    const AddResult result(!inserted
+                           ? (have_path ? AddResult::UPDATED_PATH : AddResult::UPDATED_COMPONENT)
+                           : (have_path ? AddResult::NEW_PATH : AddResult::NEW_COMPONENT));
+
+    TAPSWITCH_PROBE(player__added, p.id_.c_str(), int(result));
+
+    return result;
 }
 
 AudioPath::Paths::AddResult
@@ -93,42 +124,104 @@ AudioPath::Paths::add_source(AudioPath::Source &&source)
 {
     bool inserted;
     const auto &s(add_item(std::move(source), inserted));
-    const bool have_path(players_.find(s.player_id_) != players_.end());
+    const auto *player(players_.find(s.player_id_));
+    const bool have_path(player != nullptr && player->is_alive());
+
+    if(!have_path)
+        log_change(s.id_, ID(), false);
+    else
+    {
+        if(inserted && sources_by_player_.count(s.player_id_) == 1)
+            log_change(ID(), s.player_id_, true);
+
+        log_change(s.id_, s.player_id_, false);
+    }
 
-    if(!inserted)
-        return have_path ? AddResult::UPDATED_PATH : AddResult::UPDATED_COMPONENT;
+    const AddResult result(!inserted
+                           ? (have_path ? AddResult::UPDATED_PATH : AddResult::UPDATED_COMPONENT)
+                           : (have_path ? AddResult::NEW_PATH : AddResult::NEW_COMPONENT));
+
+    TAPSWITCH_PROBE(source__added, s.id_.c_str(), s.player_id_.c_str(),
+                    int(result));
+
+    return result;
+}
+
+template <typename T>
+static bool mark_dead(T *item)
+{
+    if(item == nullptr || !item->is_alive())
+        return false;
+
+    item->mark_dead();
+    return true;
+}
+
+bool AudioPath::Paths::mark_player_dead(const AudioPath::ID &player_id)
+{
+    if(!mark_dead(players_.find(player_id)))
+        return false;
+
+    ++generation_;
+
+    const auto range(sources_by_player_.equal_range(player_id));
+
+    if(range.first == range.second)
+        log_change(ID(), player_id, true);
     else
-        return have_path ? AddResult::NEW_PATH : AddResult::NEW_COMPONENT;
+    {
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(!sources_.find(it->second)->is_alive())
+                continue;
+
+            log_change(it->second, player_id, true);
+            log_change(it->second, ID(), false);
+        }
+    }
+
+    return true;
+}
+
+bool AudioPath::Paths::mark_source_dead(const AudioPath::ID &source_id)
+{
+    auto *source(sources_.find(source_id));
+
+    if(!mark_dead(source))
+        return false;
+
+    ++generation_;
+
+    const auto *player(players_.find(source->player_id_));
+
+    log_change(source_id,
+               player != nullptr && player->is_alive() ? player->id_ : ID(),
+               true);
+
+    return true;
 }
 
 const AudioPath::Player *
-AudioPath::Paths::lookup_player(const std::string &player_id) const
+AudioPath::Paths::lookup_player(const AudioPath::ID &player_id) const
 {
-    auto player(players_.find(player_id));
-    return (player != players_.end()) ? &player->second : nullptr;
+    return players_.find(player_id);
 }
 
 const AudioPath::Source *
-AudioPath::Paths::lookup_source(const std::string &source_id) const
+AudioPath::Paths::lookup_source(const AudioPath::ID &source_id) const
 {
-    auto source(sources_.find(source_id));
-    return (source != sources_.end()) ? &source->second : nullptr;
+    return sources_.find(source_id);
 }
 
 AudioPath::Paths::Path
-AudioPath::Paths::lookup_path(const std::string &source_id) const
+AudioPath::Paths::lookup_path(const AudioPath::ID &source_id) const
 {
     const auto *source(lookup_source(source_id));
 
     if(source == nullptr)
         return std::make_pair(nullptr, nullptr);
 
-    auto player(players_.find(source->player_id_));
-
-    if(player == players_.end())
-        return std::make_pair(source, nullptr);
-    else
-        return std::make_pair(source, &player->second);
+    return std::make_pair(source, players_.find(source->player_id_));
 }
 
 void AudioPath::Paths::for_each(const std::function<void(const AudioPath::Paths::Path &)> &apply,
@@ -138,45 +231,46 @@ void AudioPath::Paths::for_each(const std::function<void(const AudioPath::Paths:
 
     if(mode != ForEach::UNCONNECTED_PLAYERS)
     {
-        for(const auto &s : sources_)
-        {
-            const auto p(players_.find(s.second.player_id_));
-
-            if(p != players_.end())
+        sources_.for_each(
+            [this, &apply, &temp, mode] (const Source &s)
             {
-                switch(mode)
+                const auto *p(players_.find(s.player_id_));
+
+                if(p != nullptr)
                 {
-                  case ForEach::ANY:
-                  case ForEach::COMPLETE_PATHS:
-                    temp.first = &s.second;
-                    temp.second = &p->second;
-                    apply(temp);
-                    break;
+                    switch(mode)
+                    {
+                      case ForEach::ANY:
+                      case ForEach::COMPLETE_PATHS:
+                        temp.first = &s;
+                        temp.second = p;
+                        apply(temp);
+                        break;
 
-                  case ForEach::INCOMPLETE_PATHS:
-                  case ForEach::UNCONNECTED_SOURCES:
-                  case ForEach::UNCONNECTED_PLAYERS:
-                    break;
+                      case ForEach::INCOMPLETE_PATHS:
+                      case ForEach::UNCONNECTED_SOURCES:
+                      case ForEach::UNCONNECTED_PLAYERS:
+                        break;
+                    }
                 }
-            }
-            else
-            {
-                switch(mode)
+                else
                 {
-                  case ForEach::ANY:
-                  case ForEach::INCOMPLETE_PATHS:
-                  case ForEach::UNCONNECTED_SOURCES:
-                    temp.first = &s.second;
-                    temp.second = nullptr;
-                    apply(temp);
-                    break;
+                    switch(mode)
+                    {
+                      case ForEach::ANY:
+                      case ForEach::INCOMPLETE_PATHS:
+                      case ForEach::UNCONNECTED_SOURCES:
+                        temp.first = &s;
+                        temp.second = nullptr;
+                        apply(temp);
+                        break;
 
-                  case ForEach::COMPLETE_PATHS:
-                  case ForEach::UNCONNECTED_PLAYERS:
-                    break;
+                      case ForEach::COMPLETE_PATHS:
+                      case ForEach::UNCONNECTED_PLAYERS:
+                        break;
+                    }
                 }
-            }
-        }
+            });
     }
 
     switch(mode)
@@ -184,19 +278,16 @@ void AudioPath::Paths::for_each(const std::function<void(const AudioPath::Paths:
       case ForEach::ANY:
       case ForEach::INCOMPLETE_PATHS:
       case ForEach::UNCONNECTED_PLAYERS:
-        for(const auto &p : players_)
-        {
-            if(std::find_if(sources_.begin(), sources_.end(),
-                            [&p] (const decltype(Paths::sources_)::value_type &src)
-                            {
-                                return src.second.player_id_ == p.second.id_;
-                            }) == sources_.end())
+        players_.for_each(
+            [this, &apply, &temp] (const Player &p)
             {
-                temp.first = nullptr;
-                temp.second = &p.second;
-                apply(temp);
-            }
-        }
+                if(sources_by_player_.find(p.id_) == sources_by_player_.end())
+                {
+                    temp.first = nullptr;
+                    temp.second = &p;
+                    apply(temp);
+                }
+            });
 
         break;
 
@@ -205,3 +296,63 @@ void AudioPath::Paths::for_each(const std::function<void(const AudioPath::Paths:
         break;
     }
 }
+
+void AudioPath::Paths::for_each_source_of_player(const AudioPath::ID &player_id,
+                                                 const std::function<void(const AudioPath::Paths::Path &)> &apply) const
+{
+    const auto range(sources_by_player_.equal_range(player_id));
+
+    if(range.first == range.second)
+        return;
+
+    AudioPath::Paths::Path temp(nullptr, lookup_player(player_id));
+
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        temp.first = sources_.find(it->second);
+        apply(temp);
+    }
+}
+
+void AudioPath::Paths::log_change(const AudioPath::ID &source_id,
+                                  const AudioPath::ID &player_id, bool removed)
+{
+    if(change_log_capacity_ == 0)
+    {
+        change_log_horizon_ = generation_;
+        return;
+    }
+
+    if(change_log_.size() >= change_log_capacity_)
+    {
+        change_log_horizon_ = change_log_.front().generation_;
+        change_log_.pop_front();
+    }
+
+    change_log_.emplace_back(generation_, source_id, player_id, removed);
+}
+
+void AudioPath::Paths::for_each_change_since(uint64_t generation,
+                                             const std::function<void(const AudioPath::ID &source_id,
+                                                                      const AudioPath::ID &player_id,
+                                                                      bool removed)> &apply) const
+{
+    if(!can_report_changes_since(generation))
+        return;
+
+    const auto first(std::upper_bound(change_log_.begin(), change_log_.end(),
+                                      generation,
+                                      [] (uint64_t g, const Change &c)
+                                      {
+                                          return g < c.generation_;
+                                      }));
+
+    /* last state of each path wins */
+    std::map<std::pair<ID, ID>, bool> folded;
+
+    for(auto it = first; it != change_log_.end(); ++it)
+        folded[std::make_pair(it->source_id_, it->player_id_)] = it->removed_;
+
+    for(const auto &it : folded)
+        apply(it.first.first, it.first.second, it.second);
+}
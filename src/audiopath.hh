@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -24,9 +24,12 @@
 
 #include <string>
 #include <map>
+#include <deque>
 #include <memory>
 #include <functional>
 
+#include "audiopathid.hh"
+#include "audiopathstorage.hh"
 #include "dbus_proxy_wrapper.hh"
 
 struct _tdbusaupathPlayer;
@@ -45,26 +48,49 @@ class Player
   public:
     using PType = DBus::Proxy<struct _tdbusaupathPlayer>;
 
-    const std::string id_;
+    const ID id_;
     const std::string name_;
 
   private:
     std::unique_ptr<PType> dbus_proxy_;
 
+    /*!
+     * Unique bus name of the process owning the player.
+     */
+    std::string bus_name_;
+
+    /*!
+     * False if the process owning the player has vanished from the bus.
+     */
+    bool is_alive_;
+
   public:
     Player(const Player &) = delete;
     Player(Player &&) = default;
     Player &operator=(const Player &) = delete;
 
     explicit Player(const char *id, const char *name,
-                    std::unique_ptr<PType> dbus_proxy):
-        id_(id),
+                    std::unique_ptr<PType> dbus_proxy,
+                    const char *bus_name = ""):
+        id_(IDTable::get_singleton().intern(id)),
         name_(name),
-        dbus_proxy_(std::move(dbus_proxy))
+        dbus_proxy_(std::move(dbus_proxy)),
+        bus_name_(bus_name),
+        is_alive_(true)
     {}
 
     const PType &get_dbus_proxy() const { return *(dbus_proxy_.get()); }
-    void take_proxy_from(Player &p) { dbus_proxy_ = std::move(p.dbus_proxy_); }
+    const std::string &get_bus_name() const { return bus_name_; }
+
+    void take_proxy_from(Player &p)
+    {
+        dbus_proxy_ = std::move(p.dbus_proxy_);
+        bus_name_ = std::move(p.bus_name_);
+        is_alive_ = true;
+    }
+
+    bool is_alive() const { return is_alive_; }
+    void mark_dead() { is_alive_ = false; }
 };
 
 class Source
@@ -72,33 +98,64 @@ class Source
   public:
     using PType = DBus::Proxy<struct _tdbusaupathSource>;
 
-    const std::string id_;
+    const ID id_;
     const std::string name_;
-    const std::string player_id_;
+    const ID player_id_;
 
   private:
     std::unique_ptr<PType> dbus_proxy_;
 
+    /*!
+     * Unique bus name of the process owning the audio source.
+     */
+    std::string bus_name_;
+
+    /*!
+     * False if the process owning the audio source has vanished from the bus.
+     */
+    bool is_alive_;
+
   public:
     Source(const Source &) = delete;
     Source(Source &&) = default;
     Source &operator=(const Source &) = delete;
 
     explicit Source(const char *id, const char *name, const char *player_id,
-                    std::unique_ptr<PType> dbus_proxy):
-        id_(id),
+                    std::unique_ptr<PType> dbus_proxy,
+                    const char *bus_name = ""):
+        id_(IDTable::get_singleton().intern(id)),
         name_(name),
-        player_id_(player_id),
-        dbus_proxy_(std::move(dbus_proxy))
+        player_id_(IDTable::get_singleton().intern(player_id)),
+        dbus_proxy_(std::move(dbus_proxy)),
+        bus_name_(bus_name),
+        is_alive_(true)
     {}
 
     const PType &get_dbus_proxy() const { return *(dbus_proxy_.get()); }
-    void take_proxy_from(Source &s) { dbus_proxy_ = std::move(s.dbus_proxy_); }
+    const std::string &get_bus_name() const { return bus_name_; }
+
+    void take_proxy_from(Source &s)
+    {
+        dbus_proxy_ = std::move(s.dbus_proxy_);
+        bus_name_ = std::move(s.bus_name_);
+        is_alive_ = true;
+    }
+
+    bool is_alive() const { return is_alive_; }
+    void mark_dead() { is_alive_ = false; }
 };
 
 template <typename T>
 struct AddItemTraits;
 
+/*!
+ * Storage policy for registered players and audio sources.
+ *
+ * Any container from #AudioPath::Storage may be used here.
+ */
+template <typename T>
+using RegistryStorage = Storage::OpenHash<T>;
+
 class Paths
 {
   public:
@@ -112,9 +169,62 @@ class Paths
         UPDATED_PATH,
     };
 
+    /*!
+     * Entry in the change log of the registry.
+     *
+     * A path is identified by its source and player IDs. Either ID may be
+     * empty, meaning that the path is incomplete.
+     */
+    struct Change
+    {
+        uint64_t generation_;
+        ID source_id_;
+        ID player_id_;
+        bool removed_;
+
+        explicit Change(uint64_t generation, const ID &source_id,
+                        const ID &player_id, bool removed):
+            generation_(generation),
+            source_id_(source_id),
+            player_id_(player_id),
+            removed_(removed)
+        {}
+    };
+
+    static constexpr size_t DEFAULT_CHANGE_LOG_CAPACITY = 1024;
+
   private:
-    std::map<const std::string, Player> players_;
-    std::map<const std::string, Source> sources_;
+    RegistryStorage<Player> players_;
+    RegistryStorage<Source> sources_;
+
+    /*!
+     * Reverse index from player ID to the IDs of audio sources played by it.
+     *
+     * Player IDs need not refer to registered players.
+     */
+    std::multimap<ID, ID> sources_by_player_;
+
+    /*!
+     * Counter incremented on each modification of the registry.
+     *
+     * Clients may use this value to find out whether or not any data derived
+     * from the registry is still up-to-date.
+     */
+    uint64_t generation_;
+
+    /*!
+     * Most recent changes of paths, oldest first.
+     *
+     * The log holds at most #AudioPath::Paths::change_log_capacity_ entries.
+     * Oldest entries are dropped to make room for new ones.
+     */
+    std::deque<Change> change_log_;
+    const size_t change_log_capacity_;
+
+    /*!
+     * All changes made after this generation are in the change log.
+     */
+    uint64_t change_log_horizon_;
 
     friend struct AddItemTraits<Player>;
     friend struct AddItemTraits<Source>;
@@ -123,28 +233,93 @@ class Paths
     Paths(const Paths &) = delete;
     Paths &operator=(const Paths &) = delete;
 
-    explicit Paths() {}
+    explicit Paths(size_t change_log_capacity = DEFAULT_CHANGE_LOG_CAPACITY):
+        generation_(1),
+        change_log_capacity_(change_log_capacity),
+        change_log_horizon_(generation_)
+    {}
 
     AddResult add_player(Player &&player);
     AddResult add_source(Source &&source);
 
-    const Player *lookup_player(const std::string &player_id) const;
-    const Source *lookup_source(const std::string &source_id) const;
-    std::pair<const Source *, const Player *> lookup_path(const std::string &source_id) const;
+    uint64_t get_generation() const { return generation_; }
+
+    /*!
+     * Number of registered players and audio sources, including dead ones.
+     */
+    size_t get_number_of_players() const { return players_.size(); }
+    size_t get_number_of_sources() const { return sources_.size(); }
+
+    /*!
+     * Mark player as gone because its owner has vanished from the bus.
+     *
+     * The player remains registered. It is revived when it registers again.
+     * Until then, its paths are reported as removed from the registry, and
+     * audio sources associated with it are reported as incomplete paths.
+     *
+     * \returns
+     *     True if the player has been marked dead, false if it is unknown or
+     *     has been marked dead before.
+     */
+    bool mark_player_dead(const ID &player_id);
+
+    /*!
+     * Mark audio source as gone because its owner has vanished from the bus.
+     *
+     * The path of a dead audio source is reported as removed.
+     *
+     * \see #AudioPath::Paths::mark_player_dead()
+     */
+    bool mark_source_dead(const ID &source_id);
+
+    /*!
+     * Whether or not all changes made after given generation are known.
+     *
+     * If this function returns \c false, then
+     * #AudioPath::Paths::for_each_change_since() cannot be used to
+     * synchronize with the registry, and a full snapshot is required.
+     */
+    bool can_report_changes_since(uint64_t generation) const
+    {
+        return generation >= change_log_horizon_ && generation <= generation_;
+    }
 
-    const Player *lookup_player(const char *player_id) const
+    /*!
+     * Report paths added, updated, or removed after given generation.
+     *
+     * Multiple changes of the same path are folded into a single call of
+     * \p apply, reflecting the current state of that path. Paths which have
+     * been added and removed again are reported as removed.
+     *
+     * The caller must check #AudioPath::Paths::can_report_changes_since()
+     * before calling this function.
+     */
+    void for_each_change_since(uint64_t generation,
+                               const std::function<void(const ID &source_id,
+                                                        const ID &player_id,
+                                                        bool removed)> &apply) const;
+
+    const Player *lookup_player(const ID &player_id) const;
+    const Source *lookup_source(const ID &source_id) const;
+    Path lookup_path(const ID &source_id) const;
+
+    /*
+     * Lookups by string, guaranteed not to allocate any memory.
+     */
+
+    const Player *lookup_player(const StringRef &player_id) const
     {
-        return lookup_player(std::string(player_id));
+        return lookup_player(IDTable::get_singleton().find(player_id));
     }
 
-    const Source *lookup_source(const char *source_id) const
+    const Source *lookup_source(const StringRef &source_id) const
     {
-        return lookup_source(std::string(source_id));
+        return lookup_source(IDTable::get_singleton().find(source_id));
     }
 
-    Path lookup_path(const char *source_id) const
+    Path lookup_path(const StringRef &source_id) const
     {
-        return lookup_path(std::string(source_id));
+        return lookup_path(IDTable::get_singleton().find(source_id));
     }
 
     enum class ForEach
@@ -159,9 +334,20 @@ class Paths
     void for_each(const std::function<void(const AudioPath::Paths::Path &)> &apply,
                   ForEach mode = ForEach::COMPLETE_PATHS) const;
 
+    /*!
+     * Iterate over all audio sources associated with given player.
+     *
+     * The player part of the path passed to \p apply is \c nullptr in case
+     * the player is not registered.
+     */
+    void for_each_source_of_player(const ID &player_id,
+                                   const std::function<void(const AudioPath::Paths::Path &)> &apply) const;
+
   private:
     template <typename T>
     const T &add_item(T &&item, bool &inserted);
+
+    void log_change(const ID &source_id, const ID &player_id, bool removed);
 };
 
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "audiopathid.hh"
+
+AudioPath::IDTable::IDTable()
+{
+    /* handle 0 is the empty ID; the table owns its string so that it is
+     * constructed before the table can be used */
+    storage_.emplace_back();
+    strings_.push_back(&storage_.back());
+}
+
+AudioPath::IDTable &AudioPath::IDTable::get_singleton()
+{
+    static IDTable table;
+    return table;
+}
+
+AudioPath::ID AudioPath::IDTable::intern(const AudioPath::StringRef &id)
+{
+    if(id.empty())
+        return ID();
+
+    const auto it(handles_.find(id));
+
+    if(it != handles_.end())
+        return ID(it->second);
+
+    const uint32_t handle = strings_.size();
+    storage_.emplace_back(id.data(), id.length());
+    handles_.emplace(StringRef(storage_.back()), handle);
+    strings_.push_back(&storage_.back());
+
+    return ID(handle);
+}
+
+AudioPath::ID AudioPath::IDTable::find(const AudioPath::StringRef &id) const
+{
+    const auto it(handles_.find(id));
+    return it != handles_.end() ? ID(it->second) : ID();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef AUDIOPATHID_HH
+#define AUDIOPATHID_HH
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Non-owning reference to a string, used for lookups.
+ *
+ * Objects of this type can be constructed from C strings and from
+ * \c std::string without copying the string data, so that looking up an ID
+ * never requires allocating a temporary \c std::string. The referenced
+ * string must outlive the #AudioPath::StringRef object.
+ */
+class StringRef
+{
+  private:
+    const char *data_;
+    size_t length_;
+
+  public:
+    StringRef(const char *str): data_(str), length_(strlen(str)) {}
+    StringRef(const std::string &str): data_(str.c_str()), length_(str.length()) {}
+    explicit StringRef(const char *str, size_t length): data_(str), length_(length) {}
+
+    const char *data() const { return data_; }
+    size_t length() const { return length_; }
+    bool empty() const { return length_ == 0; }
+
+    bool operator==(const StringRef &other) const
+    {
+        return length_ == other.length_ &&
+               (length_ == 0 || memcmp(data_, other.data_, length_) == 0);
+    }
+
+    /*!
+     * FNV-1a hash of the referenced characters.
+     */
+    struct Hash
+    {
+        size_t operator()(const StringRef &s) const
+        {
+            uint32_t h = 2166136261U;
+
+            for(size_t i = 0; i < s.length_; ++i)
+            {
+                h ^= static_cast<unsigned char>(s.data_[i]);
+                h *= 16777619U;
+            }
+
+            return h;
+        }
+    };
+};
+
+/*!
+ * Compact handle for an interned player or audio source ID.
+ *
+ * Equal ID strings are mapped to equal handles, so comparing two IDs is an
+ * integer comparison. The string is only needed when talking to the outside
+ * world, and it can be retrieved from the handle without copying.
+ *
+ * The default-constructed handle represents the empty ID.
+ */
+class ID
+{
+  private:
+    uint32_t handle_;
+
+  public:
+    constexpr explicit ID(): handle_(0) {}
+    constexpr explicit ID(uint32_t handle): handle_(handle) {}
+
+    bool empty() const { return handle_ == 0; }
+    void clear() { handle_ = 0; }
+    uint32_t get_handle() const { return handle_; }
+
+    const std::string &str() const;
+    const char *c_str() const { return str().c_str(); }
+
+    bool operator==(const ID &other) const { return handle_ == other.handle_; }
+    bool operator!=(const ID &other) const { return handle_ != other.handle_; }
+    bool operator<(const ID &other) const { return handle_ < other.handle_; }
+};
+
+/*!
+ * Table of interned ID strings.
+ *
+ * There is a single, process-wide table. Strings are never removed from the
+ * table because registered players and audio sources are never removed
+ * either.
+ */
+class IDTable
+{
+  private:
+    /*!
+     * The interned strings.
+     *
+     * A \c std::deque does not move its elements on insertion at the end, so
+     * the keys in #AudioPath::IDTable::handles_ remain valid.
+     */
+    std::deque<std::string> storage_;
+
+    std::unordered_map<StringRef, uint32_t, StringRef::Hash> handles_;
+    std::vector<const std::string *> strings_;
+
+  public:
+    IDTable(const IDTable &) = delete;
+    IDTable &operator=(const IDTable &) = delete;
+
+    explicit IDTable();
+
+    static IDTable &get_singleton();
+
+    /*!
+     * Return handle for given string, add string to table if necessary.
+     */
+    ID intern(const StringRef &id);
+
+    /*!
+     * Return handle for given string if it is in the table.
+     *
+     * The table is not modified, so that IDs received from clients cannot
+     * cause the table to grow. This function never allocates memory.
+     *
+     * \returns
+     *     The handle for the string, or an empty handle in case the string
+     *     is unknown.
+     */
+    ID find(const StringRef &id) const;
+
+    const std::string &get_string(ID id) const { return *strings_[id.get_handle()]; }
+
+    size_t size() const { return strings_.size() - 1; }
+};
+
+inline const std::string &ID::str() const
+{
+    return IDTable::get_singleton().get_string(*this);
+}
+
+}
+
+/*!@}*/
+
+#endif /* !AUDIOPATHID_HH */
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef AUDIOPATHSTORAGE_HH
+#define AUDIOPATHSTORAGE_HH
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "audiopathid.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Storage backends for the audio path registry.
+ *
+ * All containers in this namespace store objects of type \c T which have a
+ * public member \c id_ of type #AudioPath::ID, and they all provide the same
+ * interface:
+ *
+ * - \c find(id) returns a pointer to the object with given ID, or
+ *   \c nullptr if there is no such object.
+ * - \c insert(item) stores a new object whose ID is not in the container yet
+ *   and returns a reference to the stored object.
+ * - \c for_each(fn) calls \c fn for each stored object.
+ * - \c size() returns the number of stored objects.
+ *
+ * Objects are never removed. Pointers and references to stored objects are
+ * invalidated by \c insert(), except for #AudioPath::Storage::Map.
+ */
+namespace Storage
+{
+
+/*!
+ * Node-based storage, one heap allocation per object.
+ */
+template <typename T>
+class Map
+{
+  private:
+    std::map<const ID, T> items_;
+
+  public:
+    Map(const Map &) = delete;
+    Map &operator=(const Map &) = delete;
+
+    explicit Map() {}
+
+    T *find(const ID &id)
+    {
+        auto it(items_.find(id));
+        return it != items_.end() ? &it->second : nullptr;
+    }
+
+    const T *find(const ID &id) const
+    {
+        auto it(items_.find(id));
+        return it != items_.end() ? &it->second : nullptr;
+    }
+
+    T &insert(T &&item)
+    {
+        const ID key(item.id_);
+        return items_.emplace(key, std::move(item)).first->second;
+    }
+
+    template <typename F>
+    void for_each(const F &apply) const
+    {
+        for(const auto &it : items_)
+            apply(it.second);
+    }
+
+    size_t size() const { return items_.size(); }
+};
+
+/*!
+ * Contiguous objects with a sorted index for binary search.
+ *
+ * Objects are stored in order of insertion. The index is a sorted array of
+ * small ID/position pairs, so that insertion does not move any objects
+ * (except when the object array grows).
+ */
+template <typename T>
+class FlatVector
+{
+  private:
+    using IndexEntry = std::pair<ID, uint32_t>;
+
+    std::vector<T> items_;
+    std::vector<IndexEntry> index_;
+
+  public:
+    FlatVector(const FlatVector &) = delete;
+    FlatVector &operator=(const FlatVector &) = delete;
+
+    explicit FlatVector() {}
+
+    T *find(const ID &id)
+    {
+        const auto it(lower_bound(id));
+        return (it != index_.end() && it->first == id) ? &items_[it->second] : nullptr;
+    }
+
+    const T *find(const ID &id) const
+    {
+        return const_cast<FlatVector *>(this)->find(id);
+    }
+
+    T &insert(T &&item)
+    {
+        const ID key(item.id_);
+        const uint32_t pos = items_.size();
+
+        items_.emplace_back(std::move(item));
+        index_.emplace(lower_bound(key), key, pos);
+
+        return items_.back();
+    }
+
+    template <typename F>
+    void for_each(const F &apply) const
+    {
+        for(const auto &it : items_)
+            apply(it);
+    }
+
+    size_t size() const { return items_.size(); }
+
+  private:
+    typename std::vector<IndexEntry>::iterator lower_bound(const ID &id)
+    {
+        return std::lower_bound(index_.begin(), index_.end(), id,
+                                [] (const IndexEntry &e, const ID &key)
+                                {
+                                    return e.first < key;
+                                });
+    }
+};
+
+/*!
+ * Contiguous objects with an open-addressing hash table for lookup.
+ *
+ * The hash table uses linear probing and stores positions into the object
+ * array, so that growing the table does not move any objects. Since objects
+ * are never removed, there is no need for tombstones.
+ */
+template <typename T>
+class OpenHash
+{
+  private:
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    std::vector<T> items_;
+    std::vector<uint32_t> slots_;
+
+  public:
+    OpenHash(const OpenHash &) = delete;
+    OpenHash &operator=(const OpenHash &) = delete;
+
+    explicit OpenHash() {}
+
+    T *find(const ID &id)
+    {
+        if(slots_.empty())
+            return nullptr;
+
+        const size_t mask = slots_.size() - 1;
+
+        for(size_t i = hash(id) & mask; slots_[i] != EMPTY_SLOT; i = (i + 1) & mask)
+        {
+            if(items_[slots_[i]].id_ == id)
+                return &items_[slots_[i]];
+        }
+
+        return nullptr;
+    }
+
+    const T *find(const ID &id) const
+    {
+        return const_cast<OpenHash *>(this)->find(id);
+    }
+
+    T &insert(T &&item)
+    {
+        /* keep load factor below 3/4 */
+        if((items_.size() + 1) * 4 > slots_.size() * 3)
+            grow();
+
+        const uint32_t pos = items_.size();
+        items_.emplace_back(std::move(item));
+        place(items_.back().id_, pos);
+
+        return items_.back();
+    }
+
+    template <typename F>
+    void for_each(const F &apply) const
+    {
+        for(const auto &it : items_)
+            apply(it);
+    }
+
+    size_t size() const { return items_.size(); }
+
+  private:
+    static size_t hash(const ID &id)
+    {
+        /* Fibonacci hashing spreads sequentially assigned handles */
+        return (static_cast<uint64_t>(id.get_handle()) * 11400714819323198485ULL) >> 32;
+    }
+
+    void place(const ID &id, uint32_t pos)
+    {
+        const size_t mask = slots_.size() - 1;
+        size_t i = hash(id) & mask;
+
+        while(slots_[i] != EMPTY_SLOT)
+            i = (i + 1) & mask;
+
+        slots_[i] = pos;
+    }
+
+    void grow()
+    {
+        slots_.assign(slots_.empty() ? 16 : slots_.size() * 2, EMPTY_SLOT);
+        items_.reserve(slots_.size() * 3 / 4);
+
+        for(uint32_t pos = 0; pos < items_.size(); ++pos)
+            place(items_[pos].id_, pos);
+    }
+};
+
+template <typename T>
+constexpr uint32_t OpenHash<T>::EMPTY_SLOT;
+
+}
+
+}
+
+/*!@}*/
+
+#endif /* !AUDIOPATHSTORAGE_HH */
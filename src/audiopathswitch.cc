@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -23,122 +23,579 @@
 #include <config.h>
 #endif /* HAVE_CONFIG_H */
 
+#include <algorithm>
+
 #include <glib.h>
 
 #include "audiopathswitch.hh"
 #include "audiopath.hh"
+#include "flightrecorder.hh"
+#include "trafficrecorder.hh"
+#include "faultinjector.hh"
+#include "loopmonitor.hh"
+#include "peerstatistics.hh"
 #include "gerrorwrapper.hh"
+#include "probes.hh"
 #include "de_tahifi_audiopath.h"
 #include "messages.h"
 
 static const char debug_prefix[] = "AUDIO SOURCE SWITCH: ";
 
-static void deactivate_player(const AudioPath::Paths &paths,
-                              const GVariantWrapper &request_data,
-                              std::string &player_id)
+class AudioPath::Switch::Operation:
+    public std::enable_shared_from_this<AudioPath::Switch::Operation>
 {
-    if(player_id.empty())
-        return;
+  public:
+    enum class Step
+    {
+        NOT_STARTED,
+        DESELECT_SOURCE,
+        DEACTIVATE_PLAYER,
+        ACTIVATE_PLAYER,
+        SELECT_SOURCE,
+        DONE,
+    };
+
+    struct PeerCall;
+
+  private:
+    /*!
+     * The switch this operation is working on.
+     *
+     * This pointer is set to \c nullptr if the switch is destroyed while the
+     * operation is still in progress. Any answers from peers received after
+     * that point are ignored.
+     */
+    Switch *switch_;
 
-    const AudioPath::Player *old_player = paths.lookup_player(player_id);
+    /*!
+     * Clock and timers of the switch, also used after detaching from it.
+     */
+    Scheduler &scheduler_;
 
-    msg_vinfo(MESSAGE_LEVEL_DEBUG,
-              "%sDeactivate player %s (%s)", debug_prefix,
-              old_player->id_.c_str(), old_player->name_.c_str());
+    /*!
+     * Time budget for the whole operation in milliseconds, 0 for none.
+     *
+     * The budget starts when the operation is submitted.
+     */
+    const unsigned int deadline_ms_;
 
-    GErrorWrapper error;
-    tdbus_aupath_player_call_deactivate_sync(old_player->get_dbus_proxy().get_as_nonconst(),
-                                             GVariantWrapper::get(request_data),
-                                             nullptr, error.await());
+    /*!
+     * Timer which fires when the deadline has passed.
+     */
+    unsigned int deadline_timer_;
 
-    if(error.log_failure("Deactivate player"))
-        msg_error(0, LOG_ERR, "%sDeactivating player %s failed",
-                  debug_prefix,  old_player->id_.c_str());
+    /*!
+     * Passed to all D-Bus calls, canceled when the deadline has passed.
+     */
+    GCancellable *cancellable_;
 
-    player_id.clear();
+    /*!
+     * Number of D-Bus calls whose answers have not been received yet.
+     *
+     * Independent notifications are sent concurrently, and the operation
+     * only proceeds to the next step after all of them have been answered.
+     */
+    unsigned int calls_in_flight_;
+
+  protected:
+    const Paths &paths_;
+    GVariantWrapper request_data_;
+    Step step_;
+    bool deadline_exceeded_;
+
+    /*!
+     * Monotonic time at which the operation has been started.
+     */
+    gint64 started_us_;
+
+    /*!
+     * ID of the audio source being deselected in step
+     * #AudioPath::Switch::Operation::Step::DESELECT_SOURCE.
+     */
+    ID deselected_source_id_;
+
+    explicit Operation(Switch &sw, const Paths &paths,
+                       GVariantWrapper &&request_data,
+                       unsigned int deadline_ms = 0):
+        switch_(&sw),
+        scheduler_(sw.scheduler_),
+        deadline_ms_(deadline_ms),
+        deadline_timer_(0),
+        cancellable_(nullptr),
+        calls_in_flight_(0),
+        paths_(paths),
+        request_data_(std::move(request_data)),
+        step_(Step::NOT_STARTED),
+        deadline_exceeded_(false),
+        started_us_(0)
+    {}
+
+  public:
+    Operation(const Operation &) = delete;
+    Operation &operator=(const Operation &) = delete;
+
+    virtual ~Operation()
+    {
+        if(cancellable_ != nullptr)
+            g_object_unref(cancellable_);
+    }
+
+    void detach()
+    {
+        switch_ = nullptr;
+        disarm_deadline();
+    }
+
+    /*!
+     * Whether or not this operation may be superseded by a newer one.
+     */
+    virtual bool is_activation() const { return false; }
+
+    /*!
+     * Drop operation before it has been started.
+     *
+     * This is only called for audio source activations waiting in the queue
+     * if a newer activation has been requested.
+     */
+    virtual void supersede() {}
+
+    /*!
+     * Drop operation whose deadline has passed before it has been started.
+     *
+     * This is only called for audio source activations waiting in the
+     * queue. Other operations are started anyway, but their D-Bus calls
+     * fail right away because they are canceled already.
+     */
+    virtual void expire() {}
+
+    /*!
+     * Start the time budget of the operation.
+     *
+     * Called when the operation is submitted, so that time spent waiting for
+     * other operations counts against the budget.
+     */
+    void submitted()
+    {
+        if(deadline_ms_ > 0)
+            arm_deadline();
+    }
+
+    void start()
+    {
+        if(switch_ == nullptr)
+            return;
+
+        started_us_ = scheduler_.now_us();
+        do_start();
+    }
+
+    /*!
+     * Called when a peer has answered a D-Bus method call.
+     *
+     * Answers which arrive after the operation has been finished are
+     * ignored. This happens if the deadline has passed while several calls
+     * were in flight: the first canceled call aborts the operation, the
+     * others are of no interest anymore.
+     */
+    void peer_call_finished(Step step, gint64 call_started_us,
+                            GErrorWrapper &error)
+    {
+        msg_log_assert(calls_in_flight_ > 0);
+        --calls_in_flight_;
+
+        if(switch_ == nullptr)
+            return;
+
+        record_peer_latency(step, scheduler_.now_us() - call_started_us,
+                            error.failed());
+
+        if(step_ != Step::DONE)
+            do_continue(step, error);
+    }
+
+    Scheduler &get_scheduler() const { return scheduler_; }
+
+  protected:
+    virtual void do_start() = 0;
+    virtual void do_continue(Step step, GErrorWrapper &error) = 0;
+
+    Switch &get_switch() { return *switch_; }
+    unsigned int get_deadline_ms() const { return deadline_ms_; }
+    GCancellable *get_cancellable() const { return cancellable_; }
+    bool have_calls_in_flight() const { return calls_in_flight_ > 0; }
+
+    PeerCall *peer_call(Step step, const char *method, const ID &peer_id);
+
+    /*!
+     * Mark operation as done and start next queued operation, if any.
+     *
+     * The \p notify function is called after the switch has become idle and
+     * before the next operation is started.
+     */
+    template <typename F>
+    void finish(F &&notify)
+    {
+        auto keep_alive(shared_from_this());
+        Switch *sw = switch_;
+
+        step_ = Step::DONE;
+        disarm_deadline();
+        sw->current_operation_ = nullptr;
+        sw->update_deferred_statistics();
+        notify();
+        sw->run_queued_operations();
+    }
+
+    bool begin_deselect_source(DeselectedAudioSourceResult &result);
+    void end_deselect_source(GErrorWrapper &error);
+    bool begin_deactivate_player(bool players_changed);
+    void end_deactivate_player(GErrorWrapper &error);
+    void force_release();
+
+    void record_duration(SwitchStatistics::Phase phase)
+    {
+        switch_->statistics_.add(phase, scheduler_.now_us() - started_us_);
+    }
+
+  private:
+    void record_peer_latency(Step step, gint64 duration_us, bool failed);
+    void arm_deadline();
+    void disarm_deadline();
+    void deadline_expired();
+};
+
+using OperationRef = std::shared_ptr<AudioPath::Switch::Operation>;
+
+/*!
+ * User data passed along with a D-Bus method call to a peer.
+ *
+ * Keeps the operation alive until the peer has answered and remembers which
+ * step the call belongs to. Start and end of the call are recorded in the
+ * #AudioPath::FlightRecorder.
+ *
+ * The #AudioPath::FaultInjector may decide to hold back the peer's answer, in
+ * which case \c injected_delay_ms_ is non-zero.
+ *
+ * The bus name of the peer is copied when the call is made because the peer
+ * may be gone by the time its answer is processed.
+ */
+struct AudioPath::Switch::Operation::PeerCall
+{
+    OperationRef op_;
+    const Step step_;
+    const char *const method_;
+    const ID peer_id_;
+    const uint32_t sequence_number_;
+    const gint64 started_us_;
+    GCancellable *const cancellable_;
+    unsigned int injected_delay_ms_;
+    std::string bus_name_;
+
+    explicit PeerCall(OperationRef &&op, Step step, const char *method,
+                      const ID &peer_id):
+        op_(std::move(op)),
+        step_(step),
+        method_(method),
+        peer_id_(peer_id),
+        sequence_number_(FlightRecorder::get_singleton()
+                         .record_call_started(method, peer_id)),
+        started_us_(op_->get_scheduler().now_us()),
+        cancellable_(op_->cancellable_),
+        injected_delay_ms_(0)
+    {}
+};
+
+using PeerCall = AudioPath::Switch::Operation::PeerCall;
+
+AudioPath::Switch::Operation::PeerCall *
+AudioPath::Switch::Operation::peer_call(Step step, const char *method,
+                                        const ID &peer_id)
+{
+    step_ = step;
+    ++calls_in_flight_;
+
+    auto *call = new PeerCall(shared_from_this(), step, method, peer_id);
+    TAPSWITCH_PROBE(peer__call__start, method, peer_id.c_str(),
+                    call->sequence_number_, int(step));
+
+    return call;
 }
 
-static bool activate_player(const AudioPath::Player &player,
-                            const GVariantWrapper &request_data)
+static void peer_call_complete(std::unique_ptr<PeerCall> call,
+                               GErrorWrapper &error)
 {
-    msg_vinfo(MESSAGE_LEVEL_DEBUG, "%sActivate player %s (%s)",
-              debug_prefix, player.id_.c_str(), player.name_.c_str());
+    const auto scope(AudioPath::LoopMonitor::get_singleton().enter(
+                        call->method_, call->peer_id_.c_str()));
+
+    TAPSWITCH_PROBE(peer__call__done, call->method_, call->peer_id_.c_str(),
+                    call->sequence_number_, int(error.failed()));
+    AudioPath::FlightRecorder::get_singleton().record_call_finished(
+        call->method_, call->peer_id_, call->sequence_number_,
+        error.failed());
+
+    const gint64 duration_us =
+        call->op_->get_scheduler().now_us() - call->started_us_;
+
+    AudioPath::TrafficRecorder::get_singleton().record_peer_call(
+        call->method_, call->peer_id_, call->started_us_, duration_us,
+        error.failed());
+
+    /* a canceled call tells nothing about the peer */
+    if(!g_cancellable_is_cancelled(call->cancellable_))
+        AudioPath::PeerStatistics::get_singleton().add(
+            call->method_, call->peer_id_, call->bus_name_, duration_us,
+            error.failed());
+
+    call->op_->peer_call_finished(call->step_, call->started_us_, error);
+}
+
+/*!
+ * Answer of a peer made up or held back by the #AudioPath::FaultInjector.
+ *
+ * The answer is delivered when the injected delay has passed, or in the next
+ * main loop iteration after the operation has been canceled. In the latter
+ * case, the answer is replaced by a canceled error as GDBus would report it.
+ */
+class InjectedAnswer
+{
+  private:
+    std::unique_ptr<PeerCall> call_;
+    GError *error_;
+    gulong cancel_handler_;
+    unsigned int timer_;
+
+    explicit InjectedAnswer(std::unique_ptr<PeerCall> call, GError *error):
+        call_(std::move(call)),
+        error_(error),
+        cancel_handler_(0),
+        timer_(0)
+    {}
+
+  public:
+    InjectedAnswer(const InjectedAnswer &) = delete;
+    InjectedAnswer &operator=(const InjectedAnswer &) = delete;
+
+    ~InjectedAnswer()
+    {
+        if(error_ != nullptr)
+            g_error_free(error_);
+    }
+
+    static void start(std::unique_ptr<PeerCall> call, unsigned int delay_ms,
+                      GError *error)
+    {
+        auto *answer = new InjectedAnswer(std::move(call), error);
+
+        answer->schedule(delay_ms);
+
+        if(answer->call_->cancellable_ != nullptr)
+            answer->cancel_handler_ =
+                g_cancellable_connect(answer->call_->cancellable_,
+                                      G_CALLBACK(canceled), answer, nullptr);
+    }
+
+  private:
+    void schedule(unsigned int delay_ms)
+    {
+        timer_ = call_->op_->get_scheduler().add_timer(
+                    delay_ms, [this] { timer_ = 0; deliver(); });
+    }
+
+    static void canceled(GCancellable *cancellable, gpointer user_data)
+    {
+        auto *answer = static_cast<InjectedAnswer *>(user_data);
+
+        if(answer->timer_ == 0)
+            return;
+
+        answer->call_->op_->get_scheduler().remove_timer(answer->timer_);
+
+        if(answer->error_ != nullptr)
+            g_error_free(answer->error_);
+
+        answer->error_ = g_error_new(G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                     "Operation was cancelled");
+        answer->schedule(0);
+    }
+
+    void deliver()
+    {
+        std::unique_ptr<InjectedAnswer> self(this);
+
+        if(cancel_handler_ != 0)
+            g_cancellable_disconnect(call_->cancellable_, cancel_handler_);
+
+        GErrorWrapper error;
+        *error.await() = error_;
+        error_ = nullptr;
+
+        peer_call_complete(std::move(call_), error);
+    }
+};
+
+template <typename ProxyType,
+          gboolean (*FinishFn)(ProxyType *, GAsyncResult *, GError **)>
+static void peer_call_done(GObject *source_object, GAsyncResult *res,
+                           gpointer user_data)
+{
+    std::unique_ptr<PeerCall> call(static_cast<PeerCall *>(user_data));
+
+    if(call->injected_delay_ms_ > 0)
+    {
+        GError *error = nullptr;
+        FinishFn(reinterpret_cast<ProxyType *>(source_object), res, &error);
+        const unsigned int delay_ms = call->injected_delay_ms_;
+        InjectedAnswer::start(std::move(call), delay_ms, error);
+        return;
+    }
 
     GErrorWrapper error;
-    tdbus_aupath_player_call_activate_sync(player.get_dbus_proxy().get_as_nonconst(),
-                                           GVariantWrapper::get(request_data),
-                                           nullptr, error.await());
-    if(error.log_failure("Activate player"))
+
+    FinishFn(reinterpret_cast<ProxyType *>(source_object), res, error.await());
+    peer_call_complete(std::move(call), error);
+}
+
+/*!
+ * Apply fault injection rules to a peer call which is about to be made.
+ *
+ * \returns
+ *     True if the call must not be made because its failure has been
+ *     injected, false if the call should be made (possibly with its answer
+ *     delayed).
+ */
+static bool inject_fault(PeerCall *call)
+{
+    auto &injector(AudioPath::FaultInjector::get_singleton());
+
+    if(!injector.is_enabled())
+        return false;
+
+    const auto *rule = injector.match(call->method_, call->peer_id_);
+
+    if(rule == nullptr)
+        return false;
+
+    using Fault = AudioPath::FaultInjector::Fault;
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "%sInjecting %s (%u ms) into %s call to %s",
+              debug_prefix, AudioPath::FaultInjector::fault_to_string(rule->fault_),
+              rule->delay_ms_, call->method_, call->peer_id_.c_str());
+
+    GError *error = nullptr;
+
+    switch(rule->fault_)
     {
-        msg_error(0, LOG_ERR, "%sActivating player %s failed",
-                  debug_prefix, player.id_.c_str());
+      case Fault::DELAY:
+        call->injected_delay_ms_ = rule->delay_ms_;
         return false;
+
+      case Fault::ERROR:
+        error = g_error_new(G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+                            "Injected failure");
+        break;
+
+      case Fault::TIMEOUT:
+        error = g_error_new(G_DBUS_ERROR, G_DBUS_ERROR_NO_REPLY,
+                            "Injected timeout");
+        break;
+
+      case Fault::VANISH:
+        error = g_error_new(G_DBUS_ERROR, G_DBUS_ERROR_SERVICE_UNKNOWN,
+                            "Injected disappearance of %s",
+                            call->peer_id_.c_str());
+        break;
     }
 
+    InjectedAnswer::start(std::unique_ptr<PeerCall>(call), rule->delay_ms_, error);
+
     return true;
 }
 
-static AudioPath::Switch::DeselectedAudioSourceResult
-deselect_source(const AudioPath::Paths &paths,
-                const GVariantWrapper &request_data, std::string &source_id,
-                AudioPath::Switch::PendingActivation &pending)
+static void call_deactivate(const AudioPath::Player &player,
+                            const GVariantWrapper &request_data,
+                            GCancellable *cancellable, PeerCall *call)
 {
-    MSG_BUG_IF(!source_id.empty() && pending.have_pending_activation(),
-               "deselect source: have source ID and pending activation");
+    call->bus_name_ = player.get_bus_name();
 
-    if(source_id.empty() && !pending.have_pending_activation())
-        return AudioPath::Switch::DeselectedAudioSourceResult::NONE;
+    if(inject_fault(call))
+        return;
 
-    const std::string &deselected_id(!source_id.empty() ? source_id : pending.get_audio_source_id());
-    const AudioPath::Source *old_source = paths.lookup_source(deselected_id);
-    const auto result = source_id.empty()
-        ? AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_PENDING
-        : AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE;
+    tdbus_aupath_player_call_deactivate(
+        player.get_dbus_proxy().get_as_nonconst(),
+        GVariantWrapper::get(request_data), cancellable,
+        peer_call_done<tdbusaupathPlayer, tdbus_aupath_player_call_deactivate_finish>,
+        call);
+}
 
-    msg_vinfo(MESSAGE_LEVEL_DEBUG,
-              "%sDeselect %saudio source %s (%s)", debug_prefix,
-              source_id.empty() ? "pending " : "",
-              old_source->id_.c_str(), old_source->name_.c_str());
+static void call_activate(const AudioPath::Player &player,
+                          const GVariantWrapper &request_data,
+                          GCancellable *cancellable, PeerCall *call)
+{
+    call->bus_name_ = player.get_bus_name();
 
-    GErrorWrapper error;
-    tdbus_aupath_source_call_deselected_sync(
-        old_source->get_dbus_proxy().get_as_nonconst(), deselected_id.c_str(),
-        GVariantWrapper::get(request_data), nullptr, error.await());
+    if(inject_fault(call))
+        return;
 
-    if(error.log_failure("Deselect source"))
-        msg_error(0, LOG_ERR, "%sDeselecting audio source %s failed",
-                  debug_prefix, old_source->id_.c_str());
+    tdbus_aupath_player_call_activate(
+        player.get_dbus_proxy().get_as_nonconst(),
+        GVariantWrapper::get(request_data), cancellable,
+        peer_call_done<tdbusaupathPlayer, tdbus_aupath_player_call_activate_finish>,
+        call);
+}
 
-    source_id.clear();
-    pending.clear();
+static void call_deselected(const AudioPath::Source &source,
+                            const AudioPath::ID &source_id,
+                            const GVariantWrapper &request_data,
+                            GCancellable *cancellable, PeerCall *call)
+{
+    call->bus_name_ = source.get_bus_name();
 
-    return result;
+    if(inject_fault(call))
+        return;
+
+    tdbus_aupath_source_call_deselected(
+        source.get_dbus_proxy().get_as_nonconst(), source_id.c_str(),
+        GVariantWrapper::get(request_data), cancellable,
+        peer_call_done<tdbusaupathSource, tdbus_aupath_source_call_deselected_finish>,
+        call);
 }
 
-static bool select_source(const AudioPath::Source &source, bool is_final_select,
-                          GVariantWrapper &&request_data)
+static void call_selected(const AudioPath::Source &source,
+                          bool is_final_select,
+                          const GVariantWrapper &request_data,
+                          GCancellable *cancellable, PeerCall *call)
 {
     msg_vinfo(MESSAGE_LEVEL_DEBUG, "%sSelect audio source %s (%s)%s",
               debug_prefix, source.id_.c_str(), source.name_.c_str(),
               is_final_select ? "" : " (deferred)");
 
-    GErrorWrapper error;
+    call->bus_name_ = source.get_bus_name();
+
+    if(inject_fault(call))
+        return;
 
     if(is_final_select)
-        tdbus_aupath_source_call_selected_sync(source.get_dbus_proxy().get_as_nonconst(),
-                                               source.id_.c_str(),
-                                               GVariantWrapper::get(request_data),
-                                               nullptr, error.await());
+        tdbus_aupath_source_call_selected(
+            source.get_dbus_proxy().get_as_nonconst(), source.id_.c_str(),
+            GVariantWrapper::get(request_data), cancellable,
+            peer_call_done<tdbusaupathSource, tdbus_aupath_source_call_selected_finish>,
+            call);
     else
-        tdbus_aupath_source_call_selected_on_hold_sync(source.get_dbus_proxy().get_as_nonconst(),
-                                                       source.id_.c_str(),
-                                                       GVariantWrapper::get(request_data),
-                                                       nullptr, error.await());
+        tdbus_aupath_source_call_selected_on_hold(
+            source.get_dbus_proxy().get_as_nonconst(), source.id_.c_str(),
+            GVariantWrapper::get(request_data), cancellable,
+            peer_call_done<tdbusaupathSource, tdbus_aupath_source_call_selected_on_hold_finish>,
+            call);
+}
 
+static bool check_select_source_result(GErrorWrapper &error,
+                                       const AudioPath::ID &source_id,
+                                       bool is_final_select)
+{
     if(error.log_failure("Select source"))
     {
         msg_error(0, LOG_ERR, "%sSelecting audio source %s%s failed",
-                  debug_prefix, source.id_.c_str(),
+                  debug_prefix, source_id.c_str(),
                   is_final_select ? "" : " (deferred)");
         return false;
     }
@@ -146,63 +603,362 @@ static bool select_source(const AudioPath::Source &source, bool is_final_select,
     return true;
 }
 
-AudioPath::Switch::ActivateResult
-AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
-                                   const char *source_id,
-                                   const std::string *&player_id,
-                                   DeselectedAudioSourceResult &deselected_result,
-                                   bool select_source_now)
+/*!
+ * Tell the currently selected or pending audio source that it is deselected.
+ *
+ * \returns
+ *     True if the audio source is being notified, false if there was nothing
+ *     to do. In the former case, the operation continues when the audio
+ *     source has answered. An audio source whose process has vanished from
+ *     the bus is not notified, it is deselected right away.
+ */
+bool AudioPath::Switch::Operation::begin_deselect_source(
+        DeselectedAudioSourceResult &result)
 {
-    GVariantDict dict;
-    g_variant_dict_init(&dict, nullptr);
-    auto request_data(GVariantWrapper(g_variant_dict_end(&dict)));
+    auto &sw(get_switch());
+    ID &source_id(sw.current_source_id_);
+    auto &pending(sw.pending_);
+
+    MSG_BUG_IF(!source_id.empty() && pending.have_pending_activation(),
+               "deselect source: have source ID and pending activation");
+
+    if(source_id.empty() && !pending.have_pending_activation())
+    {
+        result = DeselectedAudioSourceResult::NONE;
+        return false;
+    }
+
+    deselected_source_id_ =
+        !source_id.empty() ? source_id : pending.get_audio_source_id();
+    const AudioPath::Source *old_source = paths_.lookup_source(deselected_source_id_);
+    result = source_id.empty()
+        ? DeselectedAudioSourceResult::DESELECTED_PENDING
+        : DeselectedAudioSourceResult::DESELECTED_ACTIVE;
+
+    if(!old_source->is_alive())
+    {
+        msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                  "%sNot deselecting %saudio source %s (%s), peer is gone",
+                  debug_prefix, source_id.empty() ? "pending " : "",
+                  old_source->id_.c_str(), old_source->name_.c_str());
+        source_id.clear();
+        pending.clear();
+        return false;
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_DEBUG,
+              "%sDeselect %saudio source %s (%s)", debug_prefix,
+              source_id.empty() ? "pending " : "",
+              old_source->id_.c_str(), old_source->name_.c_str());
+
+    call_deselected(*old_source, deselected_source_id_, request_data_,
+                    get_cancellable(),
+                    peer_call(Step::DESELECT_SOURCE, "Deselected",
+                              deselected_source_id_));
+
+    return true;
+}
+
+void AudioPath::Switch::Operation::end_deselect_source(GErrorWrapper &error)
+{
+    if(error.log_failure("Deselect source"))
+        msg_error(0, LOG_ERR, "%sDeselecting audio source %s failed",
+                  debug_prefix, deselected_source_id_.c_str());
+
+    auto &sw(get_switch());
+    sw.current_source_id_.clear();
+    sw.pending_.clear();
+}
+
+/*!
+ * Tell the currently active player that it must release the audio device.
+ *
+ * \returns
+ *     True if the player is being notified, false if there was nothing to do.
+ *     In the former case, the operation continues when the player has
+ *     answered. A player whose process has vanished from the bus is not
+ *     notified, it is deactivated right away.
+ */
+bool AudioPath::Switch::Operation::begin_deactivate_player(bool players_changed)
+{
+    auto &player_id(get_switch().current_player_id_);
+
+    if(!players_changed || player_id.empty())
+        return false;
+
+    const AudioPath::Player *old_player = paths_.lookup_player(player_id);
+
+    if(!old_player->is_alive())
+    {
+        msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                  "%sNot deactivating player %s (%s), peer is gone", debug_prefix,
+                  old_player->id_.c_str(), old_player->name_.c_str());
+        player_id.clear();
+        return false;
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_DEBUG,
+              "%sDeactivate player %s (%s)", debug_prefix,
+              old_player->id_.c_str(), old_player->name_.c_str());
+
+    call_deactivate(*old_player, request_data_, get_cancellable(),
+                    peer_call(Step::DEACTIVATE_PLAYER, "Deactivate",
+                              old_player->id_));
+
+    return true;
+}
+
+void AudioPath::Switch::Operation::end_deactivate_player(GErrorWrapper &error)
+{
+    auto &player_id(get_switch().current_player_id_);
+
+    if(error.log_failure("Deactivate player"))
+        msg_error(0, LOG_ERR, "%sDeactivating player %s failed",
+                  debug_prefix, player_id.c_str());
+
+    player_id.clear();
+}
+
+/*!
+ * Give up on the current audio path without waiting for any peers.
+ *
+ * This is used when the deadline has passed. The peers involved in the
+ * operation may or may not have followed our requests, so the only sane
+ * state to assume is that there is no audio path at all.
+ */
+void AudioPath::Switch::Operation::force_release()
+{
+    auto &sw(get_switch());
+
+    sw.current_source_id_.clear();
+    sw.current_player_id_.clear();
+    sw.pending_.clear();
+}
+
+void AudioPath::Switch::Operation::record_peer_latency(Step step,
+                                                       gint64 duration_us,
+                                                       bool failed)
+{
+    SwitchStatistics::Phase phase;
+
+    switch(step)
+    {
+      case Step::DESELECT_SOURCE:
+        phase = SwitchStatistics::Phase::DESELECT_SOURCE;
+        break;
+
+      case Step::DEACTIVATE_PLAYER:
+        phase = SwitchStatistics::Phase::DEACTIVATE_PLAYER;
+        break;
+
+      case Step::ACTIVATE_PLAYER:
+        phase = SwitchStatistics::Phase::ACTIVATE_PLAYER;
+        break;
+
+      case Step::SELECT_SOURCE:
+        phase = SwitchStatistics::Phase::SELECT_SOURCE;
+        break;
+
+      case Step::NOT_STARTED:
+      case Step::DONE:
+        return;
+    }
+
+    auto &stats(switch_->statistics_);
+
+    stats.add(phase, duration_us);
+
+    if(failed)
+        stats.add_failure(phase);
+}
+
+void AudioPath::Switch::Operation::arm_deadline()
+{
+    cancellable_ = g_cancellable_new();
+    deadline_timer_ =
+        scheduler_.add_timer(deadline_ms_,
+                             [op = shared_from_this()] { op->deadline_expired(); });
+}
 
-    return activate_source(paths, source_id, player_id, deselected_result,
-                           select_source_now, std::move(request_data));
+void AudioPath::Switch::Operation::disarm_deadline()
+{
+    if(deadline_timer_ == 0)
+        return;
+
+    const unsigned int timer = deadline_timer_;
+    deadline_timer_ = 0;
+    scheduler_.remove_timer(timer);
 }
 
-AudioPath::Switch::ActivateResult
-AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
-                                   const char *source_id,
-                                   const std::string *&player_id,
-                                   DeselectedAudioSourceResult &deselected_result,
-                                   bool select_source_now,
-                                   GVariantWrapper &&request_data)
+/*!
+ * Cancel the D-Bus call in progress.
+ *
+ * The peer's answer is reported as canceled error in the next main loop
+ * iteration, and the operation is aborted then. Audio source activations
+ * which have not been started yet are dropped right away.
+ */
+void AudioPath::Switch::Operation::deadline_expired()
 {
-    player_id = nullptr;
-    deselected_result = DeselectedAudioSourceResult::NONE;
+    deadline_timer_ = 0;
+    deadline_exceeded_ = true;
+    g_cancellable_cancel(cancellable_);
+
+    if(step_ == Step::NOT_STARTED && is_activation())
+        switch_->drop_expired_operation(*this);
+}
+
+class AudioPath::Switch::ActivateOperation: public AudioPath::Switch::Operation
+{
+  private:
+    const ID source_id_;
+
+    /*!
+     * Requested audio source ID in case it is not known at all.
+     *
+     * This is only used for logging purposes.
+     */
+    const std::string unknown_source_id_;
+
+    const bool select_source_now_;
+    const uint32_t request_number_;
+    ActivateDoneFn done_;
+
+    ID player_id_;
+    bool players_changed_;
+    DeselectedAudioSourceResult deselected_result_;
+
+  public:
+    explicit ActivateOperation(Switch &sw, const Paths &paths,
+                               const char *source_id, bool select_source_now,
+                               GVariantWrapper &&request_data,
+                               unsigned int deadline_ms,
+                               uint32_t request_number,
+                               ActivateDoneFn &&done):
+        Operation(sw, paths, std::move(request_data), deadline_ms),
+        source_id_(IDTable::get_singleton().find(source_id)),
+        unknown_source_id_(source_id_.empty() ? source_id : ""),
+        select_source_now_(select_source_now),
+        request_number_(request_number),
+        done_(std::move(done)),
+        players_changed_(false),
+        deselected_result_(DeselectedAudioSourceResult::NONE)
+    {}
+
+    bool is_activation() const final override { return true; }
+
+    void supersede() final override
+    {
+        msg_vinfo(MESSAGE_LEVEL_DEBUG,
+                  "%sActivation of audio source %s superseded by newer request",
+                  debug_prefix, get_source_id_for_logging());
+
+        step_ = Step::DONE;
+        ++get_switch().activate_results_[size_t(ActivateResult::ERROR_SUPERSEDED)];
+        detach();
+
+        TAPSWITCH_PROBE(activate__superseded, get_source_id_for_logging(),
+                        request_number_);
 
-    if(source_id[0] == '\0')
+        if(done_ != nullptr)
+            done_(ActivateResult::ERROR_SUPERSEDED, nullptr,
+                  DeselectedAudioSourceResult::NONE);
+    }
+
+    void expire() final override
+    {
+        msg_error(0, LOG_ERR,
+                  "%sActivation of audio source %s not started within %u ms",
+                  debug_prefix, get_source_id_for_logging(), get_deadline_ms());
+
+        step_ = Step::DONE;
+        ++get_switch().activate_results_[size_t(ActivateResult::ERROR_DEADLINE_EXCEEDED)];
+        detach();
+
+        TAPSWITCH_PROBE(activate__done, get_source_id_for_logging(), "",
+                        int(ActivateResult::ERROR_DEADLINE_EXCEEDED),
+                        int(DeselectedAudioSourceResult::NONE),
+                        request_number_);
+
+        if(done_ != nullptr)
+            done_(ActivateResult::ERROR_DEADLINE_EXCEEDED, nullptr,
+                  DeselectedAudioSourceResult::NONE);
+    }
+
+  protected:
+    void do_start() final override;
+    void do_continue(Step step, GErrorWrapper &error) final override;
+
+  private:
+    void activate_player();
+    void select_source();
+
+    const char *get_source_id_for_logging() const
+    {
+        return source_id_.empty() ? unknown_source_id_.c_str() : source_id_.c_str();
+    }
+
+    void done(ActivateResult result, const ID *player_id)
+    {
+        TAPSWITCH_PROBE(activate__done, get_source_id_for_logging(),
+                        player_id != nullptr ? player_id->c_str() : "",
+                        int(result), int(deselected_result_), request_number_);
+        record_duration(SwitchStatistics::Phase::ACTIVATION);
+        ++get_switch().activate_results_[size_t(result)];
+        finish([this, result, player_id] ()
+               {
+                   if(done_ != nullptr)
+                       done_(result, player_id, deselected_result_);
+               });
+    }
+
+    const ID *get_player_id_in_paths() const
+    {
+        const auto *player = paths_.lookup_player(player_id_);
+        return player != nullptr ? &player->id_ : nullptr;
+    }
+};
+
+void AudioPath::Switch::ActivateOperation::do_start()
+{
+    auto &sw(get_switch());
+
+    TAPSWITCH_PROBE(activate__start, get_source_id_for_logging(),
+                    sw.current_source_id_.c_str(), sw.current_player_id_.c_str(),
+                    int(select_source_now_), request_number_);
+
+    if(source_id_.empty() && unknown_source_id_.empty())
     {
         msg_error(EINVAL, LOG_ERR, "%sEmpty audio source ID", debug_prefix);
 
-        if(pending_.have_pending_activation())
-            deselected_result = DeselectedAudioSourceResult::DESELECTED_PENDING;
+        if(sw.pending_.have_pending_activation())
+            deselected_result_ = DeselectedAudioSourceResult::DESELECTED_PENDING;
 
-        pending_.clear();
-        return ActivateResult::ERROR_SOURCE_UNKNOWN;
+        sw.pending_.clear();
+        done(ActivateResult::ERROR_SOURCE_UNKNOWN, nullptr);
+        return;
     }
 
-    if(source_id == current_source_id_)
+    if(!source_id_.empty() && source_id_ == sw.current_source_id_)
     {
         msg_vinfo(MESSAGE_LEVEL_DEBUG,
                   "%sAudio source not changed", debug_prefix);
-        player_id = &current_player_id_;
-        msg_log_assert(!pending_.have_pending_activation());
-        return ActivateResult::OK_UNCHANGED;
+        msg_log_assert(!sw.pending_.have_pending_activation());
+        done(ActivateResult::OK_UNCHANGED, &sw.current_player_id_);
+        return;
     }
 
-    if(pending_.have_pending_activation() &&
-       source_id == pending_.get_audio_source_id())
+    if(sw.pending_.have_pending_activation() &&
+       source_id_ == sw.pending_.get_audio_source_id())
     {
         msg_vinfo(MESSAGE_LEVEL_DEBUG,
                   "%sAudio source activation for %s already pending",
-                  debug_prefix, source_id);
-        player_id = &current_player_id_;
-        return ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED;
+                  debug_prefix, source_id_.c_str());
+        done(ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED,
+             &sw.current_player_id_);
+        return;
     }
 
-    const auto path(paths.lookup_path(source_id));
+    const auto path(paths_.lookup_path(source_id_));
 
     if(path.second == nullptr)
     {
@@ -211,7 +967,10 @@ AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
         if(path.first == nullptr)
         {
             msg_error(0, LOG_NOTICE,
-                      "%sUnknown audio source %s", debug_prefix, source_id);
+                      "%sUnknown audio source %s", debug_prefix,
+                      source_id_.empty()
+                      ? unknown_source_id_.c_str()
+                      : source_id_.c_str());
             result = ActivateResult::ERROR_SOURCE_UNKNOWN;
         }
         else
@@ -224,57 +983,327 @@ AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
             result = ActivateResult::ERROR_PLAYER_UNKNOWN;
         }
 
-        if(pending_.have_pending_activation())
-            deselected_result = DeselectedAudioSourceResult::DESELECTED_PENDING;
+        if(sw.pending_.have_pending_activation())
+            deselected_result_ = DeselectedAudioSourceResult::DESELECTED_PENDING;
 
-        pending_.clear();
-        return result;
+        sw.pending_.clear();
+        done(result, nullptr);
+        return;
     }
     else
         msg_log_assert(path.first != nullptr);
 
-    player_id = &path.second->id_;
+    if(!path.first->is_alive() || !path.second->is_alive())
+    {
+        /*
+         * No point in notifying anyone if the new path cannot work anyway.
+         * Nothing has been touched, so the current path and any pending
+         * activation stay as they are, and the request fails as if the
+         * vanished component had never been registered.
+         */
+        const bool source_is_dead(!path.first->is_alive());
+
+        msg_error(0, LOG_NOTICE, "%s%s %s has vanished from the bus",
+                  debug_prefix, source_is_dead ? "Audio source" : "Player",
+                  source_is_dead
+                  ? path.first->id_.c_str()
+                  : path.second->id_.c_str());
+
+        done(source_is_dead
+             ? ActivateResult::ERROR_SOURCE_UNKNOWN
+             : ActivateResult::ERROR_PLAYER_UNKNOWN,
+             nullptr);
+        return;
+    }
 
-    deselected_result =
-        deselect_source(paths, request_data, current_source_id_, pending_);
+    player_id_ = path.second->id_;
+    players_changed_ = (player_id_ != sw.current_player_id_);
 
-    const bool players_changed = (*player_id != current_player_id_);
+    /*
+     * The old audio source and the old player do not depend on each other's
+     * answers, so they are notified concurrently. The new player is only
+     * activated after both have answered.
+     */
+    const bool deselecting = begin_deselect_source(deselected_result_);
+    const bool deactivating = begin_deactivate_player(players_changed_);
+
+    if(!deselecting && !deactivating)
+        activate_player();
+}
+
+void AudioPath::Switch::ActivateOperation::do_continue(Step step,
+                                                       GErrorWrapper &error)
+{
+    if(deadline_exceeded_)
+    {
+        error.log_failure("Audio path switch");
+        msg_error(0, LOG_ERR,
+                  "%sActivating audio source %s took longer than %u ms, "
+                  "releasing audio path",
+                  debug_prefix, source_id_.c_str(), get_deadline_ms());
+        force_release();
+        done(ActivateResult::ERROR_DEADLINE_EXCEEDED, nullptr);
+        return;
+    }
 
-    if(players_changed)
+    switch(step)
     {
-        deactivate_player(paths, request_data, current_player_id_);
+      case Step::DESELECT_SOURCE:
+        end_deselect_source(error);
+
+        if(!have_calls_in_flight())
+            activate_player();
+
+        break;
+
+      case Step::DEACTIVATE_PLAYER:
+        end_deactivate_player(error);
+
+        if(!have_calls_in_flight())
+            activate_player();
 
-        if(!activate_player(*path.second, request_data))
-            return ActivateResult::ERROR_PLAYER_FAILED;
+        break;
 
-        current_player_id_ = path.second->id_;
+      case Step::ACTIVATE_PLAYER:
+        if(error.log_failure("Activate player"))
+        {
+            msg_error(0, LOG_ERR, "%sActivating player %s failed",
+                      debug_prefix, player_id_.c_str());
+            done(ActivateResult::ERROR_PLAYER_FAILED, get_player_id_in_paths());
+            break;
+        }
+
+        get_switch().current_player_id_ = player_id_;
+        select_source();
+        break;
+
+      case Step::SELECT_SOURCE:
+        {
+            if(!check_select_source_result(error, source_id_, select_source_now_))
+            {
+                done(ActivateResult::ERROR_SOURCE_FAILED, get_player_id_in_paths());
+                break;
+            }
+
+            const auto result = players_changed_
+                ? (select_source_now_
+                   ? ActivateResult::OK_PLAYER_SWITCHED
+                   : ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED)
+                : (select_source_now_
+                   ? ActivateResult::OK_PLAYER_SAME
+                   : ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED);
+
+            auto &sw(get_switch());
+
+            if(select_source_now_)
+                sw.current_source_id_ = source_id_;
+            else
+                sw.pending_.set(source_id_, std::move(request_data_), result);
+
+            done(result, get_player_id_in_paths());
+        }
+
+        break;
+
+      case Step::NOT_STARTED:
+      case Step::DONE:
+        MSG_BUG("Unexpected peer answer in activation step %d", int(step));
+        break;
     }
+}
 
-    if(!select_source(*path.first, select_source_now, GVariantWrapper(request_data)))
-        return ActivateResult::ERROR_SOURCE_FAILED;
+void AudioPath::Switch::ActivateOperation::activate_player()
+{
+    if(!players_changed_)
+    {
+        select_source();
+        return;
+    }
 
-    const auto result = players_changed
-        ? (select_source_now
-           ? ActivateResult::OK_PLAYER_SWITCHED
-           : ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED)
-        : (select_source_now
-           ? ActivateResult::OK_PLAYER_SAME
-           : ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED);
+    const auto *player = paths_.lookup_player(player_id_);
 
-    if(select_source_now)
-        current_source_id_ = path.first->id_;
-    else
-        pending_.set(path.first->id_, std::move(request_data), result);
+    msg_vinfo(MESSAGE_LEVEL_DEBUG, "%sActivate player %s (%s)",
+              debug_prefix, player->id_.c_str(), player->name_.c_str());
+
+    call_activate(*player, request_data_, get_cancellable(),
+                  peer_call(Step::ACTIVATE_PLAYER, "Activate", player_id_));
+}
+
+void AudioPath::Switch::ActivateOperation::select_source()
+{
+    call_selected(*paths_.lookup_source(source_id_), select_source_now_,
+                  request_data_, get_cancellable(),
+                  peer_call(Step::SELECT_SOURCE,
+                            select_source_now_ ? "Selected" : "SelectedOnHold",
+                            source_id_));
+}
+
+class AudioPath::Switch::ReleaseOperation: public AudioPath::Switch::Operation
+{
+  private:
+    const bool kill_player_;
+    ReleaseDoneFn done_;
+
+    bool have_deselected_source_;
+    bool have_deactivated_player_;
+    DeselectedAudioSourceResult deselected_result_;
+
+  public:
+    explicit ReleaseOperation(Switch &sw, const Paths &paths, bool kill_player,
+                              GVariantWrapper &&request_data,
+                              unsigned int deadline_ms,
+                              ReleaseDoneFn &&done):
+        Operation(sw, paths, std::move(request_data), deadline_ms),
+        kill_player_(kill_player),
+        done_(std::move(done)),
+        have_deselected_source_(false),
+        have_deactivated_player_(false),
+        deselected_result_(DeselectedAudioSourceResult::NONE)
+    {}
+
+  protected:
+    void do_start() final override;
+    void do_continue(Step step, GErrorWrapper &error) final override;
+
+  private:
+    void done();
+};
+
+void AudioPath::Switch::ReleaseOperation::do_start()
+{
+    auto &sw(get_switch());
+
+    have_deselected_source_ = !sw.current_source_id_.empty();
+    have_deactivated_player_ = kill_player_ && !sw.current_player_id_.empty();
+
+    TAPSWITCH_PROBE(release__start, sw.current_source_id_.c_str(),
+                    sw.current_player_id_.c_str(), int(kill_player_));
+
+    msg_vinfo(MESSAGE_LEVEL_DEBUG,
+              "%sRelease current audio path (%s), %s player",
+              debug_prefix,
+              have_deselected_source_ ? "<NONE>" : sw.current_source_id_.c_str(),
+              kill_player_ ? "deactivate" : "keep");
 
-    return result;
+    const bool deselecting = begin_deselect_source(deselected_result_);
+    const bool deactivating = begin_deactivate_player(have_deactivated_player_);
+
+    if(!deselecting && !deactivating)
+        done();
 }
 
-AudioPath::Switch::ActivateResult
-AudioPath::Switch::complete_pending_source_activation(const AudioPath::Paths &paths,
-                                                      std::string *source_id)
+void AudioPath::Switch::ReleaseOperation::do_continue(Step step,
+                                                      GErrorWrapper &error)
 {
-    if(!pending_.have_pending_activation())
-        return ActivateResult::ERROR_SOURCE_UNKNOWN;
+    if(deadline_exceeded_)
+    {
+        error.log_failure("Audio path release");
+        msg_error(0, LOG_ERR,
+                  "%sReleasing audio path took longer than %u ms, "
+                  "releasing without waiting",
+                  debug_prefix, get_deadline_ms());
+        force_release();
+        done();
+        return;
+    }
+
+    switch(step)
+    {
+      case Step::DESELECT_SOURCE:
+        end_deselect_source(error);
+
+        if(!have_calls_in_flight())
+            done();
+
+        break;
+
+      case Step::DEACTIVATE_PLAYER:
+        end_deactivate_player(error);
+
+        if(!have_calls_in_flight())
+            done();
+
+        break;
+
+      case Step::NOT_STARTED:
+      case Step::ACTIVATE_PLAYER:
+      case Step::SELECT_SOURCE:
+      case Step::DONE:
+        MSG_BUG("Unexpected peer answer in release step %d", int(step));
+        break;
+    }
+}
+
+void AudioPath::Switch::ReleaseOperation::done()
+{
+    finish([this] ()
+           {
+               const auto &player_id(get_switch().current_player_id_);
+               const auto result =
+                   (have_deselected_source_
+                    ? (have_deactivated_player_
+                       ? ReleaseResult::COMPLETE_RELEASE
+                       : ReleaseResult::SOURCE_DESELECTED)
+                    : (have_deactivated_player_
+                       ? ReleaseResult::PLAYER_DEACTIVATED
+                       : ReleaseResult::UNCHANGED));
+
+               TAPSWITCH_PROBE(release__done, player_id.c_str(), int(result),
+                               int(deselected_result_));
+
+               if(done_ != nullptr)
+                   done_(result, player_id.empty() ? nullptr : &player_id,
+                         deselected_result_);
+           });
+}
+
+class AudioPath::Switch::CompletePendingOperation:
+    public AudioPath::Switch::Operation
+{
+  private:
+    PendingDoneFn done_;
+
+    ID source_id_;
+    ActivateResult phase_one_result_;
+
+  public:
+    explicit CompletePendingOperation(Switch &sw, const Paths &paths,
+                                      unsigned int deadline_ms,
+                                      PendingDoneFn &&done):
+        Operation(sw, paths, GVariantWrapper(), deadline_ms),
+        done_(std::move(done)),
+        phase_one_result_(ActivateResult::ERROR_SOURCE_UNKNOWN)
+    {}
+
+  protected:
+    void do_start() final override;
+    void do_continue(Step step, GErrorWrapper &error) final override;
+
+  private:
+    void done(ActivateResult result)
+    {
+        TAPSWITCH_PROBE(pending__complete__done, source_id_.c_str(),
+                        int(result));
+        finish([this, result] ()
+               {
+                   if(done_ != nullptr)
+                       done_(result, source_id_);
+               });
+    }
+};
+
+void AudioPath::Switch::CompletePendingOperation::do_start()
+{
+    auto &pending(get_switch().pending_);
+
+    TAPSWITCH_PROBE(pending__complete__start,
+                    pending.get_audio_source_id().c_str());
+
+    if(!pending.have_pending_activation())
+    {
+        done(ActivateResult::ERROR_SOURCE_UNKNOWN);
+        return;
+    }
 
     /*
      * Essentially, this is the tail of #AudioPath::Switch::activate_source().
@@ -284,96 +1313,367 @@ AudioPath::Switch::complete_pending_source_activation(const AudioPath::Paths &pa
      * to activate the audio source so that the player raring to go can start
      * playing.
      */
-    const auto path(paths.lookup_path(pending_.get_audio_source_id()));
-    const auto result(pending_.get_phase_one_result());
+    phase_one_result_ = pending.get_phase_one_result();
+    pending.take_audio_source_id(source_id_);
+    request_data_ = pending.clear();
 
-    if(source_id != nullptr)
-        pending_.take_audio_source_id(*source_id);
+    call_selected(*paths_.lookup_source(source_id_), true, request_data_,
+                  get_cancellable(),
+                  peer_call(Step::SELECT_SOURCE, "Selected", source_id_));
+}
 
-    auto request_data(pending_.clear());
+void AudioPath::Switch::CompletePendingOperation::do_continue(Step step,
+                                                              GErrorWrapper &error)
+{
+    if(step != Step::SELECT_SOURCE)
+    {
+        MSG_BUG("Unexpected peer answer in completion step %d", int(step));
+        return;
+    }
 
-    if(!select_source(*path.first, true, std::move(request_data)))
-        return ActivateResult::ERROR_SOURCE_FAILED;
+    if(deadline_exceeded_)
+    {
+        error.log_failure("Pending audio path switch");
+        msg_error(0, LOG_ERR,
+                  "%sCompleting activation of audio source %s took longer "
+                  "than %u ms, releasing audio path",
+                  debug_prefix, source_id_.c_str(), get_deadline_ms());
+        force_release();
+        done(ActivateResult::ERROR_DEADLINE_EXCEEDED);
+        return;
+    }
 
-    current_source_id_ = path.first->id_;
+    if(!check_select_source_result(error, source_id_, true))
+    {
+        done(ActivateResult::ERROR_SOURCE_FAILED);
+        return;
+    }
 
-    return result;
+    get_switch().current_source_id_ = source_id_;
+    done(phase_one_result_);
 }
 
-AudioPath::Switch::ActivateResult
-AudioPath::Switch::cancel_pending_source_activation(const AudioPath::Paths &paths,
-                                                    std::string &source_id)
+class AudioPath::Switch::CancelPendingOperation:
+    public AudioPath::Switch::Operation
 {
-    if(!pending_.have_pending_activation())
-        return ActivateResult::ERROR_SOURCE_UNKNOWN;
+  private:
+    PendingDoneFn done_;
+    ID source_id_;
+
+  public:
+    explicit CancelPendingOperation(Switch &sw, const Paths &paths,
+                                    unsigned int deadline_ms,
+                                    PendingDoneFn &&done):
+        Operation(sw, paths, GVariantWrapper(), deadline_ms),
+        done_(std::move(done))
+    {}
+
+  protected:
+    void do_start() final override;
+    void do_continue(Step step, GErrorWrapper &error) final override;
+
+  private:
+    void done(ActivateResult result)
+    {
+        TAPSWITCH_PROBE(pending__cancel__done, source_id_.c_str(), int(result));
+        finish([this, result] ()
+               {
+                   if(done_ != nullptr)
+                       done_(result, source_id_);
+               });
+    }
+};
 
-    const auto path(paths.lookup_path(pending_.get_audio_source_id()));
+void AudioPath::Switch::CancelPendingOperation::do_start()
+{
+    auto &pending(get_switch().pending_);
 
-    pending_.take_audio_source_id(source_id);
+    TAPSWITCH_PROBE(pending__cancel__start,
+                    pending.get_audio_source_id().c_str());
 
-    const AudioPath::Source *source = paths.lookup_source(source_id);
-    auto request_data(pending_.clear());
+    if(!pending.have_pending_activation())
+    {
+        done(ActivateResult::ERROR_SOURCE_UNKNOWN);
+        return;
+    }
 
-    GErrorWrapper error;
-    tdbus_aupath_source_call_deselected_sync(source->get_dbus_proxy().get_as_nonconst(),
-                                             source_id.c_str(),
-                                             GVariantWrapper::get(request_data),
-                                             nullptr, error.await());
+    pending.take_audio_source_id(source_id_);
+    request_data_ = pending.clear();
+
+    call_deselected(*paths_.lookup_source(source_id_), source_id_,
+                    request_data_, get_cancellable(),
+                    peer_call(Step::DESELECT_SOURCE, "Deselected", source_id_));
+}
+
+void AudioPath::Switch::CancelPendingOperation::do_continue(Step step,
+                                                            GErrorWrapper &error)
+{
+    if(step != Step::DESELECT_SOURCE)
+    {
+        MSG_BUG("Unexpected peer answer in cancel step %d", int(step));
+        return;
+    }
+
+    if(deadline_exceeded_)
+    {
+        error.log_failure("Pending audio path cancellation");
+        msg_error(0, LOG_ERR,
+                  "%sDeselecting audio source %s (canceled) took longer "
+                  "than %u ms, releasing audio path",
+                  debug_prefix, source_id_.c_str(), get_deadline_ms());
+        force_release();
+        done(ActivateResult::ERROR_DEADLINE_EXCEEDED);
+        return;
+    }
 
-    current_source_id_.clear();
+    get_switch().current_source_id_.clear();
 
     if(error.log_failure("Deselect source (canceled)"))
     {
         msg_error(0, LOG_ERR,
                   "%sDeselecting audio source %s (canceled) failed",
-                  debug_prefix, source->id_.c_str());
-        return ActivateResult::ERROR_SOURCE_FAILED;
+                  debug_prefix, source_id_.c_str());
+        done(ActivateResult::ERROR_SOURCE_FAILED);
+        return;
+    }
+
+    done(ActivateResult::OK_PLAYER_SWITCHED);
+}
+
+constexpr size_t AudioPath::Switch::NUMBER_OF_ACTIVATE_RESULTS;
+
+const char *AudioPath::Switch::activate_result_name(ActivateResult result)
+{
+    switch(result)
+    {
+      case ActivateResult::ERROR_SOURCE_UNKNOWN:
+        return "error_source_unknown";
+
+      case ActivateResult::ERROR_SOURCE_FAILED:
+        return "error_source_failed";
+
+      case ActivateResult::ERROR_PLAYER_UNKNOWN:
+        return "error_player_unknown";
+
+      case ActivateResult::ERROR_PLAYER_FAILED:
+        return "error_player_failed";
+
+      case ActivateResult::ERROR_DEADLINE_EXCEEDED:
+        return "error_deadline_exceeded";
+
+      case ActivateResult::ERROR_SUPERSEDED:
+        return "error_superseded";
+
+      case ActivateResult::OK_UNCHANGED:
+        return "ok_unchanged";
+
+      case ActivateResult::OK_PLAYER_SAME:
+        return "ok_player_same";
+
+      case ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED:
+        return "ok_player_same_source_deferred";
+
+      case ActivateResult::OK_PLAYER_SWITCHED:
+        return "ok_player_switched";
+
+      case ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED:
+        return "ok_player_switched_source_deferred";
+    }
+
+    return "unknown";
+}
+
+AudioPath::Switch::~Switch()
+{
+    if(coalescing_timer_ != 0)
+        scheduler_.remove_timer(coalescing_timer_);
+
+    if(current_operation_ != nullptr)
+        current_operation_->detach();
+
+    for(auto &op : queued_operations_)
+        op->detach();
+}
+
+void AudioPath::Switch::schedule(std::shared_ptr<Operation> op)
+{
+    const bool is_activation = op->is_activation();
+
+    if(is_activation && coalesce_activations_)
+        supersede_queued_activation();
+
+    op->submitted();
+    queued_operations_.emplace_back(std::move(op));
+
+    if(current_operation_ != nullptr || coalescing_timer_ != 0)
+        return;
+
+    if(is_activation && coalescing_window_ms_ > 0)
+        coalescing_timer_ =
+            scheduler_.add_timer(coalescing_window_ms_,
+                                 [this] { coalescing_window_expired(); });
+    else
+        run_queued_operations();
+}
+
+/*!
+ * Drop the most recently queued operation if it is an audio source activation.
+ *
+ * Activations queued before some other kind of operation are left alone
+ * because skipping them could change the effect of that operation.
+ */
+void AudioPath::Switch::supersede_queued_activation()
+{
+    if(queued_operations_.empty() || !queued_operations_.back()->is_activation())
+        return;
+
+    auto op(std::move(queued_operations_.back()));
+    queued_operations_.pop_back();
+    op->supersede();
+}
+
+/*!
+ * Measure time spent with a deferred audio source activation.
+ *
+ * The duration is recorded when the pending activation is completed,
+ * canceled, or replaced by a pending activation for another audio source.
+ */
+void AudioPath::Switch::update_deferred_statistics()
+{
+    const ID &source_id(pending_.get_audio_source_id());
+
+    if(source_id == deferred_source_id_)
+        return;
+
+    const int64_t now = scheduler_.now_us();
+
+    if(!deferred_source_id_.empty())
+        statistics_.add(SwitchStatistics::Phase::DEFERRED,
+                        now - deferred_since_us_);
+
+    deferred_source_id_ = source_id;
+    deferred_since_us_ = now;
+}
+
+/*!
+ * Drop queued operation whose deadline has passed.
+ */
+void AudioPath::Switch::drop_expired_operation(Operation &op)
+{
+    const auto it(std::find_if(queued_operations_.begin(),
+                               queued_operations_.end(),
+                               [&op] (const std::shared_ptr<Operation> &queued)
+                               { return queued.get() == &op; }));
+
+    if(it == queued_operations_.end())
+        return;
+
+    auto expired(std::move(*it));
+    queued_operations_.erase(it);
+    expired->expire();
+}
+
+void AudioPath::Switch::coalescing_window_expired()
+{
+    coalescing_timer_ = 0;
+    run_queued_operations();
+}
+
+void AudioPath::Switch::run_queued_operations()
+{
+    while(current_operation_ == nullptr && !queued_operations_.empty())
+    {
+        auto op(std::move(queued_operations_.front()));
+        queued_operations_.pop_front();
+
+        current_operation_ = op;
+        op->start();
     }
+}
 
-    return ActivateResult::OK_PLAYER_SWITCHED;
+static unsigned int get_deadline_from_request_data(const GVariantWrapper &request_data,
+                                                   unsigned int default_deadline_ms)
+{
+    guint32 deadline_ms;
+
+    if(request_data != nullptr &&
+       g_variant_lookup(GVariantWrapper::get(request_data),
+                        "deadline_ms", "u", &deadline_ms))
+        return deadline_ms;
+
+    return default_deadline_ms;
 }
 
-AudioPath::Switch::ReleaseResult
-AudioPath::Switch::release_path(const AudioPath::Paths &paths, bool kill_player,
-                                const std::string *&player_id,
-                                DeselectedAudioSourceResult &deselected_result)
+static GVariantWrapper mk_empty_request_data()
 {
     GVariantDict dict;
     g_variant_dict_init(&dict, nullptr);
-    auto request_data(GVariantWrapper(g_variant_dict_end(&dict)));
+    return GVariantWrapper(g_variant_dict_end(&dict));
+}
 
-    return release_path(paths, kill_player, player_id, deselected_result,
-                        std::move(request_data));
+void AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
+                                        const char *source_id,
+                                        bool select_source_now,
+                                        ActivateDoneFn &&done)
+{
+    activate_source(paths, source_id, select_source_now,
+                    mk_empty_request_data(), std::move(done));
 }
 
-AudioPath::Switch::ReleaseResult
-AudioPath::Switch::release_path(const AudioPath::Paths &paths, bool kill_player,
-                                const std::string *&player_id,
-                                DeselectedAudioSourceResult &deselected_result,
-                                GVariantWrapper &&request_data)
+void AudioPath::Switch::activate_source(const AudioPath::Paths &paths,
+                                        const char *source_id,
+                                        bool select_source_now,
+                                        GVariantWrapper &&request_data,
+                                        ActivateDoneFn &&done)
 {
-    const bool have_deselected_source = !current_source_id_.empty();
-    const bool have_deactivated_player = kill_player && !current_player_id_.empty();
+    const unsigned int deadline_ms(get_deadline_from_request_data(request_data,
+                                                                  deadline_ms_));
 
-    msg_vinfo(MESSAGE_LEVEL_DEBUG,
-              "%sRelease current audio path (%s), %s player",
-              debug_prefix,
-              have_deselected_source ? "<NONE>" : current_source_id_.c_str(),
-              kill_player ? "deactivate" : "keep");
+    const uint32_t request_number(next_activation_number_++);
+
+    TAPSWITCH_PROBE(activate__request, source_id, int(select_source_now),
+                    deadline_ms, request_number);
+
+    schedule(std::make_shared<ActivateOperation>(*this, paths, source_id,
+                                                 select_source_now,
+                                                 std::move(request_data),
+                                                 deadline_ms, request_number,
+                                                 std::move(done)));
+}
 
-    deselected_result =
-        deselect_source(paths, request_data, current_source_id_, pending_);
+void AudioPath::Switch::complete_pending_source_activation(const AudioPath::Paths &paths,
+                                                           PendingDoneFn &&done)
+{
+    schedule(std::make_shared<CompletePendingOperation>(*this, paths,
+                                                        deadline_ms_,
+                                                        std::move(done)));
+}
 
-    if(have_deactivated_player)
-        deactivate_player(paths, request_data, current_player_id_);
+void AudioPath::Switch::cancel_pending_source_activation(const AudioPath::Paths &paths,
+                                                         PendingDoneFn &&done)
+{
+    schedule(std::make_shared<CancelPendingOperation>(*this, paths,
+                                                      deadline_ms_,
+                                                      std::move(done)));
+}
 
-    player_id = current_player_id_.empty() ? nullptr : &current_player_id_;
+void AudioPath::Switch::release_path(const AudioPath::Paths &paths,
+                                     bool kill_player, ReleaseDoneFn &&done)
+{
+    release_path(paths, kill_player, mk_empty_request_data(), std::move(done));
+}
 
-    return (have_deselected_source
-            ? (have_deactivated_player
-               ? ReleaseResult::COMPLETE_RELEASE
-               : ReleaseResult::SOURCE_DESELECTED)
-            : (have_deactivated_player
-               ? ReleaseResult::PLAYER_DEACTIVATED
-               : ReleaseResult::UNCHANGED));
+void AudioPath::Switch::release_path(const AudioPath::Paths &paths,
+                                     bool kill_player,
+                                     GVariantWrapper &&request_data,
+                                     ReleaseDoneFn &&done)
+{
+    const unsigned int deadline_ms(get_deadline_from_request_data(request_data,
+                                                                  deadline_ms_));
+
+    TAPSWITCH_PROBE(release__request, int(kill_player));
+    schedule(std::make_shared<ReleaseOperation>(*this, paths, kill_player,
+                                                std::move(request_data),
+                                                deadline_ms,
+                                                std::move(done)));
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -23,7 +23,14 @@
 #define AUDIOPATHSWITCH_HH
 
 #include <string>
-
+#include <array>
+#include <deque>
+#include <memory>
+#include <functional>
+
+#include "audiopathid.hh"
+#include "switchstatistics.hh"
+#include "scheduler.hh"
 #include "gvariantwrapper.hh"
 
 /*!
@@ -45,13 +52,20 @@ class Switch
         ERROR_SOURCE_FAILED,
         ERROR_PLAYER_UNKNOWN,
         ERROR_PLAYER_FAILED,
+        ERROR_DEADLINE_EXCEEDED,
+        ERROR_SUPERSEDED,
         OK_UNCHANGED,
         OK_PLAYER_SAME,
         OK_PLAYER_SAME_SOURCE_DEFERRED,
         OK_PLAYER_SWITCHED,
         OK_PLAYER_SWITCHED_SOURCE_DEFERRED,
+
+        LAST_RESULT = OK_PLAYER_SWITCHED_SOURCE_DEFERRED,
     };
 
+    static constexpr size_t NUMBER_OF_ACTIVATE_RESULTS =
+        size_t(ActivateResult::LAST_RESULT) + 1;
+
     enum class ReleaseResult
     {
         SOURCE_DESELECTED,
@@ -78,7 +92,7 @@ class Switch
          * an audio source at a time the appliance is in some state not yet
          * suitable for playback (sleep mode or something like that).
          */
-        std::string source_id_;
+        ID source_id_;
 
         /*!
          * Data passed by caller when requesting an audio source.
@@ -106,7 +120,7 @@ class Switch
             phase_one_result_(ActivateResult::ERROR_SOURCE_UNKNOWN)
         {}
 
-        void set(const std::string &source_id, GVariantWrapper &&request_data,
+        void set(const ID &source_id, GVariantWrapper &&request_data,
                  ActivateResult result)
         {
             source_id_ = source_id;
@@ -124,37 +138,207 @@ class Switch
         }
 
         bool have_pending_activation() const { return !source_id_.empty(); }
-        const std::string &get_audio_source_id() const { return source_id_; }
+        const ID &get_audio_source_id() const { return source_id_; }
         ActivateResult get_phase_one_result() const { return phase_one_result_; }
 
-        void take_audio_source_id(std::string &dest) { return dest.swap(source_id_); }
+        void take_audio_source_id(ID &dest)
+        {
+            dest = source_id_;
+            source_id_.clear();
+        }
     };
 
+    using ActivateDoneFn =
+        std::function<void(ActivateResult result, const ID *player_id,
+                           DeselectedAudioSourceResult deselected_result)>;
+
+    using ReleaseDoneFn =
+        std::function<void(ReleaseResult result, const ID *player_id,
+                           DeselectedAudioSourceResult deselected_result)>;
+
+    using PendingDoneFn =
+        std::function<void(ActivateResult result, const ID &source_id)>;
+
+    /*!
+     * State of a single audio path operation while talking to the peers.
+     *
+     * Each request for changing the audio path is represented by an object
+     * derived from this class. The D-Bus method calls made to players and
+     * audio sources are asynchronous, and the operation object advances to
+     * its next step whenever a peer has answered.
+     */
+    class Operation;
+    class ActivateOperation;
+    class ReleaseOperation;
+    class CompletePendingOperation;
+    class CancelPendingOperation;
+
   private:
-    std::string current_source_id_;
-    std::string current_player_id_;
+    /*!
+     * Clock and timers, usually backed by the GLib main loop.
+     */
+    Scheduler &scheduler_;
+
+    ID current_source_id_;
+    ID current_player_id_;
 
     /*!
      * State while waiting for the appliance to get ready.
      */
     PendingActivation pending_;
 
+    /*!
+     * The operation which is currently waiting for answers from peers.
+     *
+     * There is at most one operation in progress at any time. Any further
+     * operations are queued in #AudioPath::Switch::queued_operations_ and
+     * started in order of submission, so that the state transitions are the
+     * same as if all operations had been executed one after the other.
+     */
+    std::shared_ptr<Operation> current_operation_;
+
+    /*!
+     * Operations submitted while another operation is in progress.
+     */
+    std::deque<std::shared_ptr<Operation>> queued_operations_;
+
+    /*!
+     * Maximum time in milliseconds any operation may take.
+     *
+     * The budget starts when the operation is submitted, so that time spent
+     * waiting for other operations counts against it, and it is shared by
+     * all D-Bus calls made by the operation. When the budget is exhausted,
+     * the audio path is released without waiting for any further answers,
+     * and activations fail with
+     * #AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED. Audio
+     * source activations whose budget is exhausted before they could be
+     * started are dropped without contacting any peers; releases of the
+     * audio path are carried out without contacting any peers.
+     *
+     * A value of 0 means no deadline. It can be overridden per audio source
+     * activation and release by passing a \c uint32 named \c deadline_ms in
+     * the request data.
+     */
+    unsigned int deadline_ms_;
+
+    /*!
+     * Whether or not queued audio source activations are superseded by newer
+     * ones.
+     *
+     * If enabled, an audio source activation which has not been started yet
+     * is dropped when another activation is requested, and its \c done
+     * function is called with
+     * #AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED. Only the most
+     * recent request is executed, so that bursts of requests do not restart
+     * players for audio sources nobody is interested in anymore.
+     */
+    bool coalesce_activations_;
+
+    /*!
+     * Time in milliseconds an activation is held back while the switch is
+     * idle.
+     *
+     * Requests arriving within this window supersede each other as if the
+     * first one had been queued behind some operation in progress. A value
+     * of 0 means that activations are started right away if the switch is
+     * idle. Only used if #AudioPath::Switch::coalesce_activations_ is set.
+     */
+    unsigned int coalescing_window_ms_;
+
+    /*!
+     * Timer for #AudioPath::Switch::coalescing_window_ms_.
+     */
+    unsigned int coalescing_timer_;
+
+    /*!
+     * Time spent in the phases of audio path switching.
+     */
+    SwitchStatistics statistics_;
+
+    /*!
+     * Number of audio source activations by result.
+     */
+    std::array<uint64_t, NUMBER_OF_ACTIVATE_RESULTS> activate_results_;
+
+    /*!
+     * Audio source whose activation is deferred, as seen by the statistics.
+     *
+     * This is a copy of the ID in #AudioPath::Switch::pending_ taken at the
+     * end of each operation, so that the time spent waiting for the
+     * appliance can be measured without tracking every single place where
+     * the pending activation is modified.
+     */
+    ID deferred_source_id_;
+    int64_t deferred_since_us_;
+
+    /*!
+     * Number of the next audio source activation request.
+     *
+     * Passed to all USDT probes concerning audio source activation, so that
+     * tracers can tell requests apart even if they are superseded or expire
+     * while queued.
+     */
+    uint32_t next_activation_number_;
+
   public:
     Switch(const Switch &) = delete;
     Switch &operator=(const Switch &) = delete;
 
-    explicit Switch() {}
+    explicit Switch(Scheduler &scheduler = Scheduler::get_default()):
+        scheduler_(scheduler),
+        deadline_ms_(0),
+        coalesce_activations_(false),
+        coalescing_window_ms_(0),
+        coalescing_timer_(0),
+        deferred_since_us_(0),
+        next_activation_number_(0)
+    {
+        activate_results_.fill(0);
+    }
+
+    ~Switch();
+
+    void set_deadline(unsigned int deadline_ms) { deadline_ms_ = deadline_ms; }
+    unsigned int get_deadline() const { return deadline_ms_; }
+
+    void set_coalescing(bool enabled, unsigned int window_ms = 0)
+    {
+        coalesce_activations_ = enabled;
+        coalescing_window_ms_ = enabled ? window_ms : 0;
+    }
+
+    bool is_coalescing() const { return coalesce_activations_; }
+    unsigned int get_coalescing_window() const { return coalescing_window_ms_; }
+
+    const SwitchStatistics &get_statistics() const { return statistics_; }
+
+    void reset_statistics()
+    {
+        statistics_.reset();
+        activate_results_.fill(0);
+    }
 
-    ActivateResult activate_source(const Paths &paths, const char *source_id,
-                                   const std::string *&player_id,
-                                   DeselectedAudioSourceResult &deselected_result,
-                                   bool select_source_now);
+    uint64_t get_activate_result_count(ActivateResult result) const
+    {
+        return activate_results_[size_t(result)];
+    }
 
-    ActivateResult activate_source(const Paths &paths, const char *source_id,
-                                   const std::string *&player_id,
-                                   DeselectedAudioSourceResult &deselected_result,
-                                   bool select_source_now,
-                                   GVariantWrapper &&request_data);
+    static const char *activate_result_name(ActivateResult result);
+
+    /*!
+     * Activate audio path for given audio source.
+     *
+     * The \p done function is called when the audio path has been switched,
+     * or when switching has failed. It may be called before this function
+     * returns in case no peers need to be contacted. The player ID pointer
+     * passed to \p done is only valid while \p done is running.
+     */
+    void activate_source(const Paths &paths, const char *source_id,
+                         bool select_source_now, ActivateDoneFn &&done);
+
+    void activate_source(const Paths &paths, const char *source_id,
+                         bool select_source_now, GVariantWrapper &&request_data,
+                         ActivateDoneFn &&done);
 
     /*!
      * Try to complete a deferred audio path activation.
@@ -165,13 +349,17 @@ class Switch
      * #AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED
      * the same way as #AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED
      * (same for #AudioPath::Switch::ActivateResult::OK_PLAYER_SAME).
+     *
+     * The ID of the audio source which was pending is passed to \p done.
      */
-    ActivateResult complete_pending_source_activation(const Paths &paths,
-                                                      std::string *source_id);
+    void complete_pending_source_activation(const Paths &paths,
+                                            PendingDoneFn &&done);
 
     /*!
      * Cancel deferred audio path activation, if any.
      *
+     * These results are passed to \p done:
+     *
      * \retval #AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED
      *         The pending source activation has been canceled.
      * \retval #AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED
@@ -179,21 +367,40 @@ class Switch
      *         source owner couldn't be notified about it.
      * \retval #AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN
      *         There was no pending activation.
+     * \retval #AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED
+     *         The audio source did not answer in time, or the operation
+     *         could not be started in time.
      */
-    ActivateResult cancel_pending_source_activation(const Paths &paths,
-                                                    std::string &source_id);
+    void cancel_pending_source_activation(const Paths &paths,
+                                          PendingDoneFn &&done);
 
-    ReleaseResult release_path(const Paths &paths, bool kill_player,
-                               const std::string *&player_id,
-                               DeselectedAudioSourceResult &deselected_result);
+    void release_path(const Paths &paths, bool kill_player,
+                      ReleaseDoneFn &&done);
 
-    ReleaseResult release_path(const Paths &paths, bool kill_player,
-                               const std::string *&player_id,
-                               DeselectedAudioSourceResult &deselected_result,
-                               GVariantWrapper &&request_data);
+    void release_path(const Paths &paths, bool kill_player,
+                      GVariantWrapper &&request_data, ReleaseDoneFn &&done);
 
-    const std::string &get_source_id() const { return current_source_id_; }
-    const std::string &get_player_id() const { return current_player_id_; }
+    /*!
+     * Whether or not there is an operation in progress or waiting to be
+     * started.
+     */
+    bool is_busy() const
+    {
+        return current_operation_ != nullptr || !queued_operations_.empty();
+    }
+
+    const ID &get_source_id() const { return current_source_id_; }
+    const ID &get_player_id() const { return current_player_id_; }
+    const PendingActivation &get_pending_activation() const { return pending_; }
+    Scheduler &get_scheduler() const { return scheduler_; }
+
+  private:
+    void schedule(std::shared_ptr<Operation> op);
+    void run_queued_operations();
+    void supersede_queued_activation();
+    void drop_expired_operation(Operation &op);
+    void update_deferred_statistics();
+    void coalescing_window_expired();
 };
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -24,14 +24,20 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <unordered_map>
+#include <cstring>
 
 #include <glib.h>
 
 #include "dbus_handlers.hh"
 #include "dbus_handlers.h"
 #include "dbus_iface_deep.h"
+#include "flightrecorder.hh"
+#include "trafficrecorder.hh"
+#include "loopmonitor.hh"
+#include "peerstatistics.hh"
 #include "gerrorwrapper.hh"
 #include "messages.h"
+#include "probes.hh"
 
 namespace DBus
 {
@@ -134,13 +140,81 @@ Proxy<tdbusaupathSource>::~Proxy()
 
 }
 
-static void enter_audiopath_manager_handler(GDBusMethodInvocation *invocation)
+static void record_traffic(const char *iface_name,
+                           GDBusMethodInvocation *invocation)
+{
+    auto &recorder(AudioPath::TrafficRecorder::get_singleton());
+
+    if(recorder.is_enabled())
+        recorder.record_method_call(
+            iface_name, g_dbus_method_invocation_get_method_name(invocation),
+            g_dbus_method_invocation_get_sender(invocation),
+            g_dbus_method_invocation_get_parameters(invocation));
+}
+
+/*!
+ * Method name suitable as key for the #AudioPath::LoopMonitor.
+ *
+ * The name is taken from the introspection data generated along with the
+ * D-Bus interfaces, so that the same pointer is passed for each invocation of
+ * a method.
+ */
+static const char *get_method_name(GDBusMethodInvocation *invocation)
+{
+    return g_dbus_method_invocation_get_method_info(invocation)->name;
+}
+
+static AudioPath::LoopMonitor::Scope
+enter_audiopath_manager_handler(GDBusMethodInvocation *invocation)
 {
     static const char iface_name[] = "de.tahifi.AudioPath.Manager";
 
     msg_vinfo(MESSAGE_LEVEL_TRACE, "%s method invocation from '%s': %s",
               iface_name, g_dbus_method_invocation_get_sender(invocation),
               g_dbus_method_invocation_get_method_name(invocation));
+
+    TAPSWITCH_PROBE(dbus__manager__enter,
+                    g_dbus_method_invocation_get_method_name(invocation),
+                    g_dbus_method_invocation_get_sender(invocation));
+
+    record_traffic(iface_name, invocation);
+
+    return AudioPath::LoopMonitor::get_singleton().enter(
+                get_method_name(invocation),
+                g_dbus_method_invocation_get_sender(invocation));
+}
+
+template <typename PType>
+static std::string get_peer_name(const std::unique_ptr<PType> &proxy)
+{
+    if(proxy == nullptr)
+        return "";
+
+    const gchar *name = g_dbus_proxy_get_name(G_DBUS_PROXY(proxy->get_as_nonconst()));
+    return name != nullptr ? name : "";
+}
+
+template <typename PType>
+static bool is_owned_by(const PType &proxy, const char *peer_name)
+{
+    const gchar *name = g_dbus_proxy_get_name(G_DBUS_PROXY(proxy.get_as_nonconst()));
+    return name != nullptr && strcmp(name, peer_name) == 0;
+}
+
+static void watch_peer(DBus::HandlerData &handler_data, std::string &&peer_name,
+                       bool is_player, const AudioPath::ID &id)
+{
+    if(peer_name.empty())
+        return;
+
+    const auto range(handler_data.components_by_peer_.equal_range(peer_name));
+
+    for(auto it = range.first; it != range.second; ++it)
+        if(it->second.is_player_ == is_player && it->second.id_ == id)
+            return;
+
+    handler_data.components_by_peer_.emplace(
+        std::move(peer_name), DBus::HandlerData::PeerComponent(is_player, id));
 }
 
 static void register_player_bottom_half(
@@ -149,10 +223,14 @@ static void register_player_bottom_half(
         std::string &&player_id, std::string &&player_name,
         DBus::HandlerData &handler_data)
 {
+    auto peer_name(get_peer_name(proxy));
     const auto add_result(
         handler_data.audio_paths_.add_player(
             AudioPath::Player(player_id.c_str(), player_name.c_str(),
-                              std::move(proxy))));
+                              std::move(proxy), peer_name.c_str())));
+
+    watch_peer(handler_data, std::move(peer_name), true,
+               AudioPath::IDTable::get_singleton().find(player_id));
 
     tdbus_aupath_manager_complete_register_player(object, invocation);
 
@@ -167,11 +245,12 @@ static void register_player_bottom_half(
 
       case AudioPath::Paths::AddResult::NEW_PATH:
       case AudioPath::Paths::AddResult::UPDATED_PATH:
-        handler_data.audio_paths_.for_each(
-            [object, player_id]
+        handler_data.audio_paths_.for_each_source_of_player(
+            AudioPath::IDTable::get_singleton().find(player_id),
+            [object, &player_id]
             (const AudioPath::Paths::Path &p)
             {
-                if(p.second->id_ == player_id)
+                if(p.first->is_alive())
                     tdbus_aupath_manager_emit_path_available(
                         object, p.first->id_.c_str(), player_id.c_str());
             });
@@ -187,7 +266,7 @@ gboolean dbusmethod_aupath_register_player(tdbusaupathManager *object,
                                            const gchar *path,
                                            gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     if(player_id[0] == '\0' || player_name[0] == '\0' || path[0] == '\0')
     {
@@ -227,10 +306,15 @@ static void register_source_bottom_half(
         std::string &&source_id, std::string &&source_name,
         std::string &&player_id, DBus::HandlerData &handler_data)
 {
+    auto peer_name(get_peer_name(proxy));
     const auto add_result(
         handler_data.audio_paths_.add_source(
             AudioPath::Source(source_id.c_str(), source_name.c_str(),
-                              player_id.c_str(), std::move(proxy))));
+                              player_id.c_str(), std::move(proxy),
+                              peer_name.c_str())));
+
+    watch_peer(handler_data, std::move(peer_name), false,
+               AudioPath::IDTable::get_singleton().find(source_id));
 
     tdbus_aupath_manager_complete_register_source(object, invocation);
 
@@ -256,7 +340,7 @@ gboolean dbusmethod_aupath_register_source(tdbusaupathManager *object,
                                            const gchar *path,
                                            gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     if(source_id[0] == '\0' || source_name[0] == '\0' || player_id[0] == '\0' ||
        path[0] == '\0')
@@ -295,7 +379,7 @@ gboolean dbusmethod_aupath_register_source(tdbusaupathManager *object,
 
 static void emit_path_switch_signal(tdbusaupathManager *object,
                                     const gchar *source_id,
-                                    const std::string *const player_id,
+                                    const AudioPath::ID *const player_id,
                                     GVariantWrapper &&request_data,
                                     bool success, bool is_deferred)
 {
@@ -328,7 +412,7 @@ static void emit_path_switch_signal(tdbusaupathManager *object,
 }
 
 static void complete_pending_call(
-        const DBus::HandlerData::Pending &pending, const std::string &player_id,
+        const DBus::HandlerData::Pending &pending, const AudioPath::ID &player_id,
         bool have_switched, GDBusError error_code, const char *error_message,
         std::unordered_map<tdbusaupathManager *, GVariantWrapper> *manager_objects,
         bool suppress_activated_signal)
@@ -359,11 +443,24 @@ static void complete_pending_call(
     g_object_unref(G_OBJECT(invocation));
 }
 
+static void record_pending_event(
+        AudioPath::FlightRecorder::EventType type,
+        const std::vector<DBus::HandlerData::Pending> &pending,
+        const AudioPath::ID &source_id, bool failed = false)
+{
+    if(!pending.empty())
+        AudioPath::FlightRecorder::get_singleton().record(
+            type, "RequestSource", source_id, pending.size(), failed);
+}
+
 static void fail_all_pending_calls(
         std::vector<DBus::HandlerData::Pending> &pending,
         const AudioPath::Switch &audio_path_switch,
         const char *error_message)
 {
+    record_pending_event(AudioPath::FlightRecorder::EventType::PENDING_CANCELLED,
+                         pending, AudioPath::ID());
+
     for(const auto &p : pending)
         complete_pending_call(p, audio_path_switch.get_player_id(),
                               false, G_DBUS_ERROR_FAILED, error_message,
@@ -382,33 +479,20 @@ static bool is_audio_path_enable_allowed(const Maybe<bool> &power_state,
     return !(power_state == false || audio_state == false);
 }
 
-gboolean dbusmethod_aupath_request_source(tdbusaupathManager *object,
-                                          GDBusMethodInvocation *invocation,
-                                          const gchar *source_id,
-                                          GVariant *arg_request_data,
-                                          gpointer user_data)
+static void request_source_bottom_half(
+        tdbusaupathManager *object, GDBusMethodInvocation *invocation,
+        DBus::HandlerData &data, const std::string &source_id,
+        bool select_source_now, GVariantWrapper &&request_data,
+        AudioPath::Switch::ActivateResult result,
+        const AudioPath::ID *player_id,
+        AudioPath::Switch::DeselectedAudioSourceResult deselected_result)
 {
-    enter_audiopath_manager_handler(invocation);
-
-    auto *data = static_cast<DBus::HandlerData *>(user_data);
-    bool select_source_now =
-        is_audio_path_enable_allowed(data->appliance_state_.is_up_and_running(),
-                                     data->appliance_state_.is_audio_path_ready());
-    GVariantWrapper request_data(arg_request_data);
-    const std::string *player_id;
-    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
     bool success = false;
     bool suppress_activated_signal = false;
     bool is_activation_deferred = false;
     bool emit_reactivation = false;
 
-    msg_vinfo(MESSAGE_LEVEL_DIAG, "Requested audio source \"%s\"", source_id);
-
-    switch(data->audio_path_switch_.activate_source(data->audio_paths_,
-                                                    source_id, player_id,
-                                                    deselected_result,
-                                                    select_source_now,
-                                                    GVariantWrapper(request_data)))
+    switch(result)
     {
       case AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN:
         g_dbus_method_invocation_return_error_literal(invocation,
@@ -436,6 +520,21 @@ gboolean dbusmethod_aupath_request_source(tdbusaupathManager *object,
                                                       "Player process failed");
         break;
 
+      case AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED:
+        g_dbus_method_invocation_return_error_literal(invocation,
+                                                      G_DBUS_ERROR, G_DBUS_ERROR_TIMEOUT,
+                                                      "Audio path switch took too long");
+        break;
+
+      case AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED:
+        /* the newer request will tell everybody about the outcome */
+        g_dbus_method_invocation_return_dbus_error(invocation,
+                                                   "de.tahifi.AudioPath.Error.Superseded",
+                                                   "Superseded by newer audio source request");
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Request for audio source %s superseded", source_id.c_str());
+        return;
+
       case AudioPath::Switch::ActivateResult::OK_UNCHANGED:
         tdbus_aupath_manager_complete_request_source(object, invocation,
                                                      player_id->c_str(), false);
@@ -472,7 +571,7 @@ gboolean dbusmethod_aupath_request_source(tdbusaupathManager *object,
 
       case AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_PENDING:
         fail_all_pending_calls(
-            data->pending_audio_source_activations_, data->audio_path_switch_,
+            data.pending_audio_source_activations_, data.audio_path_switch_,
             "Canceled pending audio source activation because "
             "a different source has been requested");
         break;
@@ -485,60 +584,91 @@ gboolean dbusmethod_aupath_request_source(tdbusaupathManager *object,
             if(emit_reactivation)
             {
                 msg_vinfo(MESSAGE_LEVEL_DIAG,
-                          "Reactivated audio source %s", source_id);
+                          "Reactivated audio source %s", source_id.c_str());
                 tdbus_aupath_manager_emit_path_reactivated(
-                    object, source_id, player_id->c_str(),
+                    object, source_id.c_str(), player_id->c_str(),
                     GVariantWrapper::get(request_data));
             }
             else
                 msg_vinfo(MESSAGE_LEVEL_DIAG,
                           "Activated audio source %s, %semitting signal",
-                          source_id, suppress_activated_signal ? "not " : "");
+                          source_id.c_str(), suppress_activated_signal ? "not " : "");
 
         }
         else
         {
             msg_vinfo(MESSAGE_LEVEL_DIAG,
                       "Activation of audio source %s deferred until appliance is ready",
-                      source_id);
+                      source_id.c_str());
 
             g_object_ref(G_OBJECT(object));
             g_object_ref(G_OBJECT(invocation));
-            data->pending_audio_source_activations_.emplace_back(
+            data.pending_audio_source_activations_.emplace_back(
                             object, invocation, GVariantWrapper(request_data));
+            record_pending_event(
+                AudioPath::FlightRecorder::EventType::PENDING_QUEUED,
+                data.pending_audio_source_activations_,
+                AudioPath::IDTable::get_singleton().find(source_id));
         }
     }
     else
         msg_error(0, LOG_ERR,
                   "Failed activating audio source %s, %semitting signal",
-                  source_id, suppress_activated_signal ? "not " : "");
+                  source_id.c_str(), suppress_activated_signal ? "not " : "");
 
     if(!suppress_activated_signal)
-        emit_path_switch_signal(object, source_id, player_id,
+        emit_path_switch_signal(object, source_id.c_str(), player_id,
                                 std::move(request_data),
                                 success, is_activation_deferred);
 
-    return TRUE;
 }
 
-gboolean dbusmethod_aupath_release_path(tdbusaupathManager *object,
-                                        GDBusMethodInvocation *invocation,
-                                        gboolean deactivate_player,
-                                        GVariant *arg_request_data,
-                                        gpointer user_data)
+gboolean dbusmethod_aupath_request_source(tdbusaupathManager *object,
+                                          GDBusMethodInvocation *invocation,
+                                          const gchar *source_id,
+                                          GVariant *arg_request_data,
+                                          gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
+    const bool select_source_now =
+        is_audio_path_enable_allowed(data->appliance_state_.is_up_and_running(),
+                                     data->appliance_state_.is_audio_path_ready());
     GVariantWrapper request_data(arg_request_data);
-    const std::string *player_id;
-    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Requested audio source \"%s\"", source_id);
+    AudioPath::FlightRecorder::get_singleton().record(
+        AudioPath::FlightRecorder::EventType::REQUEST_RECEIVED, "RequestSource",
+        AudioPath::IDTable::get_singleton().find(source_id));
+
+    data->audio_path_switch_.activate_source(
+        data->audio_paths_, source_id, select_source_now,
+        GVariantWrapper(request_data),
+        [object, invocation, data, id = std::string(source_id),
+         select_source_now, request_data]
+        (AudioPath::Switch::ActivateResult result,
+         const AudioPath::ID *player_id,
+         AudioPath::Switch::DeselectedAudioSourceResult deselected_result)
+        {
+            request_source_bottom_half(object, invocation, *data, id,
+                                       select_source_now,
+                                       GVariantWrapper(request_data),
+                                       result, player_id, deselected_result);
+        });
+
+    return TRUE;
+}
+
+static void release_path_bottom_half(
+        tdbusaupathManager *object, GDBusMethodInvocation *invocation,
+        DBus::HandlerData &data, GVariantWrapper &&request_data,
+        AudioPath::Switch::ReleaseResult result, const AudioPath::ID *player_id,
+        AudioPath::Switch::DeselectedAudioSourceResult deselected_result)
+{
     bool suppress_activated_signal = false;
 
-    switch(data->audio_path_switch_.release_path(data->audio_paths_,
-                                                 deactivate_player, player_id,
-                                                 deselected_result,
-                                                 GVariantWrapper(request_data)))
+    switch(result)
     {
       case AudioPath::Switch::ReleaseResult::SOURCE_DESELECTED:
       case AudioPath::Switch::ReleaseResult::PLAYER_DEACTIVATED:
@@ -558,7 +688,7 @@ gboolean dbusmethod_aupath_release_path(tdbusaupathManager *object,
 
       case AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_PENDING:
         fail_all_pending_calls(
-            data->pending_audio_source_activations_, data->audio_path_switch_,
+            data.pending_audio_source_activations_, data.audio_path_switch_,
             "Canceled pending audio source activation because "
             "the audio path been released");
         break;
@@ -572,6 +702,33 @@ gboolean dbusmethod_aupath_release_path(tdbusaupathManager *object,
                                                  ? player_id->c_str()
                                                  : "",
                                                  GVariantWrapper::get(request_data));
+}
+
+gboolean dbusmethod_aupath_release_path(tdbusaupathManager *object,
+                                        GDBusMethodInvocation *invocation,
+                                        gboolean deactivate_player,
+                                        GVariant *arg_request_data,
+                                        gpointer user_data)
+{
+    const auto scope(enter_audiopath_manager_handler(invocation));
+
+    auto *data = static_cast<DBus::HandlerData *>(user_data);
+    GVariantWrapper request_data(arg_request_data);
+
+    AudioPath::FlightRecorder::get_singleton().record(
+        AudioPath::FlightRecorder::EventType::REQUEST_RECEIVED, "ReleasePath");
+
+    data->audio_path_switch_.release_path(
+        data->audio_paths_, deactivate_player, GVariantWrapper(request_data),
+        [object, invocation, data, request_data]
+        (AudioPath::Switch::ReleaseResult result,
+         const AudioPath::ID *player_id,
+         AudioPath::Switch::DeselectedAudioSourceResult deselected_result)
+        {
+            release_path_bottom_half(object, invocation, *data,
+                                     GVariantWrapper(request_data),
+                                     result, player_id, deselected_result);
+        });
 
     return TRUE;
 }
@@ -581,12 +738,12 @@ gboolean dbusmethod_aupath_get_active_player(tdbusaupathManager *object,
                                              const gchar *source_id,
                                              gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
 
     if(source_id != nullptr && source_id[0] != '\0' &&
-       data->audio_path_switch_.get_source_id() != source_id)
+       data->audio_path_switch_.get_source_id().str() != source_id)
         tdbus_aupath_manager_complete_get_active_player(object, invocation, "");
     else
         tdbus_aupath_manager_complete_get_active_player(object, invocation,
@@ -595,11 +752,13 @@ gboolean dbusmethod_aupath_get_active_player(tdbusaupathManager *object,
     return TRUE;
 }
 
-gboolean dbusmethod_aupath_get_paths(tdbusaupathManager *object,
-                                     GDBusMethodInvocation *invocation,
-                                     gpointer user_data)
+static const DBus::HandlerData::PathsCache &
+get_paths_snapshot(DBus::HandlerData &data)
 {
-    enter_audiopath_manager_handler(invocation);
+    auto &cache(data.get_paths_cache_);
+
+    if(cache.generation_ == data.audio_paths_.get_generation())
+        return cache;
 
     GVariantBuilder usable;
     g_variant_builder_init(&usable, G_VARIANT_TYPE("a(ss)"));
@@ -607,24 +766,50 @@ gboolean dbusmethod_aupath_get_paths(tdbusaupathManager *object,
     GVariantBuilder incomplete;
     g_variant_builder_init(&incomplete, G_VARIANT_TYPE("a(ss)"));
 
-    auto *data = static_cast<DBus::HandlerData *>(user_data);
-
-    data->audio_paths_.for_each(
+    data.audio_paths_.for_each(
         [&usable, &incomplete]
         (const AudioPath::Paths::Path &p)
         {
+            /* paths of dead audio sources are gone, audio sources of dead
+             * players are reported as incomplete paths */
+            if(p.first != nullptr && !p.first->is_alive())
+                return;
+
+            const auto *player =
+                (p.second != nullptr && p.second->is_alive()) ? p.second : nullptr;
+
+            if(p.first == nullptr && player == nullptr)
+                return;
+
             GVariantBuilder *const vb =
-                (p.first != nullptr && p.second != nullptr) ? &usable : &incomplete;
+                (p.first != nullptr && player != nullptr) ? &usable : &incomplete;
 
             g_variant_builder_add(vb, "(ss)",
                                   p.first != nullptr ? p.first->id_.c_str() : "",
-                                  p.second != nullptr ? p.second->id_.c_str() : "");
+                                  player != nullptr ? player->id_.c_str() : "");
         },
         AudioPath::Paths::ForEach::ANY);
 
+    cache.usable_ = GVariantWrapper(g_variant_builder_end(&usable));
+    cache.incomplete_ = GVariantWrapper(g_variant_builder_end(&incomplete));
+    cache.generation_ = data.audio_paths_.get_generation();
+
+    return cache;
+}
+
+gboolean dbusmethod_aupath_get_paths(tdbusaupathManager *object,
+                                     GDBusMethodInvocation *invocation,
+                                     gpointer user_data)
+{
+    const auto scope(enter_audiopath_manager_handler(invocation));
+
+    auto *data = static_cast<DBus::HandlerData *>(user_data);
+    const auto &snapshot(get_paths_snapshot(*data));
+
+    /* the cached values are not floating, so they are only referenced */
     tdbus_aupath_manager_complete_get_paths(object, invocation,
-                                            g_variant_builder_end(&usable),
-                                            g_variant_builder_end(&incomplete));
+                                            GVariantWrapper::get(snapshot.usable_),
+                                            GVariantWrapper::get(snapshot.incomplete_));
 
     return TRUE;
 }
@@ -633,7 +818,7 @@ gboolean dbusmethod_aupath_get_current_path(tdbusaupathManager *object,
                                             GDBusMethodInvocation *invocation,
                                             gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     const auto *const data = static_cast<DBus::HandlerData *>(user_data);
     tdbus_aupath_manager_complete_get_current_path(
@@ -649,7 +834,7 @@ gboolean dbusmethod_aupath_get_player_info(tdbusaupathManager *object,
                                            const gchar *player_id,
                                            gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
     const auto *const p(data->audio_paths_.lookup_player(player_id));
@@ -676,7 +861,7 @@ gboolean dbusmethod_aupath_get_source_info(tdbusaupathManager *object,
                                            const gchar *source_id,
                                            gpointer user_data)
 {
-    enter_audiopath_manager_handler(invocation);
+    const auto scope(enter_audiopath_manager_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
     const auto *const s(data->audio_paths_.lookup_source(source_id));
@@ -699,16 +884,27 @@ gboolean dbusmethod_aupath_get_source_info(tdbusaupathManager *object,
     return TRUE;
 }
 
-static void enter_audiopath_appliance_handler(GDBusMethodInvocation *invocation)
+static AudioPath::LoopMonitor::Scope
+enter_audiopath_appliance_handler(GDBusMethodInvocation *invocation)
 {
     static const char iface_name[] = "de.tahifi.AudioPath.Appliance";
 
     msg_vinfo(MESSAGE_LEVEL_TRACE, "%s method invocation from '%s': %s",
               iface_name, g_dbus_method_invocation_get_sender(invocation),
               g_dbus_method_invocation_get_method_name(invocation));
+
+    TAPSWITCH_PROBE(dbus__appliance__enter,
+                    g_dbus_method_invocation_get_method_name(invocation),
+                    g_dbus_method_invocation_get_sender(invocation));
+
+    record_traffic(iface_name, invocation);
+
+    return AudioPath::LoopMonitor::get_singleton().enter(
+                get_method_name(invocation),
+                g_dbus_method_invocation_get_sender(invocation));
 }
 
-static void log_deferred_activation(const std::string &source_id,
+static void log_deferred_activation(const AudioPath::ID &source_id,
                                     bool success, bool suppress_activated_signal)
 {
     if(!source_id.empty())
@@ -725,7 +921,7 @@ static void log_deferred_activation(const std::string &source_id,
 }
 
 static void emit_path_activated(tdbusaupathManager *manager_object,
-                                const std::string &source_id,
+                                const AudioPath::ID &source_id,
                                 const AudioPath::Switch &audio_path_switch,
                                 GVariantWrapper &&request_data,
                                 bool success)
@@ -747,7 +943,7 @@ static void emit_path_activated(tdbusaupathManager *manager_object,
 
 static void complete_all_pending_calls(
         std::vector<DBus::HandlerData::Pending> &pending,
-        const std::string &source_id,
+        const AudioPath::ID &source_id,
         const AudioPath::Switch &audio_path_switch,
         bool success, bool suppress_activated_signal, bool have_switched,
         GDBusError error_code = G_DBUS_ERROR_FAILED,
@@ -773,14 +969,37 @@ static void complete_all_pending_calls(
                             std::move(m.second), success);
 }
 
-static void process_pending_audio_source_activation(tdbusaupathAppliance *object,
-                                                    GDBusMethodInvocation *invocation,
-                                                    DBus::HandlerData &data)
+static bool is_activation_failure(AudioPath::Switch::ActivateResult result)
 {
-    std::string source_id;
-    const auto result =
-        data.audio_path_switch_.complete_pending_source_activation(data.audio_paths_,
-                                                                   &source_id);
+    switch(result)
+    {
+      case AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN:
+      case AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED:
+      case AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN:
+      case AudioPath::Switch::ActivateResult::ERROR_PLAYER_FAILED:
+      case AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED:
+      case AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED:
+        return true;
+
+      case AudioPath::Switch::ActivateResult::OK_UNCHANGED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED:
+        break;
+    }
+
+    return false;
+}
+
+static void process_pending_audio_source_activation_bottom_half(
+        tdbusaupathAppliance *object, GDBusMethodInvocation *invocation,
+        DBus::HandlerData &data, AudioPath::Switch::ActivateResult result,
+        const AudioPath::ID &source_id)
+{
+    record_pending_event(AudioPath::FlightRecorder::EventType::PENDING_COMPLETED,
+                         data.pending_audio_source_activations_, source_id,
+                         is_activation_failure(result));
 
     switch(result)
     {
@@ -799,6 +1018,8 @@ static void process_pending_audio_source_activation(tdbusaupathAppliance *object
 
       case AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN:
       case AudioPath::Switch::ActivateResult::ERROR_PLAYER_FAILED:
+      case AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED:
+      case AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED:
         complete_all_pending_calls(
             data.pending_audio_source_activations_, source_id,
             data.audio_path_switch_, false, false, false,
@@ -841,12 +1062,26 @@ static void process_pending_audio_source_activation(tdbusaupathAppliance *object
     }
 }
 
-static void cancel_pending_audio_source_activation(DBus::HandlerData &data)
+static void process_pending_audio_source_activation(tdbusaupathAppliance *object,
+                                                    GDBusMethodInvocation *invocation,
+                                                    DBus::HandlerData &data)
+{
+    data.audio_path_switch_.complete_pending_source_activation(
+        data.audio_paths_,
+        [object, invocation, &data]
+        (AudioPath::Switch::ActivateResult result, const AudioPath::ID &source_id)
+        {
+            process_pending_audio_source_activation_bottom_half(
+                object, invocation, data, result, source_id);
+        });
+}
+
+static void cancel_pending_audio_source_activation_bottom_half(
+        DBus::HandlerData &data, AudioPath::Switch::ActivateResult result,
+        const AudioPath::ID &source_id)
 {
-    std::string source_id;
-    const auto result =
-        data.audio_path_switch_.cancel_pending_source_activation(data.audio_paths_,
-                                                                 source_id);
+    record_pending_event(AudioPath::FlightRecorder::EventType::PENDING_CANCELLED,
+                         data.pending_audio_source_activations_, source_id);
 
     switch(result)
     {
@@ -855,6 +1090,7 @@ static void cancel_pending_audio_source_activation(DBus::HandlerData &data)
         break;
 
       case AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED:
+      case AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED:
       case AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED:
         complete_all_pending_calls(
             data.pending_audio_source_activations_, source_id,
@@ -865,6 +1101,7 @@ static void cancel_pending_audio_source_activation(DBus::HandlerData &data)
 
       case AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN:
       case AudioPath::Switch::ActivateResult::ERROR_PLAYER_FAILED:
+      case AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED:
       case AudioPath::Switch::ActivateResult::OK_UNCHANGED:
       case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME:
       case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED:
@@ -874,17 +1111,33 @@ static void cancel_pending_audio_source_activation(DBus::HandlerData &data)
     }
 }
 
+static void cancel_pending_audio_source_activation(DBus::HandlerData &data)
+{
+    data.audio_path_switch_.cancel_pending_source_activation(
+        data.audio_paths_,
+        [&data]
+        (AudioPath::Switch::ActivateResult result, const AudioPath::ID &source_id)
+        {
+            cancel_pending_audio_source_activation_bottom_half(data, result,
+                                                               source_id);
+        });
+}
+
 gboolean dbusmethod_appliance_set_ready_state(tdbusaupathAppliance *object,
                                               GDBusMethodInvocation *invocation,
                                               const guchar audio_state,
                                               const guchar power_state,
                                               gpointer user_data)
 {
-    enter_audiopath_appliance_handler(invocation);
+    const auto scope(enter_audiopath_appliance_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
     bool suspended;
 
+    AudioPath::FlightRecorder::get_singleton().record(
+        AudioPath::FlightRecorder::EventType::APPLIANCE_STATE, "SetReadyState",
+        AudioPath::ID(), audio_state | (power_state << 8));
+
     switch(power_state)
     {
       case 1:
@@ -943,7 +1196,7 @@ gboolean dbusmethod_appliance_get_state(tdbusaupathAppliance *object,
                                         GDBusMethodInvocation *invocation,
                                         gpointer user_data)
 {
-    enter_audiopath_appliance_handler(invocation);
+    const auto scope(enter_audiopath_appliance_handler(invocation));
 
     auto *data = static_cast<DBus::HandlerData *>(user_data);
     const auto &state(data->appliance_state_.is_audio_path_ready());
@@ -961,3 +1214,373 @@ gboolean dbusmethod_appliance_get_state(tdbusaupathAppliance *object,
 
     return TRUE;
 }
+
+static AudioPath::LoopMonitor::Scope
+enter_audiopath_registry_handler(GDBusMethodInvocation *invocation)
+{
+    static const char iface_name[] = "de.tahifi.AudioPath.Registry";
+
+    msg_vinfo(MESSAGE_LEVEL_TRACE, "%s method invocation from '%s': %s",
+              iface_name, g_dbus_method_invocation_get_sender(invocation),
+              g_dbus_method_invocation_get_method_name(invocation));
+
+    TAPSWITCH_PROBE(dbus__registry__enter,
+                    g_dbus_method_invocation_get_method_name(invocation),
+                    g_dbus_method_invocation_get_sender(invocation));
+
+    return AudioPath::LoopMonitor::get_singleton().enter(
+                get_method_name(invocation),
+                g_dbus_method_invocation_get_sender(invocation));
+}
+
+gboolean dbusmethod_registry_get_paths_since(tdbusaupathRegistry *object,
+                                             GDBusMethodInvocation *invocation,
+                                             guint64 generation,
+                                             gpointer user_data)
+{
+    const auto scope(enter_audiopath_registry_handler(invocation));
+
+    auto *data = static_cast<DBus::HandlerData *>(user_data);
+    const auto &paths(data->audio_paths_);
+
+    if(!paths.can_report_changes_since(generation))
+    {
+        msg_vinfo(MESSAGE_LEVEL_DIAG,
+                  "Changes since generation %" G_GUINT64_FORMAT
+                  " not available, sending full snapshot", generation);
+
+        const auto &snapshot(get_paths_snapshot(*data));
+
+        tdbus_aupath_registry_complete_get_paths_since(
+            object, invocation, paths.get_generation(), TRUE,
+            GVariantWrapper::get(snapshot.usable_),
+            GVariantWrapper::get(snapshot.incomplete_),
+            g_variant_new("a(ss)", nullptr));
+
+        return TRUE;
+    }
+
+    GVariantBuilder usable;
+    g_variant_builder_init(&usable, G_VARIANT_TYPE("a(ss)"));
+
+    GVariantBuilder incomplete;
+    g_variant_builder_init(&incomplete, G_VARIANT_TYPE("a(ss)"));
+
+    GVariantBuilder removed;
+    g_variant_builder_init(&removed, G_VARIANT_TYPE("a(ss)"));
+
+    paths.for_each_change_since(
+        generation,
+        [&usable, &incomplete, &removed]
+        (const AudioPath::ID &source_id, const AudioPath::ID &player_id,
+         bool is_removed)
+        {
+            GVariantBuilder *const vb =
+                is_removed
+                ? &removed
+                : ((!source_id.empty() && !player_id.empty()) ? &usable : &incomplete);
+
+            g_variant_builder_add(vb, "(ss)", source_id.c_str(), player_id.c_str());
+        });
+
+    tdbus_aupath_registry_complete_get_paths_since(
+        object, invocation, paths.get_generation(), FALSE,
+        g_variant_builder_end(&usable), g_variant_builder_end(&incomplete),
+        g_variant_builder_end(&removed));
+
+    return TRUE;
+}
+
+static AudioPath::LoopMonitor::Scope
+enter_audiopath_statistics_handler(GDBusMethodInvocation *invocation)
+{
+    static const char iface_name[] = "de.tahifi.AudioPath.Statistics";
+
+    msg_vinfo(MESSAGE_LEVEL_TRACE, "%s method invocation from '%s': %s",
+              iface_name, g_dbus_method_invocation_get_sender(invocation),
+              g_dbus_method_invocation_get_method_name(invocation));
+
+    TAPSWITCH_PROBE(dbus__statistics__enter,
+                    g_dbus_method_invocation_get_method_name(invocation),
+                    g_dbus_method_invocation_get_sender(invocation));
+
+    return AudioPath::LoopMonitor::get_singleton().enter(
+                get_method_name(invocation),
+                g_dbus_method_invocation_get_sender(invocation));
+}
+
+static GVariant *mk_histogram_buckets(const AudioPath::LatencyHistogram &h)
+{
+    GVariantBuilder buckets;
+    g_variant_builder_init(&buckets, G_VARIANT_TYPE("at"));
+
+    for(const auto &count : h.get_buckets())
+        g_variant_builder_add(&buckets, "t", guint64(count));
+
+    return g_variant_builder_end(&buckets);
+}
+
+static GVariant *mk_histogram_bounds()
+{
+    GVariantBuilder bounds;
+    g_variant_builder_init(&bounds, G_VARIANT_TYPE("at"));
+
+    for(const auto &b : AudioPath::LatencyHistogram::BOUNDS_US)
+        g_variant_builder_add(&bounds, "t", guint64(b));
+
+    return g_variant_builder_end(&bounds);
+}
+
+gboolean dbusmethod_statistics_get_switch_latencies(tdbusaupathStatistics *object,
+                                                    GDBusMethodInvocation *invocation,
+                                                    gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    const auto *data = static_cast<const DBus::HandlerData *>(user_data);
+    const auto &stats(data->audio_path_switch_.get_statistics());
+
+    GVariantBuilder phases;
+    g_variant_builder_init(&phases, G_VARIANT_TYPE("a(stttttt@at)"));
+
+    for(size_t i = 0; i < AudioPath::SwitchStatistics::NUMBER_OF_PHASES; ++i)
+    {
+        const auto phase = AudioPath::SwitchStatistics::Phase(i);
+        const auto &h(stats.get(phase));
+
+        g_variant_builder_add(&phases, "(stttttt@at)",
+                              AudioPath::SwitchStatistics::phase_name(phase),
+                              guint64(h.get_count()), guint64(h.get_sum()),
+                              guint64(h.get_max()),
+                              guint64(h.get_percentile(50)),
+                              guint64(h.get_percentile(95)),
+                              guint64(h.get_percentile(99)),
+                              mk_histogram_buckets(h));
+    }
+
+    tdbus_aupath_statistics_complete_get_switch_latencies(
+        object, invocation,
+        mk_histogram_bounds(), g_variant_builder_end(&phases));
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_reset_switch_latencies(tdbusaupathStatistics *object,
+                                                      GDBusMethodInvocation *invocation,
+                                                      gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    auto *data = static_cast<DBus::HandlerData *>(user_data);
+    data->audio_path_switch_.reset_statistics();
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Switch latency statistics reset");
+
+    tdbus_aupath_statistics_complete_reset_switch_latencies(object, invocation);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_get_loop_statistics(tdbusaupathStatistics *object,
+                                                   GDBusMethodInvocation *invocation,
+                                                   gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    const auto &monitor(AudioPath::LoopMonitor::get_singleton());
+    const auto &latency(monitor.get_loop_latency());
+
+    GVariantBuilder handlers;
+    g_variant_builder_init(&handlers, G_VARIANT_TYPE("a(sttttttt)"));
+
+    for(const auto &it : monitor.get_handlers())
+    {
+        const auto &h(it.second.durations_);
+
+        g_variant_builder_add(&handlers, "(sttttttt)", it.first,
+                              guint64(h.get_count()), guint64(it.second.slow_),
+                              guint64(h.get_sum()), guint64(h.get_max()),
+                              guint64(h.get_percentile(50)),
+                              guint64(h.get_percentile(95)),
+                              guint64(h.get_percentile(99)));
+    }
+
+    tdbus_aupath_statistics_complete_get_loop_statistics(
+        object, invocation, mk_histogram_bounds(),
+        guint64(monitor.get_stall_threshold_us()), guint64(monitor.get_stalls()),
+        g_variant_new("(tttttt@at)",
+                      guint64(latency.get_count()), guint64(latency.get_sum()),
+                      guint64(latency.get_max()),
+                      guint64(latency.get_percentile(50)),
+                      guint64(latency.get_percentile(95)),
+                      guint64(latency.get_percentile(99)),
+                      mk_histogram_buckets(latency)),
+        g_variant_builder_end(&handlers));
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_reset_loop_statistics(tdbusaupathStatistics *object,
+                                                     GDBusMethodInvocation *invocation,
+                                                     gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    AudioPath::LoopMonitor::get_singleton().reset();
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Main loop statistics reset");
+
+    tdbus_aupath_statistics_complete_reset_loop_statistics(object, invocation);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_get_peer_statistics(tdbusaupathStatistics *object,
+                                                   GDBusMethodInvocation *invocation,
+                                                   gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    using PeerStatistics = AudioPath::PeerStatistics;
+
+    GVariantBuilder peers;
+    g_variant_builder_init(&peers, G_VARIANT_TYPE("a(sssttttttttt@at)"));
+
+    for(const auto &it : PeerStatistics::get_singleton().get_peers())
+    {
+        for(size_t i = 0; i < PeerStatistics::NUMBER_OF_METHODS; ++i)
+        {
+            const auto &m(it.second.methods_[i]);
+            const auto &h(m.durations_);
+
+            if(h.get_count() == 0)
+                continue;
+
+            g_variant_builder_add(&peers, "(sssttttttttt@at)",
+                                  it.first.c_str(), it.second.bus_name_.c_str(),
+                                  PeerStatistics::method_name(PeerStatistics::Method(i)),
+                                  guint64(h.get_count()), guint64(m.failures_),
+                                  guint64(m.above_p99_), guint64(m.ewma_us_),
+                                  guint64(h.get_sum()), guint64(h.get_max()),
+                                  guint64(h.get_percentile(50)),
+                                  guint64(h.get_percentile(95)),
+                                  guint64(h.get_percentile(99)),
+                                  mk_histogram_buckets(h));
+        }
+    }
+
+    tdbus_aupath_statistics_complete_get_peer_statistics(
+        object, invocation, mk_histogram_bounds(), g_variant_builder_end(&peers));
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_reset_peer_statistics(tdbusaupathStatistics *object,
+                                                     GDBusMethodInvocation *invocation,
+                                                     gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    AudioPath::PeerStatistics::get_singleton().reset();
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Peer statistics reset");
+
+    tdbus_aupath_statistics_complete_reset_peer_statistics(object, invocation);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_statistics_get_flight_record(tdbusaupathStatistics *object,
+                                                GDBusMethodInvocation *invocation,
+                                                gpointer user_data)
+{
+    const auto scope(enter_audiopath_statistics_handler(invocation));
+
+    const std::string trace(AudioPath::FlightRecorder::get_singleton().to_chrome_trace());
+    tdbus_aupath_statistics_complete_get_flight_record(object, invocation,
+                                                       trace.c_str());
+
+    return TRUE;
+}
+
+static void player_vanished(tdbusaupathRegistry *object, AudioPath::Paths &paths,
+                            const AudioPath::ID &player_id, const char *peer_name)
+{
+    const auto *player(paths.lookup_player(player_id));
+
+    if(player == nullptr || !is_owned_by(player->get_dbus_proxy(), peer_name) ||
+       !paths.mark_player_dead(player_id))
+        return;
+
+    msg_info("Player %s (\"%s\") is gone", player->id_.c_str(),
+             player->name_.c_str());
+
+    paths.for_each_source_of_player(
+        player_id,
+        [object] (const AudioPath::Paths::Path &p)
+        {
+            if(p.first->is_alive())
+                tdbus_aupath_registry_emit_path_unavailable(
+                    object, p.first->id_.c_str(), p.second->id_.c_str());
+        });
+}
+
+static void source_vanished(tdbusaupathRegistry *object, AudioPath::Paths &paths,
+                            const AudioPath::ID &source_id, const char *peer_name)
+{
+    const auto path(paths.lookup_path(source_id));
+
+    if(path.first == nullptr || !is_owned_by(path.first->get_dbus_proxy(), peer_name) ||
+       !paths.mark_source_dead(source_id))
+        return;
+
+    msg_info("Audio source %s (\"%s\") is gone", path.first->id_.c_str(),
+             path.first->name_.c_str());
+
+    if(path.second != nullptr && path.second->is_alive())
+        tdbus_aupath_registry_emit_path_unavailable(
+            object, path.first->id_.c_str(), path.second->id_.c_str());
+}
+
+void dbussignal_dbus_name_owner_changed(GDBusConnection *connection,
+                                        const gchar *sender_name,
+                                        const gchar *object_path,
+                                        const gchar *interface_name,
+                                        const gchar *signal_name,
+                                        GVariant *parameters,
+                                        gpointer user_data)
+{
+    const gchar *name;
+    const gchar *old_owner;
+    const gchar *new_owner;
+
+    g_variant_get(parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
+
+    if(new_owner[0] != '\0')
+        return;
+
+    auto *data = static_cast<DBus::HandlerData *>(user_data);
+    const auto range(data->components_by_peer_.equal_range(name));
+
+    if(range.first == range.second)
+        return;
+
+    /* the signal name passed to us is not suitable as key */
+    const auto scope(AudioPath::LoopMonitor::get_singleton().enter(
+                        "NameOwnerChanged", name));
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Peer %s has vanished from the bus", name);
+    AudioPath::TrafficRecorder::get_singleton().record_peer_vanished(name);
+
+    tdbusaupathRegistry *object = dbus_get_audiopath_registry_iface();
+
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second.is_player_)
+            player_vanished(object, data->audio_paths_, it->second.id_, name);
+        else
+            source_vanished(object, data->audio_paths_, it->second.id_, name);
+    }
+
+    data->components_by_peer_.erase(range.first, range.second);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -85,6 +85,39 @@ gboolean dbusmethod_appliance_set_ready_state(tdbusaupathAppliance *object,
 gboolean dbusmethod_appliance_get_state(tdbusaupathAppliance *object,
                                         GDBusMethodInvocation *invocation,
                                         gpointer user_data);
+gboolean dbusmethod_registry_get_paths_since(tdbusaupathRegistry *object,
+                                             GDBusMethodInvocation *invocation,
+                                             guint64 generation,
+                                             gpointer user_data);
+gboolean dbusmethod_statistics_get_switch_latencies(tdbusaupathStatistics *object,
+                                                    GDBusMethodInvocation *invocation,
+                                                    gpointer user_data);
+gboolean dbusmethod_statistics_reset_switch_latencies(tdbusaupathStatistics *object,
+                                                      GDBusMethodInvocation *invocation,
+                                                      gpointer user_data);
+gboolean dbusmethod_statistics_get_loop_statistics(tdbusaupathStatistics *object,
+                                                   GDBusMethodInvocation *invocation,
+                                                   gpointer user_data);
+gboolean dbusmethod_statistics_reset_loop_statistics(tdbusaupathStatistics *object,
+                                                     GDBusMethodInvocation *invocation,
+                                                     gpointer user_data);
+gboolean dbusmethod_statistics_get_peer_statistics(tdbusaupathStatistics *object,
+                                                   GDBusMethodInvocation *invocation,
+                                                   gpointer user_data);
+gboolean dbusmethod_statistics_reset_peer_statistics(tdbusaupathStatistics *object,
+                                                     GDBusMethodInvocation *invocation,
+                                                     gpointer user_data);
+gboolean dbusmethod_statistics_get_flight_record(tdbusaupathStatistics *object,
+                                                GDBusMethodInvocation *invocation,
+                                                gpointer user_data);
+
+void dbussignal_dbus_name_owner_changed(GDBusConnection *connection,
+                                        const gchar *sender_name,
+                                        const gchar *object_path,
+                                        const gchar *interface_name,
+                                        const gchar *signal_name,
+                                        GVariant *parameters,
+                                        gpointer user_data);
 
 #ifdef __cplusplus
 }
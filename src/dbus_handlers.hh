@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -29,6 +29,7 @@
 /*!@{*/
 
 #include <vector>
+#include <unordered_map>
 
 #include "audiopath.hh"
 #include "audiopathswitch.hh"
@@ -62,6 +63,45 @@ class HandlerData
 
     std::vector<Pending> pending_audio_source_activations_;
 
+    /*!
+     * Answer to the most recent GetPaths request.
+     *
+     * The answer is reused as long as the registry generation matches
+     * #DBus::HandlerData::PathsCache::generation_.
+     */
+    struct PathsCache
+    {
+        uint64_t generation_;
+        GVariantWrapper usable_;
+        GVariantWrapper incomplete_;
+
+        explicit PathsCache(): generation_(0) {}
+    };
+
+    PathsCache get_paths_cache_;
+
+    /*!
+     * Registered player or audio source owned by some process on the bus.
+     */
+    struct PeerComponent
+    {
+        bool is_player_;
+        AudioPath::ID id_;
+
+        explicit PeerComponent(bool is_player, const AudioPath::ID &id):
+            is_player_(is_player),
+            id_(id)
+        {}
+    };
+
+    /*!
+     * Registered components by unique bus name of their owning process.
+     *
+     * Components are marked dead in #DBus::HandlerData::audio_paths_ when
+     * their owner vanishes from the bus.
+     */
+    std::unordered_multimap<std::string, PeerComponent> components_by_peer_;
+
     HandlerData(const HandlerData &) = delete;
     HandlerData &operator=(const HandlerData &) = delete;
     HandlerData(HandlerData &&) = default;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2021, 2023  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2021, 2023, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -43,6 +43,8 @@ class DBusData
 
     tdbusaupathManager *audiopath_manager_iface;
     tdbusaupathAppliance *audiopath_appliance_iface;
+    tdbusaupathRegistry *audiopath_registry_iface;
+    tdbusaupathStatistics *audiopath_statistics_iface;
 
     tdbusdebugLogging *debug_logging_iface;
     tdbusdebugLoggingConfig *debug_logging_config_proxy;
@@ -66,6 +68,8 @@ static void bus_acquired(GDBusConnection *connection,
 
     data.audiopath_manager_iface = tdbus_aupath_manager_skeleton_new();
     data.audiopath_appliance_iface = tdbus_aupath_appliance_skeleton_new();
+    data.audiopath_registry_iface = tdbus_aupath_registry_skeleton_new();
+    data.audiopath_statistics_iface = tdbus_aupath_statistics_skeleton_new();
     data.debug_logging_iface = tdbus_debug_logging_skeleton_new();
 
     g_signal_connect(data.audiopath_manager_iface, "handle-register-player",
@@ -103,12 +107,56 @@ static void bus_acquired(GDBusConnection *connection,
                      G_CALLBACK(dbusmethod_appliance_get_state),
                      data.handler_data);
 
+    g_signal_connect(data.audiopath_registry_iface,
+                     "handle-get-paths-since",
+                     G_CALLBACK(dbusmethod_registry_get_paths_since),
+                     data.handler_data);
+
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-get-switch-latencies",
+                     G_CALLBACK(dbusmethod_statistics_get_switch_latencies),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-reset-switch-latencies",
+                     G_CALLBACK(dbusmethod_statistics_reset_switch_latencies),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-get-flight-record",
+                     G_CALLBACK(dbusmethod_statistics_get_flight_record),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-get-loop-statistics",
+                     G_CALLBACK(dbusmethod_statistics_get_loop_statistics),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-reset-loop-statistics",
+                     G_CALLBACK(dbusmethod_statistics_reset_loop_statistics),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-get-peer-statistics",
+                     G_CALLBACK(dbusmethod_statistics_get_peer_statistics),
+                     data.handler_data);
+    g_signal_connect(data.audiopath_statistics_iface,
+                     "handle-reset-peer-statistics",
+                     G_CALLBACK(dbusmethod_statistics_reset_peer_statistics),
+                     data.handler_data);
+
     g_signal_connect(data.debug_logging_iface,
                      "handle-debug-level",
                      G_CALLBACK(msg_dbus_handle_debug_level), nullptr);
 
+    g_dbus_connection_signal_subscribe(connection, "org.freedesktop.DBus",
+                                       "org.freedesktop.DBus",
+                                       "NameOwnerChanged",
+                                       "/org/freedesktop/DBus", nullptr,
+                                       G_DBUS_SIGNAL_FLAGS_NONE,
+                                       dbussignal_dbus_name_owner_changed,
+                                       data.handler_data, nullptr);
+
     try_export_iface(connection, G_DBUS_INTERFACE_SKELETON(data.audiopath_manager_iface));
     try_export_iface(connection, G_DBUS_INTERFACE_SKELETON(data.audiopath_appliance_iface));
+    try_export_iface(connection, G_DBUS_INTERFACE_SKELETON(data.audiopath_registry_iface));
+    try_export_iface(connection, G_DBUS_INTERFACE_SKELETON(data.audiopath_statistics_iface));
     try_export_iface(connection, G_DBUS_INTERFACE_SKELETON(data.debug_logging_iface));
 }
 
@@ -187,6 +235,8 @@ int dbus_setup(GMainLoop *loop, bool connect_to_session_bus,
 
     msg_log_assert(dbus_data.audiopath_manager_iface != nullptr);
     msg_log_assert(dbus_data.audiopath_appliance_iface != nullptr);
+    msg_log_assert(dbus_data.audiopath_registry_iface != nullptr);
+    msg_log_assert(dbus_data.audiopath_statistics_iface != nullptr);
     msg_log_assert(dbus_data.debug_logging_iface != nullptr);
     msg_log_assert(dbus_data.debug_logging_config_proxy != nullptr);
 
@@ -208,6 +258,8 @@ void dbus_shutdown(GMainLoop *loop)
 
     g_object_unref(dbus_data.audiopath_manager_iface);
     g_object_unref(dbus_data.audiopath_appliance_iface);
+    g_object_unref(dbus_data.audiopath_registry_iface);
+    g_object_unref(dbus_data.audiopath_statistics_iface);
     g_object_unref(dbus_data.debug_logging_iface);
     g_object_unref(dbus_data.debug_logging_config_proxy);
 
@@ -218,3 +270,8 @@ tdbusaupathManager *dbus_get_audiopath_manager_iface(void)
 {
     return dbus_data.audiopath_manager_iface;
 }
+
+tdbusaupathRegistry *dbus_get_audiopath_registry_iface(void)
+{
+    return dbus_data.audiopath_registry_iface;
+}
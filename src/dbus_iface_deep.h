@@ -34,6 +34,7 @@ extern "C" {
 #endif
 
 tdbusaupathManager *dbus_get_audiopath_manager_iface(void);
+tdbusaupathRegistry *dbus_get_audiopath_registry_iface(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <cstdlib>
+
+#include "faultinjector.hh"
+#include "messages.h"
+
+AudioPath::FaultInjector &AudioPath::FaultInjector::get_singleton()
+{
+    static FaultInjector injector;
+    return injector;
+}
+
+static bool parse_fault(const std::string &str,
+                        AudioPath::FaultInjector::Fault &fault,
+                        unsigned int &default_delay_ms)
+{
+    using Fault = AudioPath::FaultInjector::Fault;
+
+    static const struct
+    {
+        const char *name;
+        Fault fault;
+        unsigned int default_delay_ms;
+    }
+    faults[] =
+    {
+        { "delay",   Fault::DELAY,   0 },
+        { "error",   Fault::ERROR,   0 },
+        { "timeout", Fault::TIMEOUT, 25000 },
+        { "vanish",  Fault::VANISH,  0 },
+    };
+
+    for(const auto &f : faults)
+    {
+        if(str == f.name)
+        {
+            fault = f.fault;
+            default_delay_ms = f.default_delay_ms;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parse_number(const std::string &str, unsigned int &value)
+{
+    if(str.empty())
+        return false;
+
+    char *endptr;
+    const unsigned long v = strtoul(str.c_str(), &endptr, 10);
+
+    if(*endptr != '\0' || v > UINT32_MAX)
+        return false;
+
+    value = v;
+    return true;
+}
+
+static bool is_known_method(const std::string &method)
+{
+    static const char *const methods[] =
+    {
+        "Activate", "Deactivate", "Selected", "SelectedOnHold", "Deselected",
+    };
+
+    for(const char *m : methods)
+        if(method == m)
+            return true;
+
+    return false;
+}
+
+bool AudioPath::FaultInjector::add_rule(const char *spec)
+{
+    std::string rule(spec);
+    Rule r{"", "", Fault::ERROR, 0, 1000, 0};
+
+    const auto at = rule.find('@');
+
+    if(at != std::string::npos)
+    {
+        if(!parse_number(rule.substr(at + 1), r.permille_) || r.permille_ > 1000)
+        {
+            msg_error(EINVAL, LOG_ERR, "Invalid probability in fault rule \"%s\"", spec);
+            return false;
+        }
+
+        rule.erase(at);
+    }
+
+    std::vector<std::string> fields;
+    size_t start = 0;
+
+    while(true)
+    {
+        const auto colon = rule.find(':', start);
+        fields.push_back(rule.substr(start, colon - start));
+
+        if(colon == std::string::npos)
+            break;
+
+        start = colon + 1;
+    }
+
+    if(fields.size() < 3 || fields.size() > 4 || fields[0].empty() ||
+       !parse_fault(fields[2], r.fault_, r.delay_ms_) ||
+       (fields.size() == 4 && !parse_number(fields[3], r.delay_ms_)) ||
+       (r.fault_ == Fault::DELAY && fields.size() != 4))
+    {
+        msg_error(EINVAL, LOG_ERR, "Invalid fault rule \"%s\"", spec);
+        return false;
+    }
+
+    if(fields[1] != "*" && !is_known_method(fields[1]))
+    {
+        msg_error(EINVAL, LOG_ERR,
+                  "Unknown method \"%s\" in fault rule \"%s\"",
+                  fields[1].c_str(), spec);
+        return false;
+    }
+
+    if(fields[0] != "*")
+        r.peer_id_ = std::move(fields[0]);
+
+    if(fields[1] != "*")
+        r.method_ = std::move(fields[1]);
+
+    msg_vinfo(MESSAGE_LEVEL_IMPORTANT,
+              "Injecting %s (%u ms) into %s calls to %s with probability %u/1000",
+              fault_to_string(r.fault_), r.delay_ms_,
+              r.method_.empty() ? "all" : r.method_.c_str(),
+              r.peer_id_.empty() ? "any peer" : r.peer_id_.c_str(),
+              r.permille_);
+
+    rules_.emplace_back(std::move(r));
+
+    return true;
+}
+
+const AudioPath::FaultInjector::Rule *
+AudioPath::FaultInjector::match(const char *method, const ID &peer_id)
+{
+    for(auto &r : rules_)
+    {
+        if(!r.method_.empty() && r.method_ != method)
+            continue;
+
+        if(!r.peer_id_.empty() && r.peer_id_ != peer_id.c_str())
+            continue;
+
+        if(r.permille_ < 1000 &&
+           std::uniform_int_distribution<unsigned int>(0, 999)(rng_) >= r.permille_)
+            continue;
+
+        ++r.hits_;
+        return &r;
+    }
+
+    return nullptr;
+}
+
+const char *AudioPath::FaultInjector::fault_to_string(Fault fault)
+{
+    switch(fault)
+    {
+      case Fault::DELAY:
+        return "delay";
+
+      case Fault::ERROR:
+        return "error";
+
+      case Fault::TIMEOUT:
+        return "timeout";
+
+      case Fault::VANISH:
+        return "vanish";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef FAULTINJECTOR_HH
+#define FAULTINJECTOR_HH
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include "audiopathid.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Failures and delays injected into D-Bus calls to players and audio sources.
+ *
+ * This is a testing aid for measuring the latency of failure paths. Rules are
+ * given on the command line of \c tapswitch (option \c --inject-fault) or set
+ * up directly by benchmarks. Without any rules, the switch calls its peers
+ * unchanged, and the cost is a single check per call.
+ *
+ * A rule is written as \c PEER:METHOD:FAULT[:MS][@PERMILLE], where \c PEER
+ * is a player or audio source ID and \c METHOD is one of \c Activate,
+ * \c Deactivate, \c Selected, \c SelectedOnHold, or \c Deselected; either may
+ * be \c * to match anything. \c FAULT is one of
+ *
+ * - \c delay: the call is made, but its answer is held back for \c MS
+ *   milliseconds;
+ * - \c error: the call is not made, it fails with \c G_DBUS_ERROR_FAILED
+ *   after \c MS milliseconds (default 0);
+ * - \c timeout: the call is not made, it fails with
+ *   \c G_DBUS_ERROR_NO_REPLY after \c MS milliseconds (default 25000, the
+ *   GDBus default timeout);
+ * - \c vanish: the call is not made, it fails with
+ *   \c G_DBUS_ERROR_SERVICE_UNKNOWN after \c MS milliseconds (default 0) as
+ *   if the peer had disappeared from the bus.
+ *
+ * Injected delays are cut short if the call is canceled because the switching
+ * deadline has passed, just like real calls. The optional \c PERMILLE limits
+ * the rule to that many out of 1000 matching calls. The first matching rule
+ * wins.
+ */
+class FaultInjector
+{
+  public:
+    enum class Fault
+    {
+        DELAY,
+        ERROR,
+        TIMEOUT,
+        VANISH,
+    };
+
+    struct Rule
+    {
+        /*! Player or audio source ID, empty for any. */
+        std::string peer_id_;
+
+        /*! D-Bus method name, empty for any. */
+        std::string method_;
+
+        Fault fault_;
+        unsigned int delay_ms_;
+        unsigned int permille_;
+
+        /*! Number of calls this rule has been applied to. */
+        uint64_t hits_;
+    };
+
+  private:
+    std::vector<Rule> rules_;
+    std::minstd_rand rng_;
+
+  public:
+    FaultInjector(const FaultInjector &) = delete;
+    FaultInjector &operator=(const FaultInjector &) = delete;
+
+    explicit FaultInjector() {}
+
+    static FaultInjector &get_singleton();
+
+    /*!
+     * Parse rule as described above and append it.
+     *
+     * \returns
+     *     True on success, false if the rule is malformed. Errors are logged.
+     */
+    bool add_rule(const char *spec);
+
+    void clear() { rules_.clear(); }
+
+    bool is_enabled() const { return !rules_.empty(); }
+    const std::vector<Rule> &get_rules() const { return rules_; }
+
+    /*!
+     * Find rule to be applied to a call.
+     *
+     * \returns
+     *     The first rule matching the method and peer ID which is chosen
+     *     according to its probability, or \c nullptr if the call should be
+     *     made unchanged.
+     */
+    const Rule *match(const char *method, const ID &peer_id);
+
+    static const char *fault_to_string(Fault fault);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !FAULTINJECTOR_HH */
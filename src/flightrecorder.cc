@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstdio>
+
+#include "flightrecorder.hh"
+#include "gerrorwrapper.hh"
+#include "messages.h"
+
+constexpr size_t AudioPath::FlightRecorder::CAPACITY;
+
+/* thread IDs used to sort events into separate tracks */
+enum class Track
+{
+    REQUESTS = 1,
+    PEERS,
+    PENDING,
+    APPLIANCE,
+};
+
+AudioPath::FlightRecorder &AudioPath::FlightRecorder::get_singleton()
+{
+    static FlightRecorder recorder;
+    return recorder;
+}
+
+static void append_json_string(std::string &out, const char *str)
+{
+    out += '"';
+
+    for(const char *ch = str; *ch != '\0'; ++ch)
+    {
+        switch(*ch)
+        {
+          case '"':
+            out += "\\\"";
+            break;
+
+          case '\\':
+            out += "\\\\";
+            break;
+
+          default:
+            if(static_cast<unsigned char>(*ch) < 0x20)
+            {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", *ch);
+                out += buffer;
+            }
+            else
+                out += *ch;
+
+            break;
+        }
+    }
+
+    out += '"';
+}
+
+static void append_thread_name(std::string &out, Track track, const char *name)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer),
+             "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+             "\"args\":{\"name\":\"%s\"}},\n",
+             int(track), name);
+    out += buffer;
+}
+
+static void append_event(std::string &out,
+                         const AudioPath::FlightRecorder::Event &ev)
+{
+    using EventType = AudioPath::FlightRecorder::EventType;
+
+    const char *phase = "i";
+    const char *category = nullptr;
+    Track track = Track::REQUESTS;
+
+    switch(ev.type_)
+    {
+      case EventType::REQUEST_RECEIVED:
+        category = "request";
+        break;
+
+      case EventType::CALL_STARTED:
+        phase = "b";
+        category = "peer";
+        track = Track::PEERS;
+        break;
+
+      case EventType::CALL_FINISHED:
+        phase = "e";
+        category = "peer";
+        track = Track::PEERS;
+        break;
+
+      case EventType::PENDING_QUEUED:
+        category = "pending_queued";
+        track = Track::PENDING;
+        break;
+
+      case EventType::PENDING_COMPLETED:
+        category = "pending_completed";
+        track = Track::PENDING;
+        break;
+
+      case EventType::PENDING_CANCELLED:
+        category = "pending_cancelled";
+        track = Track::PENDING;
+        break;
+
+      case EventType::APPLIANCE_STATE:
+        category = "appliance";
+        track = Track::APPLIANCE;
+        break;
+    }
+
+    if(category == nullptr)
+        return;
+
+    out += "{\"name\":";
+    append_json_string(out, ev.name_);
+
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer),
+             ",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%lld,\"pid\":1,\"tid\":%d",
+             category, phase, static_cast<long long>(ev.timestamp_us_),
+             int(track));
+    out += buffer;
+
+    switch(ev.type_)
+    {
+      case EventType::CALL_STARTED:
+      case EventType::CALL_FINISHED:
+        snprintf(buffer, sizeof(buffer), ",\"id\":%u", ev.arg_);
+        out += buffer;
+        break;
+
+      case EventType::REQUEST_RECEIVED:
+      case EventType::PENDING_QUEUED:
+      case EventType::PENDING_COMPLETED:
+      case EventType::PENDING_CANCELLED:
+      case EventType::APPLIANCE_STATE:
+        out += ",\"s\":\"t\"";
+        break;
+    }
+
+    out += ",\"args\":{";
+
+    switch(ev.type_)
+    {
+      case EventType::REQUEST_RECEIVED:
+        out += "\"id\":";
+        append_json_string(out, AudioPath::ID(ev.id_).c_str());
+        break;
+
+      case EventType::CALL_STARTED:
+        out += "\"peer\":";
+        append_json_string(out, AudioPath::ID(ev.id_).c_str());
+        break;
+
+      case EventType::CALL_FINISHED:
+        out += "\"peer\":";
+        append_json_string(out, AudioPath::ID(ev.id_).c_str());
+        out += ev.failed_ ? ",\"failed\":true" : ",\"failed\":false";
+        break;
+
+      case EventType::PENDING_QUEUED:
+      case EventType::PENDING_COMPLETED:
+      case EventType::PENDING_CANCELLED:
+        out += "\"id\":";
+        append_json_string(out, AudioPath::ID(ev.id_).c_str());
+        snprintf(buffer, sizeof(buffer), ",\"count\":%u%s", ev.arg_,
+                 ev.failed_ ? ",\"failed\":true" : "");
+        out += buffer;
+        break;
+
+      case EventType::APPLIANCE_STATE:
+        snprintf(buffer, sizeof(buffer), "\"audio_state\":%u,\"power_state\":%u",
+                 ev.arg_ & 0xff, (ev.arg_ >> 8) & 0xff);
+        out += buffer;
+        break;
+    }
+
+    out += "}},\n";
+}
+
+std::string AudioPath::FlightRecorder::to_chrome_trace() const
+{
+    std::string out;
+    out.reserve(256 + size() * 160);
+
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    append_thread_name(out, Track::REQUESTS, "Client requests");
+    append_thread_name(out, Track::PEERS, "Players and audio sources");
+    append_thread_name(out, Track::PENDING, "Deferred activations");
+    append_thread_name(out, Track::APPLIANCE, "Appliance");
+
+    for_each([&out] (const Event &ev) { append_event(out, ev); });
+
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer),
+             "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+             "\"args\":{\"name\":\"tapswitch\",\"lost_events\":%llu}}\n"
+             "]}\n",
+             static_cast<unsigned long long>(get_number_of_lost_events()));
+    out += buffer;
+
+    return out;
+}
+
+bool AudioPath::FlightRecorder::dump_to_file(const char *path) const
+{
+    const std::string trace(to_chrome_trace());
+    GErrorWrapper error;
+
+    g_file_set_contents(path, trace.c_str(), trace.length(), error.await());
+
+    if(error.log_failure("Write flight recorder trace"))
+    {
+        msg_error(0, LOG_ERR, "Failed writing flight recorder to %s", path);
+        return false;
+    }
+
+    msg_vinfo(MESSAGE_LEVEL_IMPORTANT,
+              "Wrote %zu flight recorder events to %s", size(), path);
+
+    return true;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef FLIGHTRECORDER_HH
+#define FLIGHTRECORDER_HH
+
+#include <array>
+#include <string>
+#include <cstdint>
+
+#include <glib.h>
+
+#include "audiopathid.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Ring buffer of the most recent audio path events.
+ *
+ * The recorder is always on. Recording an event stores a handful of integers
+ * and a pointer to a string literal in a preallocated array, so that it
+ * never allocates memory and costs not much more than reading the monotonic
+ * clock. When the buffer is full, the oldest events are overwritten.
+ *
+ * The contents can be exported as Chrome trace-event JSON, which can be
+ * loaded into Perfetto or \c chrome://tracing to view a misbehaving audio
+ * path switch as a timeline.
+ */
+class FlightRecorder
+{
+  public:
+    enum class EventType : uint8_t
+    {
+        /*! D-Bus request from a client, \c arg_ is unused. */
+        REQUEST_RECEIVED,
+
+        /*! D-Bus method call to a player or audio source, \c arg_ is the
+         *  call's sequence number. */
+        CALL_STARTED,
+
+        /*! Answer from a player or audio source, \c arg_ is the call's
+         *  sequence number. */
+        CALL_FINISHED,
+
+        /*! Audio source request deferred until the appliance is ready,
+         *  \c arg_ is the number of waiting requests. */
+        PENDING_QUEUED,
+
+        /*! Deferred audio source requests answered after the appliance has
+         *  become ready, \c arg_ is the number of answered requests. */
+        PENDING_COMPLETED,
+
+        /*! Deferred audio source requests canceled, \c arg_ is the number of
+         *  canceled requests. */
+        PENDING_CANCELLED,
+
+        /*! Appliance state reported, \c arg_ contains the audio state in the
+         *  low byte and the power state in the next byte. */
+        APPLIANCE_STATE,
+    };
+
+    struct Event
+    {
+        int64_t timestamp_us_;
+
+        /*! Name of request or method call, must be a string literal. */
+        const char *name_;
+
+        /*! Handle of player or audio source ID, if any. */
+        uint32_t id_;
+
+        uint32_t arg_;
+        EventType type_;
+        bool failed_;
+    };
+
+    static constexpr size_t CAPACITY = 4096;
+
+  private:
+    std::array<Event, CAPACITY> events_;
+
+    /*! Total number of events recorded since the last reset. */
+    uint64_t recorded_;
+
+    /*! Sequence number of the most recent peer call. */
+    uint32_t last_call_;
+
+  public:
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    explicit FlightRecorder():
+        recorded_(0),
+        last_call_(0)
+    {}
+
+    static FlightRecorder &get_singleton();
+
+    void record(EventType type, const char *name, const ID &id = ID(),
+                uint32_t arg = 0, bool failed = false)
+    {
+        Event &ev(events_[recorded_++ % CAPACITY]);
+
+        ev.timestamp_us_ = g_get_monotonic_time();
+        ev.name_ = name;
+        ev.id_ = id.get_handle();
+        ev.arg_ = arg;
+        ev.type_ = type;
+        ev.failed_ = failed;
+    }
+
+    /*!
+     * Record start of D-Bus method call to a peer.
+     *
+     * \returns
+     *     Sequence number of the call, to be passed to
+     *     #AudioPath::FlightRecorder::record_call_finished().
+     */
+    uint32_t record_call_started(const char *name, const ID &peer_id)
+    {
+        record(EventType::CALL_STARTED, name, peer_id, ++last_call_);
+        return last_call_;
+    }
+
+    void record_call_finished(const char *name, const ID &peer_id,
+                              uint32_t call, bool failed)
+    {
+        record(EventType::CALL_FINISHED, name, peer_id, call, failed);
+    }
+
+    void reset() { recorded_ = 0; }
+
+    size_t size() const { return recorded_ < CAPACITY ? recorded_ : CAPACITY; }
+    uint64_t get_number_of_lost_events() const { return recorded_ - size(); }
+
+    /*!
+     * Call \p apply for each stored event, oldest first.
+     */
+    template <typename F>
+    void for_each(const F &apply) const
+    {
+        for(uint64_t i = recorded_ - size(); i < recorded_; ++i)
+            apply(events_[i % CAPACITY]);
+    }
+
+    /*!
+     * Export stored events as Chrome trace-event JSON.
+     *
+     * This function allocates memory and is meant to be called on demand
+     * only, never on the request path.
+     */
+    std::string to_chrome_trace() const;
+
+    /*!
+     * Write Chrome trace-event JSON to file.
+     *
+     * The file is replaced atomically.
+     */
+    bool dump_to_file(const char *path) const;
+};
+
+}
+
+/*!@}*/
+
+#endif /* !FLIGHTRECORDER_HH */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+
+#include <glib.h>
+
+#include "loopmonitor.hh"
+#include "messages.h"
+
+constexpr unsigned int AudioPath::LoopMonitor::TICK_INTERVAL_MS;
+
+AudioPath::LoopMonitor &AudioPath::LoopMonitor::get_singleton()
+{
+    static LoopMonitor monitor;
+    return monitor;
+}
+
+AudioPath::LoopMonitor::Scope::Scope(LoopMonitor &monitor, const char *name,
+                                     const char *peer):
+    monitor_(&monitor),
+    name_(name),
+    started_us_(g_get_monotonic_time())
+{
+    /* the caller's strings may be gone when the handler returns */
+    if(peer != nullptr)
+        g_strlcpy(peer_, peer, sizeof(peer_));
+    else
+        peer_[0] = '\0';
+}
+
+AudioPath::LoopMonitor::Scope::Scope(Scope &&src):
+    monitor_(src.monitor_),
+    name_(src.name_),
+    started_us_(src.started_us_)
+{
+    memcpy(peer_, src.peer_, sizeof(peer_));
+    src.monitor_ = nullptr;
+}
+
+AudioPath::LoopMonitor::Scope::~Scope()
+{
+    if(monitor_ != nullptr)
+        monitor_->handler_finished(name_, peer_, started_us_);
+}
+
+void AudioPath::LoopMonitor::handler_finished(const char *name,
+                                              const char *peer,
+                                              int64_t started_us)
+{
+    const int64_t duration_us = g_get_monotonic_time() - started_us;
+    auto &h(handlers_[name]);
+
+    h.durations_.add(duration_us);
+
+    if(stall_threshold_us_ == 0 || duration_us <= stall_threshold_us_)
+        return;
+
+    ++h.slow_;
+    stall_explained_ = true;
+
+    msg_error(0, LOG_WARNING,
+              "Main loop blocked for %lld ms by %s from %s",
+              static_cast<long long>(duration_us / 1000), name, peer[0] != '\0' ? peer : "unknown peer");
+}
+
+int AudioPath::LoopMonitor::watchdog_tick(void *user_data)
+{
+    auto &monitor(*static_cast<LoopMonitor *>(user_data));
+    const int64_t now_us = g_get_monotonic_time();
+    const int64_t late_us =
+        now_us - monitor.last_tick_us_ - int64_t(TICK_INTERVAL_MS) * 1000;
+
+    monitor.last_tick_us_ = now_us;
+    monitor.loop_latency_.add(late_us > 0 ? late_us : 0);
+
+    if(late_us > monitor.stall_threshold_us_)
+    {
+        ++monitor.stalls_;
+
+        if(!monitor.stall_explained_)
+            msg_error(0, LOG_WARNING,
+                      "Main loop stalled for %lld ms outside of handlers",
+                      static_cast<long long>(late_us / 1000));
+    }
+
+    monitor.stall_explained_ = false;
+
+    return G_SOURCE_CONTINUE;
+}
+
+void AudioPath::LoopMonitor::start(unsigned int stall_threshold_ms)
+{
+    stop();
+
+    stall_threshold_us_ = int64_t(stall_threshold_ms) * 1000;
+
+    if(stall_threshold_ms == 0)
+        return;
+
+    last_tick_us_ = g_get_monotonic_time();
+    stall_explained_ = false;
+    watchdog_timer_ = g_timeout_add_full(G_PRIORITY_HIGH, TICK_INTERVAL_MS,
+                                         watchdog_tick, this, nullptr);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG,
+              "Watching main loop, stall threshold %u ms", stall_threshold_ms);
+}
+
+void AudioPath::LoopMonitor::stop()
+{
+    if(watchdog_timer_ != 0)
+    {
+        g_source_remove(watchdog_timer_);
+        watchdog_timer_ = 0;
+    }
+
+    stall_threshold_us_ = 0;
+}
+
+void AudioPath::LoopMonitor::reset()
+{
+    for(auto &h : handlers_)
+    {
+        h.second.durations_.reset();
+        h.second.slow_ = 0;
+    }
+
+    loop_latency_.reset();
+    stalls_ = 0;
+}
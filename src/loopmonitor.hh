@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LOOPMONITOR_HH
+#define LOOPMONITOR_HH
+
+#include <map>
+#include <cstdint>
+
+#include "switchstatistics.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Responsiveness of the GLib main loop.
+ *
+ * All D-Bus handlers and answers from peers run on the same main loop, so a
+ * single slow handler delays everything else. The monitor keeps track of
+ * two things:
+ *
+ * - The wall time spent in each handler, keyed by method name. Handlers
+ *   mark their extent by holding a #AudioPath::LoopMonitor::Scope. Method
+ *   names of D-Bus methods called on \c tapswitch and of methods called on
+ *   peers (whose answers are accounted) do not overlap.
+ * - The latency of the main loop itself, measured by a high-priority
+ *   watchdog timer which checks by how much it is late for each tick.
+ *
+ * A handler running longer than the stall threshold is logged together with
+ * the peer which has called it or whose answer it processes. Loop stalls not
+ * explained by any handler are logged as well.
+ *
+ * Accounting a handler takes two reads of the monotonic clock and a lookup
+ * in a small map, and never allocates memory after the first call of each
+ * method.
+ */
+class LoopMonitor
+{
+  public:
+    /*!
+     * Extent of a handler running on the main loop.
+     */
+    class Scope
+    {
+      private:
+        LoopMonitor *monitor_;
+        const char *name_;
+        char peer_[64];
+        int64_t started_us_;
+
+      public:
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        Scope(Scope &&src);
+
+        explicit Scope(LoopMonitor &monitor, const char *name,
+                       const char *peer);
+
+        ~Scope();
+    };
+
+    struct HandlerStatistics
+    {
+        LatencyHistogram durations_;
+
+        /*! Number of calls which took longer than the stall threshold. */
+        uint64_t slow_;
+
+        explicit HandlerStatistics(): slow_(0) {}
+    };
+
+    /*! Interval of the watchdog timer. */
+    static constexpr unsigned int TICK_INTERVAL_MS = 100;
+
+  private:
+    /*! Keyed by address of the method name. */
+    std::map<const char *, HandlerStatistics> handlers_;
+
+    LatencyHistogram loop_latency_;
+    uint64_t stalls_;
+
+    int64_t stall_threshold_us_;
+    unsigned int watchdog_timer_;
+    int64_t last_tick_us_;
+
+    /*! A slow handler has been logged since the last tick. */
+    bool stall_explained_;
+
+  public:
+    LoopMonitor(const LoopMonitor &) = delete;
+    LoopMonitor &operator=(const LoopMonitor &) = delete;
+
+    explicit LoopMonitor():
+        stalls_(0),
+        stall_threshold_us_(0),
+        watchdog_timer_(0),
+        last_tick_us_(0),
+        stall_explained_(false)
+    {}
+
+    static LoopMonitor &get_singleton();
+
+    /*!
+     * Start watchdog on the default main context.
+     *
+     * \param stall_threshold_ms
+     *     Handlers and main loop iterations taking longer than this are
+     *     logged as stalls. If 0, the watchdog is not started and nothing is
+     *     logged, but handler durations are still accounted.
+     */
+    void start(unsigned int stall_threshold_ms);
+
+    void stop();
+
+    /*!
+     * Account for a handler until the returned object goes out of scope.
+     *
+     * \param name
+     *     Method name. Handlers are told apart by the address of the name,
+     *     so it must be a string literal or otherwise remain unchanged for
+     *     the lifetime of the program, and the same pointer must be passed
+     *     for each call of the same method.
+     *
+     * \param peer
+     *     Bus name or ID of the peer on whose behalf the handler runs, may
+     *     be \c nullptr.
+     */
+    Scope enter(const char *name, const char *peer)
+    {
+        return Scope(*this, name, peer);
+    }
+
+    void reset();
+
+    uint64_t get_stall_threshold_us() const { return stall_threshold_us_; }
+    uint64_t get_stalls() const { return stalls_; }
+    const LatencyHistogram &get_loop_latency() const { return loop_latency_; }
+
+    const std::map<const char *, HandlerStatistics> &get_handlers() const
+    {
+        return handlers_;
+    }
+
+  private:
+    void handler_finished(const char *name, const char *peer,
+                          int64_t started_us);
+    static int watchdog_tick(void *user_data);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !LOOPMONITOR_HH */
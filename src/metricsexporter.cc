@@ -0,0 +1,499 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstdarg>
+#include <cerrno>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <gio/gunixsocketaddress.h>
+
+#include "metricsexporter.hh"
+#include "dbus_handlers.hh"
+#include "loopmonitor.hh"
+#include "gerrorwrapper.hh"
+#include "messages.h"
+
+static void append(std::string &out, const char *format, ...) G_GNUC_PRINTF(2, 3);
+
+static void append(std::string &out, const char *format, ...)
+{
+    char buffer[256];
+    va_list ap;
+    va_list retry_ap;
+
+    va_start(ap, format);
+    va_copy(retry_ap, ap);
+    const int length = vsnprintf(buffer, sizeof(buffer), format, ap);
+    va_end(ap);
+
+    if(length < 0)
+        msg_error(errno, LOG_ERR, "Failed formatting metrics");
+    else if(size_t(length) < sizeof(buffer))
+        out += buffer;
+    else
+    {
+        /* too long for the buffer, format directly into the output */
+        const size_t pos = out.size();
+        out.resize(pos + length + 1);
+        vsnprintf(&out[pos], length + 1, format, retry_ap);
+        out.resize(pos + length);
+    }
+
+    va_end(retry_ap);
+}
+
+static void append_family(std::string &out, const char *name,
+                          const char *type, const char *help)
+{
+    append(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void append_histogram(std::string &out, const char *name,
+                             const char *label, const char *value,
+                             const AudioPath::LatencyHistogram &h)
+{
+    const auto &bounds(AudioPath::LatencyHistogram::BOUNDS_US);
+    const auto &buckets(h.get_buckets());
+    unsigned long long cumulative = 0;
+
+    for(size_t i = 0; i < bounds.size(); ++i)
+    {
+        cumulative += buckets[i];
+        append(out, "%s_bucket{%s=\"%s\",le=\"%g\"} %llu\n",
+               name, label, value, bounds[i] / 1.0e6, cumulative);
+    }
+
+    append(out, "%s_bucket{%s=\"%s\",le=\"+Inf\"} %llu\n",
+           name, label, value, static_cast<unsigned long long>(h.get_count()));
+    append(out, "%s_sum{%s=\"%s\"} %.6f\n",
+           name, label, value, h.get_sum() / 1.0e6);
+    append(out, "%s_count{%s=\"%s\"} %llu\n",
+           name, label, value, static_cast<unsigned long long>(h.get_count()));
+}
+
+static void append_state_times(std::string &out, const char *name,
+                               const char *help, const char *const names[],
+                               const AudioPath::StateTime &times,
+                               int64_t now_us)
+{
+    append_family(out, name, "counter", help);
+
+    for(size_t i = 0; i < AudioPath::StateTime::NUMBER_OF_VALUES; ++i)
+        append(out, "%s{state=\"%s\"} %.3f\n", name, names[i],
+               times.get_us(AudioPath::StateTime::Value(i), now_us) / 1.0e6);
+}
+
+std::string Metrics::Exporter::render(const DBus::HandlerData &data)
+{
+    using AudioPath::SwitchStatistics;
+
+    static const SwitchStatistics::Phase peer_phases[] =
+    {
+        SwitchStatistics::Phase::DESELECT_SOURCE,
+        SwitchStatistics::Phase::DEACTIVATE_PLAYER,
+        SwitchStatistics::Phase::ACTIVATE_PLAYER,
+        SwitchStatistics::Phase::SELECT_SOURCE,
+    };
+
+    const auto &sw(data.audio_path_switch_);
+    const auto &stats(sw.get_statistics());
+    std::string out;
+
+    out.reserve(16384);
+
+    append_family(out, "tapswitch_activations_total", "counter",
+                  "Audio source activations by result.");
+
+    for(size_t i = 0; i < AudioPath::Switch::NUMBER_OF_ACTIVATE_RESULTS; ++i)
+    {
+        const auto result = AudioPath::Switch::ActivateResult(i);
+        append(out, "tapswitch_activations_total{result=\"%s\"} %llu\n",
+               AudioPath::Switch::activate_result_name(result),
+               static_cast<unsigned long long>(sw.get_activate_result_count(result)));
+    }
+
+    append_family(out, "tapswitch_switch_phase_duration_seconds", "histogram",
+                  "Time spent in the phases of audio path switching.");
+
+    for(size_t i = 0; i < SwitchStatistics::NUMBER_OF_PHASES; ++i)
+    {
+        const auto phase = SwitchStatistics::Phase(i);
+        append_histogram(out, "tapswitch_switch_phase_duration_seconds",
+                         "phase", SwitchStatistics::phase_name(phase),
+                         stats.get(phase));
+    }
+
+    append_family(out, "tapswitch_peer_calls_total", "counter",
+                  "Answered D-Bus method calls to players and audio sources.");
+
+    for(const auto phase : peer_phases)
+        append(out, "tapswitch_peer_calls_total{phase=\"%s\"} %llu\n",
+               SwitchStatistics::phase_name(phase),
+               static_cast<unsigned long long>(stats.get(phase).get_count()));
+
+    append_family(out, "tapswitch_peer_call_failures_total", "counter",
+                  "D-Bus method calls to players and audio sources answered "
+                  "with an error.");
+
+    for(const auto phase : peer_phases)
+        append(out, "tapswitch_peer_call_failures_total{phase=\"%s\"} %llu\n",
+               SwitchStatistics::phase_name(phase),
+               static_cast<unsigned long long>(stats.get_failures(phase)));
+
+    append_family(out, "tapswitch_pending_activations", "gauge",
+                  "Audio source requests waiting for the appliance.");
+    append(out, "tapswitch_pending_activations %zu\n",
+           data.pending_audio_source_activations_.size());
+
+    append_family(out, "tapswitch_registered_players", "gauge",
+                  "Registered players.");
+    append(out, "tapswitch_registered_players %zu\n",
+           data.audio_paths_.get_number_of_players());
+
+    append_family(out, "tapswitch_registered_sources", "gauge",
+                  "Registered audio sources.");
+    append(out, "tapswitch_registered_sources %zu\n",
+           data.audio_paths_.get_number_of_sources());
+
+    static const char *const power_states[] = { "unknown", "suspended", "up" };
+    static const char *const audio_path_states[] = { "unknown", "blocked", "ready" };
+    const int64_t now_us = g_get_monotonic_time();
+
+    append_state_times(out, "tapswitch_appliance_power_state_seconds_total",
+                       "Time spent in each appliance power state.",
+                       power_states,
+                       data.appliance_state_.get_power_state_time(), now_us);
+    append_state_times(out, "tapswitch_appliance_audio_path_state_seconds_total",
+                       "Time spent in each appliance audio path state.",
+                       audio_path_states,
+                       data.appliance_state_.get_audio_path_state_time(), now_us);
+
+    append_family(out, "tapswitch_main_loop_stalls_total", "counter",
+                  "Main loop iterations delayed beyond the stall threshold.");
+    append(out, "tapswitch_main_loop_stalls_total %llu\n",
+           static_cast<unsigned long long>(AudioPath::LoopMonitor::get_singleton().get_stalls()));
+
+    return out;
+}
+
+namespace
+{
+
+struct FileData
+{
+    const std::string path_;
+    const std::string text_;
+};
+
+struct Response
+{
+    GSocketConnection *const connection_;
+    GBytes *const bytes_;
+    GDataInputStream *const request_;
+    size_t request_size_;
+};
+
+}
+
+bool Metrics::Exporter::start(const char *file_path, const char *socket_path,
+                              unsigned int interval_s)
+{
+    stop();
+
+    if(socket_path != nullptr)
+    {
+        /* remove stale socket left behind by a crashed instance, but
+         * nothing else which happens to be in the way */
+        struct stat st;
+
+        if(lstat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode))
+            unlink(socket_path);
+
+        service_ = g_socket_service_new();
+
+        GSocketAddress *address = g_unix_socket_address_new(socket_path);
+        GErrorWrapper error;
+
+        if(!g_socket_listener_add_address(G_SOCKET_LISTENER(service_), address,
+                                          G_SOCKET_TYPE_STREAM,
+                                          G_SOCKET_PROTOCOL_DEFAULT,
+                                          nullptr, nullptr, error.await()))
+        {
+            error.log_failure("Listen on metrics socket");
+            msg_error(0, LOG_ERR, "Cannot serve metrics on %s", socket_path);
+            g_object_unref(address);
+            g_object_unref(service_);
+            service_ = nullptr;
+            return false;
+        }
+
+        g_object_unref(address);
+        socket_path_ = socket_path;
+        g_signal_connect(service_, "incoming", G_CALLBACK(incoming), this);
+        g_socket_service_start(service_);
+    }
+
+    if(file_path != nullptr)
+        file_path_ = file_path;
+
+    update();
+    timer_ = g_timeout_add_seconds_full(G_PRIORITY_LOW, interval_s,
+                                        update_timer, this, nullptr);
+
+    msg_vinfo(MESSAGE_LEVEL_DIAG, "Exporting metrics every %u s", interval_s);
+
+    return true;
+}
+
+void Metrics::Exporter::stop()
+{
+    if(timer_ != 0)
+    {
+        g_source_remove(timer_);
+        timer_ = 0;
+    }
+
+    if(service_ != nullptr)
+    {
+        g_socket_service_stop(service_);
+        g_socket_listener_close(G_SOCKET_LISTENER(service_));
+        g_object_unref(service_);
+        service_ = nullptr;
+        unlink(socket_path_.c_str());
+        socket_path_.clear();
+    }
+
+    if(snapshot_ != nullptr)
+    {
+        g_bytes_unref(snapshot_);
+        snapshot_ = nullptr;
+    }
+
+    if(file_write_cancellable_ != nullptr)
+    {
+        /* the task holds its own reference */
+        g_cancellable_cancel(file_write_cancellable_);
+        g_object_unref(file_write_cancellable_);
+        file_write_cancellable_ = nullptr;
+    }
+
+    file_path_.clear();
+}
+
+void Metrics::Exporter::update()
+{
+    std::string text(render(data_));
+
+    if(service_ != nullptr)
+    {
+        std::string response;
+
+        append(response,
+               "HTTP/1.0 200 OK\r\n"
+               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+               "Content-Length: %zu\r\n"
+               "Connection: close\r\n"
+               "\r\n", text.size());
+        response += text;
+
+        if(snapshot_ != nullptr)
+            g_bytes_unref(snapshot_);
+
+        snapshot_ = g_bytes_new(response.data(), response.size());
+    }
+
+    if(file_path_.empty() || file_write_cancellable_ != nullptr)
+        return;
+
+    file_write_cancellable_ = g_cancellable_new();
+
+    GTask *task = g_task_new(nullptr, file_write_cancellable_,
+                             write_file_done, this);
+    g_task_set_task_data(task, new FileData{file_path_, std::move(text)},
+                         [] (gpointer data) { delete static_cast<FileData *>(data); });
+    g_task_run_in_thread(task, write_file);
+    g_object_unref(task);
+}
+
+gboolean Metrics::Exporter::update_timer(gpointer user_data)
+{
+    static_cast<Exporter *>(user_data)->update();
+    return G_SOURCE_CONTINUE;
+}
+
+/*!
+ * Write snapshot to file, running in a worker thread.
+ *
+ * The file is replaced atomically by #g_file_set_contents().
+ */
+void Metrics::Exporter::write_file(GTask *task, gpointer source_object,
+                                   gpointer task_data,
+                                   GCancellable *cancellable)
+{
+    if(g_task_return_error_if_cancelled(task))
+        return;
+
+    const auto *data = static_cast<const FileData *>(task_data);
+    GError *error = nullptr;
+
+    if(g_file_set_contents(data->path_.c_str(), data->text_.c_str(),
+                           data->text_.size(), &error))
+        g_task_return_boolean(task, TRUE);
+    else
+        g_task_return_error(task, error);
+}
+
+void Metrics::Exporter::write_file_done(GObject *source_object,
+                                        GAsyncResult *res, gpointer user_data)
+{
+    /* exporter has been stopped, and may have been destroyed already */
+    if(g_cancellable_is_cancelled(g_task_get_cancellable(G_TASK(res))))
+        return;
+
+    auto *exporter = static_cast<Exporter *>(user_data);
+    GErrorWrapper error;
+
+    g_task_propagate_boolean(G_TASK(res), error.await());
+    error.log_failure("Write metrics file");
+
+    g_object_unref(exporter->file_write_cancellable_);
+    exporter->file_write_cancellable_ = nullptr;
+}
+
+/*!
+ * Upper limit for the size of the request headers sent by a client.
+ */
+static constexpr size_t MAX_REQUEST_SIZE = 8192;
+
+static void free_response(Response *response)
+{
+    g_io_stream_close(G_IO_STREAM(response->connection_), nullptr, nullptr);
+    g_object_unref(response->request_);
+    g_object_unref(response->connection_);
+    g_bytes_unref(response->bytes_);
+    delete response;
+}
+
+static void response_sent(GObject *source_object, GAsyncResult *res,
+                          gpointer user_data)
+{
+    auto *response = static_cast<Response *>(user_data);
+    GErrorWrapper error;
+
+    g_output_stream_write_all_finish(G_OUTPUT_STREAM(source_object), res,
+                                     nullptr, error.await());
+    error.log_failure("Send metrics");
+
+    free_response(response);
+}
+
+static void send_response(Response *response)
+{
+    gsize size;
+    const void *bytes = g_bytes_get_data(response->bytes_, &size);
+
+    g_output_stream_write_all_async(
+        g_io_stream_get_output_stream(G_IO_STREAM(response->connection_)),
+        bytes, size, G_PRIORITY_LOW, nullptr, response_sent, response);
+}
+
+static void read_request_line(Response *response);
+
+/*!
+ * Discard the request headers line by line until the empty line which ends
+ * them, then send the response.
+ *
+ * Whatever is requested, the response is always the metrics snapshot. A
+ * client which closes its sending side without sending a request is also
+ * sent the snapshot.
+ */
+static void request_line_read(GObject *source_object, GAsyncResult *res,
+                              gpointer user_data)
+{
+    auto *response = static_cast<Response *>(user_data);
+    GErrorWrapper error;
+    gsize length;
+    char *line =
+        g_data_input_stream_read_line_finish(G_DATA_INPUT_STREAM(source_object),
+                                             res, &length, error.await());
+
+    if(error.log_failure("Receive metrics request"))
+    {
+        free_response(response);
+        return;
+    }
+
+    if(line == nullptr)
+    {
+        send_response(response);
+        return;
+    }
+
+    const bool is_end_of_headers = length == 0 || (length == 1 && line[0] == '\r');
+    g_free(line);
+
+    if(is_end_of_headers)
+        send_response(response);
+    else if((response->request_size_ += length + 1) > MAX_REQUEST_SIZE)
+    {
+        msg_error(0, LOG_NOTICE,
+                  "Metrics request exceeds %zu bytes, closing connection",
+                  MAX_REQUEST_SIZE);
+        free_response(response);
+    }
+    else
+        read_request_line(response);
+}
+
+static void read_request_line(Response *response)
+{
+    g_data_input_stream_read_line_async(response->request_, G_PRIORITY_LOW,
+                                        nullptr, request_line_read, response);
+}
+
+gboolean Metrics::Exporter::incoming(GSocketService *service,
+                                     GSocketConnection *connection,
+                                     GObject *source_object,
+                                     gpointer user_data)
+{
+    auto *exporter = static_cast<Exporter *>(user_data);
+
+    if(exporter->snapshot_ == nullptr)
+        return FALSE;
+
+    auto *response = new Response{
+        static_cast<GSocketConnection *>(g_object_ref(connection)),
+        g_bytes_ref(exporter->snapshot_),
+        g_data_input_stream_new(
+            g_io_stream_get_input_stream(G_IO_STREAM(connection))),
+        0
+    };
+
+    read_request_line(response);
+
+    return TRUE;
+}
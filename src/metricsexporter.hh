@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef METRICSEXPORTER_HH
+#define METRICSEXPORTER_HH
+
+#include <string>
+
+#include <gio/gio.h>
+
+/*!
+ * \addtogroup metrics Metrics export
+ *
+ * Periodic export of switch, registry, and appliance metrics.
+ */
+/*!@{*/
+
+namespace DBus { class HandlerData; }
+
+namespace Metrics
+{
+
+/*!
+ * Write metrics in Prometheus text format to a file and/or a Unix socket.
+ *
+ * A snapshot of all metrics is rendered from a low-priority timer, so that
+ * pending D-Bus requests are always processed first. The file is written by
+ * a worker thread, atomically by writing to a temporary file and renaming
+ * it, as expected by the node-exporter textfile collector. Clients
+ * connecting to the Unix socket are expected to send an HTTP request, whose
+ * headers are read and ignored. They are sent the most recent snapshot as
+ * HTTP response without rendering anything, so that scraping never
+ * interferes with audio path switching.
+ */
+class Exporter
+{
+  private:
+    const DBus::HandlerData &data_;
+
+    std::string file_path_;
+    std::string socket_path_;
+    unsigned int timer_;
+
+    /*! Most recent snapshot, as sent to socket clients. */
+    GBytes *snapshot_;
+
+    GSocketService *service_;
+
+    /*!
+     * Cancellable of the file write in progress, \c nullptr if none.
+     *
+     * It is cancelled when the exporter is stopped, telling the completion
+     * callback that the exporter must not be touched anymore.
+     */
+    GCancellable *file_write_cancellable_;
+
+  public:
+    Exporter(const Exporter &) = delete;
+    Exporter &operator=(const Exporter &) = delete;
+
+    explicit Exporter(const DBus::HandlerData &data):
+        data_(data),
+        timer_(0),
+        snapshot_(nullptr),
+        service_(nullptr),
+        file_write_cancellable_(nullptr)
+    {}
+
+    ~Exporter() { stop(); }
+
+    /*!
+     * Start periodic export.
+     *
+     * \param file_path
+     *     Where to write the metrics to, may be \c nullptr.
+     *
+     * \param socket_path
+     *     Path of Unix socket to listen on, may be \c nullptr.
+     *
+     * \param interval_s
+     *     Time between two snapshots in seconds.
+     *
+     * \returns
+     *     False if the socket could not be set up. Errors are logged.
+     */
+    bool start(const char *file_path, const char *socket_path,
+               unsigned int interval_s);
+
+    void stop();
+
+    /*!
+     * Render all metrics in Prometheus text exposition format.
+     */
+    static std::string render(const DBus::HandlerData &data);
+
+  private:
+    void update();
+    static gboolean update_timer(gpointer user_data);
+    static void write_file(GTask *task, gpointer source_object,
+                           gpointer task_data, GCancellable *cancellable);
+    static void write_file_done(GObject *source_object, GAsyncResult *res,
+                                gpointer user_data);
+    static gboolean incoming(GSocketService *service,
+                             GSocketConnection *connection,
+                             GObject *source_object, gpointer user_data);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !METRICSEXPORTER_HH */
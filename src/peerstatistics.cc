@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+
+#include "peerstatistics.hh"
+#include "messages.h"
+
+constexpr size_t AudioPath::PeerStatistics::NUMBER_OF_METHODS;
+constexpr uint64_t AudioPath::PeerStatistics::MIN_CALLS_FOR_P99;
+constexpr unsigned int AudioPath::PeerStatistics::EWMA_WEIGHT_SHIFT;
+
+AudioPath::PeerStatistics &AudioPath::PeerStatistics::get_singleton()
+{
+    static PeerStatistics stats;
+    return stats;
+}
+
+const char *AudioPath::PeerStatistics::method_name(Method method)
+{
+    switch(method)
+    {
+      case Method::ACTIVATE:
+        return "Activate";
+
+      case Method::DEACTIVATE:
+        return "Deactivate";
+
+      case Method::SELECTED:
+        return "Selected";
+
+      case Method::SELECTED_ON_HOLD:
+        return "SelectedOnHold";
+
+      case Method::DESELECTED:
+        return "Deselected";
+    }
+
+    return "unknown";
+}
+
+static bool method_from_name(const char *name,
+                             AudioPath::PeerStatistics::Method &method)
+{
+    for(size_t i = 0; i < AudioPath::PeerStatistics::NUMBER_OF_METHODS; ++i)
+    {
+        const auto m = AudioPath::PeerStatistics::Method(i);
+
+        if(strcmp(name, AudioPath::PeerStatistics::method_name(m)) == 0)
+        {
+            method = m;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AudioPath::PeerStatistics::add(const char *method, const ID &peer_id,
+                                    const std::string &bus_name,
+                                    uint64_t duration_us, bool failed)
+{
+    Method m;
+
+    if(!method_from_name(method, m))
+        return;
+
+    auto &peer(peers_[peer_id]);
+
+    if(peer.bus_name_ != bus_name)
+    {
+        if(!peer.bus_name_.empty())
+        {
+            msg_vinfo(MESSAGE_LEVEL_DIAG,
+                      "Peer %s moved from %s to %s, restarting its statistics",
+                      peer_id.c_str(), peer.bus_name_.c_str(), bus_name.c_str());
+            peer.reset();
+        }
+
+        peer.bus_name_ = bus_name;
+    }
+
+    auto &stats(peer.methods_[size_t(m)]);
+    auto &h(stats.durations_);
+
+    if(h.get_count() >= MIN_CALLS_FOR_P99)
+    {
+        const uint64_t p99_us = h.get_percentile(99);
+
+        if(duration_us > p99_us)
+        {
+            ++stats.above_p99_;
+            msg_error(0, LOG_WARNING,
+                      "%s of %s (%s) took %.1f ms, above its p99 of %.1f ms "
+                      "(average %.1f ms)",
+                      method, peer_id.c_str(), bus_name.c_str(),
+                      duration_us / 1000.0, p99_us / 1000.0,
+                      stats.ewma_us_ / 1000.0);
+        }
+    }
+
+    if(h.get_count() == 0)
+        stats.ewma_us_ = duration_us;
+    else if(duration_us >= stats.ewma_us_)
+        stats.ewma_us_ += (duration_us - stats.ewma_us_) >> EWMA_WEIGHT_SHIFT;
+    else
+        stats.ewma_us_ -= (stats.ewma_us_ - duration_us) >> EWMA_WEIGHT_SHIFT;
+
+    h.add(duration_us);
+
+    if(failed)
+        ++stats.failures_;
+}
+
+void AudioPath::PeerStatistics::reset()
+{
+    for(auto &p : peers_)
+        p.second.reset();
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef PEERSTATISTICS_HH
+#define PEERSTATISTICS_HH
+
+#include <map>
+#include <string>
+#include <array>
+#include <cstdint>
+
+#include "audiopathid.hh"
+#include "switchstatistics.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Latencies and errors of calls to players and audio sources, per peer.
+ *
+ * Each answer to a call made by #AudioPath::Switch is accounted passively,
+ * keyed by player or audio source ID and by the method called on the peer.
+ * For each peer and method, a histogram of call durations, an exponentially
+ * weighted moving average (EWMA) of call durations, and the number of failed
+ * calls are kept.
+ *
+ * Once enough calls have been accounted for, a call which takes longer than
+ * the 99th percentile of all previous calls of the same peer and method is
+ * logged, so that the peer which slows down audio source switching can be
+ * identified.
+ *
+ * Statistics are bound to the bus name of the peer. When a peer re-registers
+ * from a different bus name (i.e., the process has been restarted), its
+ * statistics start over.
+ */
+class PeerStatistics
+{
+  public:
+    /*!
+     * Methods called on players and audio sources.
+     */
+    enum class Method
+    {
+        ACTIVATE,
+        DEACTIVATE,
+        SELECTED,
+        SELECTED_ON_HOLD,
+        DESELECTED,
+
+        LAST_METHOD = DESELECTED,
+    };
+
+    static constexpr size_t NUMBER_OF_METHODS = size_t(Method::LAST_METHOD) + 1;
+
+    /*!
+     * Number of calls needed before the 99th percentile is trusted.
+     */
+    static constexpr uint64_t MIN_CALLS_FOR_P99 = 100;
+
+    /*!
+     * Weight of new samples in the EWMA, as power of 2 (1/8).
+     */
+    static constexpr unsigned int EWMA_WEIGHT_SHIFT = 3;
+
+    struct MethodStatistics
+    {
+        LatencyHistogram durations_;
+        uint64_t ewma_us_;
+        uint64_t failures_;
+
+        /*! Number of calls which took longer than the historical p99. */
+        uint64_t above_p99_;
+
+        explicit MethodStatistics():
+            ewma_us_(0),
+            failures_(0),
+            above_p99_(0)
+        {}
+
+        void reset()
+        {
+            durations_.reset();
+            ewma_us_ = 0;
+            failures_ = 0;
+            above_p99_ = 0;
+        }
+    };
+
+    struct Peer
+    {
+        std::string bus_name_;
+        std::array<MethodStatistics, NUMBER_OF_METHODS> methods_;
+
+        explicit Peer() {}
+
+        void reset()
+        {
+            for(auto &m : methods_)
+                m.reset();
+        }
+    };
+
+  private:
+    std::map<ID, Peer> peers_;
+
+  public:
+    PeerStatistics(const PeerStatistics &) = delete;
+    PeerStatistics &operator=(const PeerStatistics &) = delete;
+
+    explicit PeerStatistics() {}
+
+    static PeerStatistics &get_singleton();
+
+    /*!
+     * Account for an answered call.
+     *
+     * \param method
+     *     Name of the D-Bus method called on the peer. Calls of unknown
+     *     methods are ignored.
+     *
+     * \param peer_id
+     *     ID of the player or audio source.
+     *
+     * \param bus_name
+     *     Bus name of the peer at the time the call was made.
+     *
+     * \param duration_us
+     *     Time between making the call and processing the answer.
+     *
+     * \param failed
+     *     Whether or not the peer has answered with an error.
+     */
+    void add(const char *method, const ID &peer_id, const std::string &bus_name,
+             uint64_t duration_us, bool failed);
+
+    void reset();
+
+    const std::map<ID, Peer> &get_peers() const { return peers_; }
+
+    static const char *method_name(Method method);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !PEERSTATISTICS_HH */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef PROBES_HH
+#define PROBES_HH
+
+/*!
+ * \addtogroup probes USDT probes
+ *
+ * Static tracepoints for bpftrace, perf, and SystemTap.
+ *
+ * Probes are only compiled in if \c WITH_USDT is defined (meson option
+ * \c usdt, or \c --enable-usdt for configure). Otherwise, the macros expand
+ * to nothing and their arguments are not evaluated.
+ *
+ * With probes compiled in, an unused probe is a single \c nop instruction.
+ * Its arguments are still evaluated, so they must be cheap to compute; IDs
+ * should be passed as C strings obtained from #AudioPath::ID::c_str(),
+ * results as plain integers.
+ *
+ * All probes belong to provider \c tapswitch. See the scripts in
+ * \c tools/bpftrace for examples.
+ */
+/*!@{*/
+
+#if WITH_USDT
+#include <sys/sdt.h>
+#define TAPSWITCH_PROBE(name, ...) STAP_PROBEV(tapswitch, name, __VA_ARGS__)
+#else /* !WITH_USDT */
+#define TAPSWITCH_PROBE(name, ...) do {} while(0)
+#endif /* WITH_USDT */
+
+/*!@}*/
+
+#endif /* !PROBES_HH */
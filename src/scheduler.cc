@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <glib.h>
+
+#include "scheduler.hh"
+
+namespace AudioPath
+{
+
+class GLibScheduler: public Scheduler
+{
+  public:
+    GLibScheduler(const GLibScheduler &) = delete;
+    GLibScheduler &operator=(const GLibScheduler &) = delete;
+
+    explicit GLibScheduler() {}
+
+    int64_t now_us() const final override { return g_get_monotonic_time(); }
+
+    unsigned int add_timer(unsigned int timeout_ms, TimerFn &&fn) final override
+    {
+        return g_timeout_add_full(G_PRIORITY_DEFAULT, timeout_ms, fire,
+                                  new TimerFn(std::move(fn)),
+                                  [] (gpointer user_data)
+                                  {
+                                      delete static_cast<TimerFn *>(user_data);
+                                  });
+    }
+
+    void remove_timer(unsigned int timer_id) final override
+    {
+        g_source_remove(timer_id);
+    }
+
+  private:
+    static gboolean fire(gpointer user_data)
+    {
+        (*static_cast<TimerFn *>(user_data))();
+        return G_SOURCE_REMOVE;
+    }
+};
+
+}
+
+AudioPath::Scheduler &AudioPath::Scheduler::get_default()
+{
+    static GLibScheduler scheduler;
+    return scheduler;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef SCHEDULER_HH
+#define SCHEDULER_HH
+
+#include <functional>
+#include <cstdint>
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Source of time and one-shot timers for the audio path switch.
+ *
+ * The switch measures durations and arms its deadline and coalescing timers
+ * through this interface only, so that tests can run it on a virtual clock
+ * instead of the GLib main loop. The default implementation returned by
+ * #AudioPath::Scheduler::get_default() uses \c g_get_monotonic_time() and
+ * GLib timeout sources.
+ */
+class Scheduler
+{
+  public:
+    using TimerFn = std::function<void()>;
+
+  protected:
+    explicit Scheduler() {}
+
+  public:
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    virtual ~Scheduler() {}
+
+    static Scheduler &get_default();
+
+    /*!
+     * Monotonic time in microseconds.
+     */
+    virtual int64_t now_us() const = 0;
+
+    /*!
+     * Call \p fn once after \p timeout_ms milliseconds.
+     *
+     * The function object is destroyed after it has been called, or when the
+     * timer is removed before it has fired.
+     *
+     * \returns
+     *     A non-zero timer ID for #AudioPath::Scheduler::remove_timer().
+     */
+    virtual unsigned int add_timer(unsigned int timeout_ms, TimerFn &&fn) = 0;
+
+    /*!
+     * Remove timer which has not fired yet.
+     */
+    virtual void remove_timer(unsigned int timer_id) = 0;
+};
+
+}
+
+/*!@}*/
+
+#endif /* !SCHEDULER_HH */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "switchstatistics.hh"
+
+constexpr std::array<uint64_t, 15> AudioPath::LatencyHistogram::BOUNDS_US;
+constexpr size_t AudioPath::LatencyHistogram::NUMBER_OF_BUCKETS;
+constexpr size_t AudioPath::SwitchStatistics::NUMBER_OF_PHASES;
+
+uint64_t AudioPath::LatencyHistogram::get_percentile(unsigned int percent) const
+{
+    if(count_ == 0)
+        return 0;
+
+    if(percent > 100)
+        percent = 100;
+
+    /* rank of the sample we are looking for, rounded up, at least 1 */
+    uint64_t rank = (count_ * percent + 99) / 100;
+
+    if(rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < BOUNDS_US.size(); ++i)
+    {
+        seen += buckets_[i];
+
+        if(seen >= rank)
+            return BOUNDS_US[i] < max_us_ ? BOUNDS_US[i] : max_us_;
+    }
+
+    return max_us_;
+}
+
+const char *AudioPath::SwitchStatistics::phase_name(Phase phase)
+{
+    switch(phase)
+    {
+      case Phase::DESELECT_SOURCE:
+        return "deselect_source";
+
+      case Phase::DEACTIVATE_PLAYER:
+        return "deactivate_player";
+
+      case Phase::ACTIVATE_PLAYER:
+        return "activate_player";
+
+      case Phase::SELECT_SOURCE:
+        return "select_source";
+
+      case Phase::DEFERRED:
+        return "deferred";
+
+      case Phase::ACTIVATION:
+        return "activation";
+    }
+
+    return "unknown";
+}
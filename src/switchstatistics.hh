@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef SWITCHSTATISTICS_HH
+#define SWITCHSTATISTICS_HH
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Histogram of durations with fixed bucket boundaries.
+ *
+ * Adding a sample is a short linear scan over a handful of constants and a
+ * few integer additions, so that the histograms can be left enabled in
+ * production. Percentiles are computed from the bucket counts on demand;
+ * they are reported as the upper boundary of the bucket which contains the
+ * requested rank, except for the last bucket, which has no upper boundary
+ * and is reported as the maximum observed duration.
+ */
+class LatencyHistogram
+{
+  public:
+    /*!
+     * Upper bucket boundaries in microseconds (inclusive).
+     *
+     * There is one more bucket for everything above the last boundary.
+     */
+    static constexpr std::array<uint64_t, 15> BOUNDS_US
+    {
+        250, 500, 1000, 2000, 5000, 10000, 20000, 50000,
+        100000, 200000, 500000, 1000000, 2000000, 5000000, 10000000,
+    };
+
+    static constexpr size_t NUMBER_OF_BUCKETS = BOUNDS_US.size() + 1;
+
+  private:
+    std::array<uint64_t, NUMBER_OF_BUCKETS> buckets_;
+    uint64_t count_;
+    uint64_t sum_us_;
+    uint64_t max_us_;
+
+  public:
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    explicit LatencyHistogram() { reset(); }
+
+    void reset()
+    {
+        buckets_.fill(0);
+        count_ = 0;
+        sum_us_ = 0;
+        max_us_ = 0;
+    }
+
+    void add(uint64_t duration_us)
+    {
+        size_t i = 0;
+
+        while(i < BOUNDS_US.size() && duration_us > BOUNDS_US[i])
+            ++i;
+
+        ++buckets_[i];
+        ++count_;
+        sum_us_ += duration_us;
+
+        if(duration_us > max_us_)
+            max_us_ = duration_us;
+    }
+
+    uint64_t get_count() const { return count_; }
+    uint64_t get_sum() const { return sum_us_; }
+    uint64_t get_max() const { return max_us_; }
+    const std::array<uint64_t, NUMBER_OF_BUCKETS> &get_buckets() const { return buckets_; }
+
+    /*!
+     * Return upper bound of given percentile in microseconds.
+     *
+     * \param percent
+     *     Percentile in range [0, 100].
+     *
+     * \returns
+     *     The duration which is not exceeded by \p percent percent of all
+     *     samples, rounded up to the next bucket boundary, but never more
+     *     than the maximum observed duration; 0 if there are no samples.
+     */
+    uint64_t get_percentile(unsigned int percent) const;
+};
+
+/*!
+ * Durations of the phases of audio path switching.
+ */
+class SwitchStatistics
+{
+  public:
+    enum class Phase
+    {
+        /*! Old audio source answering \c Deselected. */
+        DESELECT_SOURCE,
+
+        /*! Old player answering \c Deactivate. */
+        DEACTIVATE_PLAYER,
+
+        /*! New player answering \c Activate. */
+        ACTIVATE_PLAYER,
+
+        /*! New audio source answering \c Selected or \c SelectedOnHold. */
+        SELECT_SOURCE,
+
+        /*! Audio source activation waiting for the appliance to get ready. */
+        DEFERRED,
+
+        /*! Complete audio source activation, from start to finish. */
+        ACTIVATION,
+
+        LAST_PHASE = ACTIVATION,
+    };
+
+    static constexpr size_t NUMBER_OF_PHASES = size_t(Phase::LAST_PHASE) + 1;
+
+  private:
+    std::array<LatencyHistogram, NUMBER_OF_PHASES> histograms_;
+
+    /*! Number of failed peer calls, only used for peer call phases. */
+    std::array<uint64_t, NUMBER_OF_PHASES> failures_;
+
+  public:
+    SwitchStatistics(const SwitchStatistics &) = delete;
+    SwitchStatistics &operator=(const SwitchStatistics &) = delete;
+
+    explicit SwitchStatistics() { failures_.fill(0); }
+
+    void add(Phase phase, uint64_t duration_us)
+    {
+        histograms_[size_t(phase)].add(duration_us);
+    }
+
+    /*!
+     * Account for a peer call which has been answered with an error.
+     *
+     * Its duration must be added by #AudioPath::SwitchStatistics::add() as
+     * well, so that the histogram count is the total number of calls.
+     */
+    void add_failure(Phase phase) { ++failures_[size_t(phase)]; }
+
+    void reset()
+    {
+        for(auto &h : histograms_)
+            h.reset();
+
+        failures_.fill(0);
+    }
+
+    const LatencyHistogram &get(Phase phase) const
+    {
+        return histograms_[size_t(phase)];
+    }
+
+    uint64_t get_failures(Phase phase) const
+    {
+        return failures_[size_t(phase)];
+    }
+
+    static const char *phase_name(Phase phase);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !SWITCHSTATISTICS_HH */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -24,6 +24,7 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <cstring>
+#include <climits>
 #include <iostream>
 
 #include <glib-unix.h>
@@ -32,6 +33,11 @@
 #include "messages_glib.h"
 #include "dbus_iface.h"
 #include "dbus_handlers.hh"
+#include "flightrecorder.hh"
+#include "trafficrecorder.hh"
+#include "faultinjector.hh"
+#include "loopmonitor.hh"
+#include "metricsexporter.hh"
 #include "os.h"
 #include "versioninfo.h"
 
@@ -40,6 +46,15 @@ struct parameters
     enum MessageVerboseLevel verbose_level;
     bool run_in_foreground;
     bool connect_to_session_dbus;
+    unsigned int switch_deadline_ms;
+    bool coalesce_requests;
+    unsigned int coalescing_window_ms;
+    const char *flight_recorder_file;
+    const char *traffic_record_file;
+    unsigned int stall_threshold_ms;
+    const char *metrics_file;
+    const char *metrics_socket;
+    unsigned int metrics_interval_s;
 };
 
 ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
@@ -62,6 +77,9 @@ static void log_version_info(void)
               VCS_TAG, VCS_TICK, VCS_DATE);
 }
 
+static const char DEFAULT_FLIGHT_RECORDER_FILE[] = "/tmp/tapswitch-trace.json";
+static const unsigned int DEFAULT_METRICS_INTERVAL_S = 15;
+
 static void usage(const char *program_name)
 {
     std::cout <<
@@ -75,6 +93,39 @@ static void usage(const char *program_name)
         "  --fg           Run in foreground, don't run as daemon.\n"
         "  --session-dbus Connect to session D-Bus.\n"
         "  --system-dbus  Connect to system D-Bus.\n"
+        "  --switch-deadline ms\n"
+        "                 Maximum time an audio path switch or release may\n"
+        "                 take from request to answer, 0 for no limit\n"
+        "                 (default: 0).\n"
+        "  --coalesce-requests ms\n"
+        "                 Let newer audio source requests supersede queued\n"
+        "                 ones, hold requests back for given time while idle\n"
+        "                 (default: disabled).\n"
+        "  --flight-recorder-file path\n"
+        "                 Where to write recent events as Chrome trace JSON\n"
+        "                 on SIGUSR1 (default: " << DEFAULT_FLIGHT_RECORDER_FILE << ").\n"
+        "  --record-traffic path\n"
+        "                 Record D-Bus traffic to given file for replay by\n"
+        "                 tapswitch-replay (default: disabled).\n"
+        "  --stall-threshold ms\n"
+        "                 Watch the main loop and log D-Bus handlers and\n"
+        "                 main loop iterations taking longer than this, 0 to\n"
+        "                 disable (default: disabled).\n"
+        "  --metrics-file path\n"
+        "                 Write metrics in Prometheus text format to given\n"
+        "                 file periodically (default: disabled).\n"
+        "  --metrics-socket path\n"
+        "                 Serve metrics over HTTP on given Unix socket\n"
+        "                 (default: disabled).\n"
+        "  --metrics-interval s\n"
+        "                 Time between metrics updates in seconds\n"
+        "                 (default: " << DEFAULT_METRICS_INTERVAL_S << ").\n"
+        "  --inject-fault rule\n"
+        "                 Make calls to players and audio sources fail or\n"
+        "                 take longer for testing. May be given multiple\n"
+        "                 times. Rule format: PEER:METHOD:FAULT[:MS][@PERMILLE]\n"
+        "                 with FAULT one of delay, error, timeout, vanish and\n"
+        "                 * as wildcard for PEER and METHOD.\n"
         ;
 }
 
@@ -91,12 +142,38 @@ static bool check_argument(int argc, char *argv[], int &i)
     return true;
 }
 
+static bool parse_milliseconds(const char *arg, const char *what,
+                               unsigned int &value)
+{
+    char *endptr;
+    const unsigned long temp = strtoul(arg, &endptr, 10);
+
+    if(*arg == '\0' || *endptr != '\0' || temp > UINT_MAX)
+    {
+        std::cerr << "Invalid " << what << " \"" << arg << "\".\n";
+        return false;
+    }
+
+    value = temp;
+
+    return true;
+}
+
 static int process_command_line(int argc, char *argv[],
                                 struct parameters *parameters)
 {
     parameters->verbose_level = MESSAGE_LEVEL_NORMAL;
     parameters->run_in_foreground = false;
     parameters->connect_to_session_dbus = true;
+    parameters->switch_deadline_ms = 0;
+    parameters->coalesce_requests = false;
+    parameters->coalescing_window_ms = 0;
+    parameters->flight_recorder_file = DEFAULT_FLIGHT_RECORDER_FILE;
+    parameters->traffic_record_file = nullptr;
+    parameters->stall_threshold_ms = 0;
+    parameters->metrics_file = nullptr;
+    parameters->metrics_socket = nullptr;
+    parameters->metrics_interval_s = DEFAULT_METRICS_INTERVAL_S;
 
     for(int i = 1; i < argc; ++i)
     {
@@ -133,6 +210,76 @@ static int process_command_line(int argc, char *argv[],
             parameters->connect_to_session_dbus = true;
         else if(strcmp(argv[i], "--system-dbus") == 0)
             parameters->connect_to_session_dbus = false;
+        else if(strcmp(argv[i], "--switch-deadline") == 0)
+        {
+            if(!check_argument(argc, argv, i) ||
+               !parse_milliseconds(argv[i], "deadline",
+                                   parameters->switch_deadline_ms))
+                return -1;
+        }
+        else if(strcmp(argv[i], "--coalesce-requests") == 0)
+        {
+            if(!check_argument(argc, argv, i) ||
+               !parse_milliseconds(argv[i], "coalescing window",
+                                   parameters->coalescing_window_ms))
+                return -1;
+
+            parameters->coalesce_requests = true;
+        }
+        else if(strcmp(argv[i], "--flight-recorder-file") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters->flight_recorder_file = argv[i];
+        }
+        else if(strcmp(argv[i], "--record-traffic") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters->traffic_record_file = argv[i];
+        }
+        else if(strcmp(argv[i], "--stall-threshold") == 0)
+        {
+            if(!check_argument(argc, argv, i) ||
+               !parse_milliseconds(argv[i], "stall threshold",
+                                   parameters->stall_threshold_ms))
+                return -1;
+        }
+        else if(strcmp(argv[i], "--metrics-file") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters->metrics_file = argv[i];
+        }
+        else if(strcmp(argv[i], "--metrics-socket") == 0)
+        {
+            if(!check_argument(argc, argv, i))
+                return -1;
+
+            parameters->metrics_socket = argv[i];
+        }
+        else if(strcmp(argv[i], "--metrics-interval") == 0)
+        {
+            if(!check_argument(argc, argv, i) ||
+               !parse_milliseconds(argv[i], "metrics interval",
+                                   parameters->metrics_interval_s))
+                return -1;
+
+            if(parameters->metrics_interval_s == 0)
+            {
+                std::cerr << "Metrics interval must not be 0.\n";
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--inject-fault") == 0)
+        {
+            if(!check_argument(argc, argv, i) ||
+               !AudioPath::FaultInjector::get_singleton().add_rule(argv[i]))
+                return -1;
+        }
         else
         {
             std::cerr << "Unknown option \"" << argv[i]
@@ -181,10 +328,20 @@ static gboolean signal_handler(gpointer user_data)
     return G_SOURCE_REMOVE;
 }
 
-static void connect_unix_signals(GMainLoop *loop)
+static gboolean dump_flight_recorder(gpointer user_data)
+{
+    AudioPath::FlightRecorder::get_singleton()
+        .dump_to_file(static_cast<const char *>(user_data));
+    return G_SOURCE_CONTINUE;
+}
+
+static void connect_unix_signals(GMainLoop *loop,
+                                 const struct parameters *parameters)
 {
     g_unix_signal_add(SIGINT, signal_handler, loop);
     g_unix_signal_add(SIGTERM, signal_handler, loop);
+    g_unix_signal_add(SIGUSR1, dump_flight_recorder,
+                      const_cast<char *>(parameters->flight_recorder_file));
 }
 
 int main(int argc, char *argv[])
@@ -211,16 +368,36 @@ int main(int argc, char *argv[])
     if(setup(&parameters, &loop) < 0)
         return EXIT_FAILURE;
 
+    if(parameters.traffic_record_file != nullptr &&
+       !AudioPath::TrafficRecorder::get_singleton().start(parameters.traffic_record_file))
+        return EXIT_FAILURE;
+
     static DBus::HandlerData dbus_handler_data;
+    dbus_handler_data.audio_path_switch_.set_deadline(parameters.switch_deadline_ms);
+    dbus_handler_data.audio_path_switch_.set_coalescing(parameters.coalesce_requests,
+                                                        parameters.coalescing_window_ms);
 
     if(dbus_setup(loop, parameters.connect_to_session_dbus, &dbus_handler_data) < 0)
         return EXIT_FAILURE;
 
-    connect_unix_signals(loop);
+    static Metrics::Exporter metrics_exporter(dbus_handler_data);
+
+    if((parameters.metrics_file != nullptr ||
+        parameters.metrics_socket != nullptr) &&
+       !metrics_exporter.start(parameters.metrics_file,
+                               parameters.metrics_socket,
+                               parameters.metrics_interval_s))
+        return EXIT_FAILURE;
+
+    connect_unix_signals(loop, &parameters);
+    AudioPath::LoopMonitor::get_singleton().start(parameters.stall_threshold_ms);
     g_main_loop_run(loop);
 
     msg_vinfo(MESSAGE_LEVEL_IMPORTANT, "Shutting down");
+    metrics_exporter.stop();
+    AudioPath::LoopMonitor::get_singleton().stop();
     dbus_shutdown(loop);
+    AudioPath::TrafficRecorder::get_singleton().stop();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <cerrno>
+
+#include "trafficrecorder.hh"
+#include "messages.h"
+
+const char AudioPath::TrafficRecorder::MAGIC[8] =
+{
+    'T', 'A', 'P', 'S', 'R', 'E', 'C', '\0',
+};
+
+constexpr uint32_t AudioPath::TrafficRecorder::FORMAT_VERSION;
+constexpr uint32_t AudioPath::TrafficRecorder::BYTE_ORDER_MARK;
+
+static constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+AudioPath::TrafficRecorder &AudioPath::TrafficRecorder::get_singleton()
+{
+    static TrafficRecorder recorder;
+    return recorder;
+}
+
+bool AudioPath::TrafficRecorder::start(const char *path)
+{
+    stop();
+
+    file_ = fopen(path, "wb");
+
+    if(file_ == nullptr)
+    {
+        msg_error(errno, LOG_ERR, "Failed opening traffic record file %s", path);
+        return false;
+    }
+
+    setvbuf(file_, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+
+    put_bytes(MAGIC, sizeof(MAGIC));
+    put_bytes(&FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    put_bytes(&BYTE_ORDER_MARK, sizeof(BYTE_ORDER_MARK));
+
+    flush_timer_id_ = g_timeout_add_seconds(1, flush, this);
+    number_of_records_ = 0;
+
+    msg_vinfo(MESSAGE_LEVEL_IMPORTANT, "Recording D-Bus traffic to %s", path);
+
+    return true;
+}
+
+void AudioPath::TrafficRecorder::stop()
+{
+    if(file_ == nullptr)
+        return;
+
+    if(flush_timer_id_ != 0)
+    {
+        g_source_remove(flush_timer_id_);
+        flush_timer_id_ = 0;
+    }
+
+    if(fclose(file_) != 0)
+        msg_error(errno, LOG_ERR, "Failed closing traffic record file");
+    else
+        msg_vinfo(MESSAGE_LEVEL_DIAG, "Recorded %llu D-Bus traffic records",
+                  static_cast<unsigned long long>(number_of_records_));
+
+    file_ = nullptr;
+}
+
+gboolean AudioPath::TrafficRecorder::flush(gpointer user_data)
+{
+    auto &recorder = *static_cast<TrafficRecorder *>(user_data);
+
+    if(recorder.file_ == nullptr)
+        return G_SOURCE_REMOVE;
+
+    if(fflush(recorder.file_) != 0 || ferror(recorder.file_))
+    {
+        msg_error(errno, LOG_ERR,
+                  "Failed writing traffic record file, stop recording");
+        recorder.flush_timer_id_ = 0;
+        recorder.stop();
+        return G_SOURCE_REMOVE;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+void AudioPath::TrafficRecorder::put_bytes(const void *data, size_t size)
+{
+    fwrite(data, 1, size, file_);
+}
+
+void AudioPath::TrafficRecorder::put_string(const char *str)
+{
+    const size_t len = strlen(str);
+    const uint16_t len16 = len <= UINT16_MAX ? len : UINT16_MAX;
+
+    put_bytes(&len16, sizeof(len16));
+    put_bytes(str, len16);
+}
+
+void AudioPath::TrafficRecorder::begin_record(RecordType type,
+                                              gint64 timestamp_us)
+{
+    const int64_t ts = timestamp_us;
+
+    put_bytes(&type, sizeof(type));
+    put_bytes(&ts, sizeof(ts));
+    ++number_of_records_;
+}
+
+void AudioPath::TrafficRecorder::record_method_call(const char *interface_name,
+                                                    const char *method_name,
+                                                    const char *sender,
+                                                    GVariant *parameters)
+{
+    if(file_ == nullptr)
+        return;
+
+    const uint32_t size = g_variant_get_size(parameters);
+
+    begin_record(RecordType::METHOD_CALL, g_get_monotonic_time());
+    put_string(interface_name);
+    put_string(method_name);
+    put_string(sender != nullptr ? sender : "");
+    put_string(g_variant_get_type_string(parameters));
+    put_bytes(&size, sizeof(size));
+    put_bytes(g_variant_get_data(parameters), size);
+}
+
+void AudioPath::TrafficRecorder::record_peer_call(const char *method_name,
+                                                  const ID &peer_id,
+                                                  gint64 started_us,
+                                                  gint64 duration_us,
+                                                  bool failed)
+{
+    if(file_ == nullptr)
+        return;
+
+    const uint32_t duration = duration_us < 0
+        ? 0
+        : (duration_us <= UINT32_MAX ? duration_us : UINT32_MAX);
+    const uint8_t failed_flag = failed ? 1 : 0;
+
+    begin_record(RecordType::PEER_CALL, started_us);
+    put_string(method_name);
+    put_string(peer_id.c_str());
+    put_bytes(&duration, sizeof(duration));
+    put_bytes(&failed_flag, sizeof(failed_flag));
+}
+
+void AudioPath::TrafficRecorder::record_peer_vanished(const char *name)
+{
+    if(file_ == nullptr)
+        return;
+
+    begin_record(RecordType::PEER_VANISHED, g_get_monotonic_time());
+    put_string(name);
+}
+
+bool AudioPath::TrafficReader::open(const char *path)
+{
+    close();
+
+    file_ = fopen(path, "rb");
+
+    if(file_ == nullptr)
+    {
+        msg_error(errno, LOG_ERR, "Failed opening traffic record file %s", path);
+        return false;
+    }
+
+    char magic[sizeof(TrafficRecorder::MAGIC)];
+    uint32_t version;
+    uint32_t bom;
+
+    if(!get_bytes(magic, sizeof(magic)) ||
+       !get_bytes(&version, sizeof(version)) ||
+       !get_bytes(&bom, sizeof(bom)) ||
+       memcmp(magic, TrafficRecorder::MAGIC, sizeof(magic)) != 0)
+    {
+        msg_error(0, LOG_ERR, "File %s is not a traffic record", path);
+        close();
+        return false;
+    }
+
+    if(bom != TrafficRecorder::BYTE_ORDER_MARK)
+    {
+        msg_error(0, LOG_ERR, "Traffic record %s has wrong byte order", path);
+        close();
+        return false;
+    }
+
+    if(version != TrafficRecorder::FORMAT_VERSION)
+    {
+        msg_error(0, LOG_ERR, "Traffic record %s has unsupported version %u",
+                  path, version);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void AudioPath::TrafficReader::close()
+{
+    if(file_ == nullptr)
+        return;
+
+    fclose(file_);
+    file_ = nullptr;
+}
+
+bool AudioPath::TrafficReader::get_bytes(void *data, size_t size)
+{
+    return fread(data, 1, size, file_) == size;
+}
+
+bool AudioPath::TrafficReader::get_string(std::string &str)
+{
+    uint16_t len;
+
+    if(!get_bytes(&len, sizeof(len)))
+        return false;
+
+    str.resize(len);
+
+    return len == 0 || get_bytes(&str[0], len);
+}
+
+bool AudioPath::TrafficReader::next(Record &record)
+{
+    if(file_ == nullptr)
+        return false;
+
+    uint8_t type;
+    int64_t ts;
+
+    if(!get_bytes(&type, sizeof(type)))
+        return false;
+
+    if(!get_bytes(&ts, sizeof(ts)))
+    {
+        msg_error(0, LOG_ERR, "Truncated traffic record");
+        return false;
+    }
+
+    record.type_ = TrafficRecorder::RecordType(type);
+    record.timestamp_us_ = ts;
+    record.interface_name_.clear();
+    record.method_name_.clear();
+    record.sender_.clear();
+    record.parameters_ = GVariantWrapper();
+    record.peer_id_.clear();
+    record.duration_us_ = 0;
+    record.failed_ = false;
+
+    bool ok = false;
+
+    switch(record.type_)
+    {
+      case TrafficRecorder::RecordType::METHOD_CALL:
+        {
+            std::string type_string;
+            uint32_t size;
+
+            ok = get_string(record.interface_name_) &&
+                 get_string(record.method_name_) &&
+                 get_string(record.sender_) &&
+                 get_string(type_string) &&
+                 get_bytes(&size, sizeof(size)) &&
+                 g_variant_type_string_is_valid(type_string.c_str());
+
+            if(!ok)
+                break;
+
+            gpointer data = g_malloc(size > 0 ? size : 1);
+
+            if(size > 0 && !get_bytes(data, size))
+            {
+                g_free(data);
+                ok = false;
+                break;
+            }
+
+            record.parameters_ =
+                GVariantWrapper(g_variant_new_from_data(
+                                    G_VARIANT_TYPE(type_string.c_str()),
+                                    data, size, FALSE, g_free, data));
+        }
+
+        break;
+
+      case TrafficRecorder::RecordType::PEER_CALL:
+        {
+            uint8_t failed = 0;
+
+            ok = get_string(record.method_name_) &&
+                 get_string(record.peer_id_) &&
+                 get_bytes(&record.duration_us_, sizeof(record.duration_us_)) &&
+                 get_bytes(&failed, sizeof(failed));
+            record.failed_ = failed != 0;
+        }
+
+        break;
+
+      case TrafficRecorder::RecordType::PEER_VANISHED:
+        ok = get_string(record.sender_);
+        break;
+
+      default:
+        msg_error(0, LOG_ERR, "Unknown traffic record type %u", type);
+        return false;
+    }
+
+    if(!ok)
+        msg_error(0, LOG_ERR, "Truncated or corrupt traffic record");
+
+    return ok;
+}
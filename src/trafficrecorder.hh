@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef TRAFFICRECORDER_HH
+#define TRAFFICRECORDER_HH
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+
+#include <glib.h>
+
+#include "audiopathid.hh"
+#include "gvariantwrapper.hh"
+
+/*!
+ * \addtogroup audiopath
+ */
+/*!@{*/
+
+namespace AudioPath
+{
+
+/*!
+ * Binary log of D-Bus traffic for replay.
+ *
+ * When enabled, each method call to the Manager and Appliance interfaces,
+ * each method call to a player or audio source along with its latency, and
+ * each vanishing peer are appended to a file. The file can be fed back into
+ * a \c tapswitch with simulated peers by \c tapswitch-replay.
+ *
+ * The file starts with the 8 bytes \c "TAPSREC\0", followed by the format
+ * version and the number \c 0x01020304 as 32 bit integers in host byte
+ * order, so that readers can detect a byte order mismatch. Records follow
+ * back to back. Each record starts with its type (one byte) and the
+ * monotonic time in microseconds (64 bit integer); the remaining fields
+ * depend on the type. Strings are stored as 16 bit length followed by the
+ * characters, without trailing zero.
+ *
+ * - #AudioPath::TrafficRecorder::RecordType::METHOD_CALL: interface name,
+ *   method name, sender, type string of the parameters, 32 bit size of the
+ *   serialized parameters, serialized parameters (GVariant normal form).
+ * - #AudioPath::TrafficRecorder::RecordType::PEER_CALL: method name, ID of
+ *   player or audio source, 32 bit duration in microseconds, one byte which
+ *   is 1 if the call has failed, 0 otherwise. The time stamp is the start
+ *   of the call.
+ * - #AudioPath::TrafficRecorder::RecordType::PEER_VANISHED: unique bus name
+ *   of the peer.
+ *
+ * Records are written through a stdio buffer which is flushed once per
+ * second, so that recording does not cost a system call per record.
+ */
+class TrafficRecorder
+{
+  public:
+    enum class RecordType : uint8_t
+    {
+        METHOD_CALL = 1,
+        PEER_CALL,
+        PEER_VANISHED,
+    };
+
+    static const char MAGIC[8];
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+  private:
+    FILE *file_;
+    guint flush_timer_id_;
+    uint64_t number_of_records_;
+
+  public:
+    TrafficRecorder(const TrafficRecorder &) = delete;
+    TrafficRecorder &operator=(const TrafficRecorder &) = delete;
+
+    explicit TrafficRecorder():
+        file_(nullptr),
+        flush_timer_id_(0),
+        number_of_records_(0)
+    {}
+
+    ~TrafficRecorder() { stop(); }
+
+    static TrafficRecorder &get_singleton();
+
+    bool start(const char *path);
+    void stop();
+
+    bool is_enabled() const { return file_ != nullptr; }
+
+    void record_method_call(const char *interface_name, const char *method_name,
+                            const char *sender, GVariant *parameters);
+    void record_peer_call(const char *method_name, const ID &peer_id,
+                          gint64 started_us, gint64 duration_us, bool failed);
+    void record_peer_vanished(const char *name);
+
+  private:
+    void begin_record(RecordType type, gint64 timestamp_us);
+    void put_string(const char *str);
+    void put_bytes(const void *data, size_t size);
+
+    static gboolean flush(gpointer user_data);
+};
+
+/*!
+ * Read file written by #AudioPath::TrafficRecorder.
+ */
+class TrafficReader
+{
+  public:
+    struct Record
+    {
+        TrafficRecorder::RecordType type_;
+        gint64 timestamp_us_;
+
+        /*! Interface of incoming method call. */
+        std::string interface_name_;
+
+        /*! Name of incoming method call or call to peer. */
+        std::string method_name_;
+
+        /*! Sender of incoming method call, or name of vanished peer. */
+        std::string sender_;
+
+        /*! Parameters of incoming method call. */
+        GVariantWrapper parameters_;
+
+        /*! ID of player or audio source called by \c tapswitch. */
+        std::string peer_id_;
+
+        uint32_t duration_us_;
+        bool failed_;
+    };
+
+  private:
+    FILE *file_;
+
+  public:
+    TrafficReader(const TrafficReader &) = delete;
+    TrafficReader &operator=(const TrafficReader &) = delete;
+
+    explicit TrafficReader(): file_(nullptr) {}
+    ~TrafficReader() { close(); }
+
+    bool open(const char *path);
+    void close();
+
+    /*!
+     * Read next record.
+     *
+     * \returns
+     *     True if a record has been read, false at end of file or on error.
+     *     Errors are logged.
+     */
+    bool next(Record &record);
+
+  private:
+    bool get_bytes(void *data, size_t size);
+    bool get_string(std::string &str);
+};
+
+}
+
+/*!@}*/
+
+#endif /* !TRAFFICRECORDER_HH */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+
+#include "bench_dbus.hh"
+
+const char BenchDBus::TAPSWITCH_BUS_NAME[] = "de.tahifi.TAPSwitch";
+const char BenchDBus::TAPSWITCH_OBJECT_PATH[] = "/de/tahifi/TAPSwitch";
+
+static gboolean set_flag(gpointer user_data)
+{
+    *static_cast<bool *>(user_data) = true;
+    return G_SOURCE_REMOVE;
+}
+
+bool BenchDBus::run_until(const std::function<bool()> &done,
+                          unsigned int timeout_ms)
+{
+    bool timed_out = false;
+    const guint timer = g_timeout_add(timeout_ms, set_flag, &timed_out);
+
+    while(!done() && !timed_out)
+        g_main_context_iteration(nullptr, TRUE);
+
+    if(!timed_out)
+        g_source_remove(timer);
+
+    return !timed_out;
+}
+
+static void name_appeared(GDBusConnection *connection, const gchar *name,
+                          const gchar *name_owner, gpointer user_data)
+{
+    *static_cast<bool *>(user_data) = true;
+}
+
+bool BenchDBus::wait_for_tapswitch(GDBusConnection *connection,
+                                   unsigned int timeout_ms)
+{
+    bool appeared = false;
+    const guint watch =
+        g_bus_watch_name_on_connection(connection, TAPSWITCH_BUS_NAME,
+                                       G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                       name_appeared, nullptr,
+                                       &appeared, nullptr);
+    const bool result =
+        run_until([&appeared] { return appeared; }, timeout_ms);
+
+    g_bus_unwatch_name(watch);
+
+    if(!result)
+        fprintf(stderr, "Timeout waiting for %s\n", TAPSWITCH_BUS_NAME);
+
+    return result;
+}
+
+bool BenchDBus::parse_uint(const char *arg, unsigned int &value)
+{
+    char *endptr;
+    const unsigned long temp = strtoul(arg, &endptr, 10);
+
+    if(*endptr != '\0' || endptr == arg || temp > UINT_MAX)
+        return false;
+
+    value = temp;
+    return true;
+}
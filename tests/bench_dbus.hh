@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef BENCH_DBUS_HH
+#define BENCH_DBUS_HH
+
+#include <functional>
+
+#include <gio/gio.h>
+
+/*!
+ * \addtogroup audiopath_benchmarks
+ */
+/*!@{*/
+
+/*!
+ * Helpers for programs which talk to a running \c tapswitch over D-Bus.
+ */
+namespace BenchDBus
+{
+
+extern const char TAPSWITCH_BUS_NAME[];
+extern const char TAPSWITCH_OBJECT_PATH[];
+
+/*!
+ * Iterate the default main context until \p done returns true.
+ *
+ * \returns
+ *     False on timeout.
+ */
+bool run_until(const std::function<bool()> &done, unsigned int timeout_ms);
+
+/*!
+ * Wait until \c tapswitch owns its bus name.
+ */
+bool wait_for_tapswitch(GDBusConnection *connection, unsigned int timeout_ms);
+
+/*!
+ * Parse unsigned decimal number, reject trailing garbage.
+ */
+bool parse_uint(const char *arg, unsigned int &value);
+
+}
+
+/*!@}*/
+
+#endif /* !BENCH_DBUS_HH */
@@ -0,0 +1,54 @@
+#! /bin/sh
+#
+# Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+#
+# This file is part of TAPSwitch.
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+# MA  02110-1301, USA.
+#
+
+#
+# Run tapswitch and tapswitch-sim on a private session bus.
+#
+# Usage: bench_e2e.sh TAPSWITCH TAPSWITCH-SIM [options for tapswitch-sim]
+#
+# Additional options for tapswitch may be passed in TAPSWITCH_ARGS, e.g.,
+# TAPSWITCH_ARGS="--switch-deadline 500 --inject-fault plB:Activate:error".
+#
+
+set -eu
+
+if test $# -lt 2
+then
+    echo "Usage: $0 TAPSWITCH TAPSWITCH-SIM [options for tapswitch-sim]" >&2
+    exit 1
+fi
+
+if test "x${TAPSWITCH_BENCH_PRIVATE_BUS:-}" = x
+then
+    TAPSWITCH_BENCH_PRIVATE_BUS=1 exec dbus-run-session -- "$0" "$@"
+fi
+
+TAPSWITCH="$1"
+SIM="$2"
+shift 2
+
+# shellcheck disable=SC2086
+"$TAPSWITCH" --fg --session-dbus --quiet ${TAPSWITCH_ARGS:-} &
+TAPSWITCH_PID=$!
+trap 'kill $TAPSWITCH_PID 2>/dev/null || true; wait $TAPSWITCH_PID 2>/dev/null || true' EXIT
+
+"$SIM" "$@"
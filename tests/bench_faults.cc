@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "audiopath.hh"
+#include "audiopathswitch.hh"
+#include "faultinjector.hh"
+#include "de_tahifi_audiopath.h"
+#include "fake_peers.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks Benchmarks
+ * \ingroup audiopath
+ *
+ * Measure audio path switching latency on failure paths.
+ *
+ * The D-Bus methods of players and audio sources are replaced by fakes which
+ * answer successfully from the GLib main loop after a fixed delay. Failures
+ * are injected by the #AudioPath::FaultInjector as configured for each
+ * scenario.
+ *
+ * In each round, the switch starts on a healthy audio path (audio source
+ * \c srcA on player \c plA) and is asked to switch to the faulty audio path
+ * (\c srcB on \c plB). The time until the switch reports the outcome is the
+ * failure latency. Then the switch is asked to go back to the healthy audio
+ * path, and the time until it is usable again is the recovery time.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+static const unsigned int PEER_LATENCY_MS = 5;
+
+namespace DBus
+{
+
+/* peers are dummies */
+template<>
+Proxy<_tdbusaupathPlayer>::~Proxy() {}
+
+template<>
+Proxy<_tdbusaupathSource>::~Proxy() {}
+
+}
+
+static int dummy_proxy;
+
+using Clock = std::chrono::steady_clock;
+
+static const char *result_to_string(AudioPath::Switch::ActivateResult result)
+{
+    switch(result)
+    {
+      case AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN:
+        return "source unknown";
+
+      case AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED:
+        return "source failed";
+
+      case AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN:
+        return "player unknown";
+
+      case AudioPath::Switch::ActivateResult::ERROR_PLAYER_FAILED:
+        return "player failed";
+
+      case AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED:
+        return "deadline";
+
+      case AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED:
+        return "superseded";
+
+      case AudioPath::Switch::ActivateResult::OK_UNCHANGED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SAME_SOURCE_DEFERRED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED:
+      case AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED:
+        return "ok";
+    }
+
+    return "???";
+}
+
+static double switch_once(AudioPath::Switch &sw, const AudioPath::Paths &paths,
+                          const char *source_id,
+                          AudioPath::Switch::ActivateResult &result)
+{
+    bool done = false;
+    const auto start = Clock::now();
+
+    sw.activate_source(paths, source_id, true,
+                       [&done, &result]
+                       (AudioPath::Switch::ActivateResult r,
+                        const AudioPath::ID *,
+                        AudioPath::Switch::DeselectedAudioSourceResult)
+                       {
+                           result = r;
+                           done = true;
+                       });
+
+    while(!done)
+        g_main_context_iteration(nullptr, TRUE);
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void add_paths(AudioPath::Paths &paths)
+{
+    paths.add_source(AudioPath::Source(
+            "srcA", "Source A", "plA",
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<tdbusaupathSource *>(&dummy_proxy))));
+    paths.add_source(AudioPath::Source(
+            "srcB", "Source B", "plB",
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<tdbusaupathSource *>(&dummy_proxy))));
+    paths.add_player(AudioPath::Player(
+            "plA", "Player A",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<tdbusaupathPlayer *>(&dummy_proxy))));
+    paths.add_player(AudioPath::Player(
+            "plB", "Player B",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<tdbusaupathPlayer *>(&dummy_proxy))));
+}
+
+static void run(const char *name, const char *rule, unsigned int deadline_ms,
+                size_t rounds)
+{
+    auto &injector(AudioPath::FaultInjector::get_singleton());
+    AudioPath::Paths paths;
+    AudioPath::Switch sw;
+    AudioPath::Switch::ActivateResult result;
+
+    add_paths(paths);
+    sw.set_deadline(deadline_ms);
+    injector.clear();
+
+    if(rule != nullptr && !injector.add_rule(rule))
+        return;
+
+    switch_once(sw, paths, "srcA", result);
+
+    std::vector<double> failure_ms;
+    std::vector<double> recovery_ms;
+    AudioPath::Switch::ActivateResult failure_result = result;
+    bool recovered = true;
+
+    for(size_t r = 0; r < rounds; ++r)
+    {
+        failure_ms.push_back(switch_once(sw, paths, "srcB", failure_result));
+        recovery_ms.push_back(switch_once(sw, paths, "srcA", result));
+
+        if(result != AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED &&
+           result != AudioPath::Switch::ActivateResult::OK_PLAYER_SAME &&
+           result != AudioPath::Switch::ActivateResult::OK_UNCHANGED)
+            recovered = false;
+    }
+
+    std::sort(failure_ms.begin(), failure_ms.end());
+    std::sort(recovery_ms.begin(), recovery_ms.end());
+
+    printf("%-20s %8u %-15s %10.1f %10.1f %12.1f %12.1f%s\n",
+           name, deadline_ms, result_to_string(failure_result),
+           failure_ms[failure_ms.size() / 2], failure_ms.back(),
+           recovery_ms[recovery_ms.size() / 2], recovery_ms.back(),
+           recovered ? "" : " (not recovered)");
+}
+
+int main()
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_QUIET);
+
+    FakePeers::DelayedAnswers transport(
+        [] (const GObject *) { return PEER_LATENCY_MS; });
+    FakePeers::set_transport(&transport);
+
+    printf("%-20s %8s %-15s %10s %10s %12s %12s\n",
+           "scenario", "deadline", "result", "fail p50", "fail max",
+           "recover p50", "recover max");
+
+    run("no fault",          nullptr,                       0, 50);
+    run("player error",      "plB:Activate:error",          0, 50);
+    run("player vanished",   "plB:Activate:vanish",         0, 50);
+    run("player slow error", "plB:Activate:error:50",       0, 20);
+    run("source error",      "srcB:Selected:error",         0, 50);
+    run("deselect error",    "srcA:Deselected:error",       0, 50);
+    run("player timeout",    "plB:Activate:timeout:250",    0, 10);
+    run("player hangs",      "plB:Activate:timeout",      100, 20);
+    run("source hangs",      "srcB:Selected:timeout",     100, 20);
+    run("slow player",       "plB:Activate:delay:50",       0, 20);
+    run("too slow player",   "plB:Activate:delay:200",    100, 20);
+
+    AudioPath::FaultInjector::get_singleton().clear();
+
+    return 0;
+}
+
+/*!@}*/
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "audiopath.hh"
+
+/*!
+ * \addtogroup audiopath_benchmarks Benchmarks
+ * \ingroup audiopath
+ *
+ * Measure the cost of #AudioPath::Paths operations.
+ *
+ * For each registry size, players and audio sources are registered with
+ * dummy D-Bus proxies, all audio sources are looked up in random order, and
+ * the registry is enumerated in each #AudioPath::Paths::ForEach mode.
+ *
+ * Three quarters of the audio sources are connected to a registered player,
+ * the others refer to players which are never registered, and a quarter of
+ * the players have no audio sources. This way, each enumeration mode has
+ * something to report.
+ *
+ * Results are printed as CSV to stdout, one line per operation and size, so
+ * that they can be stored and compared against a baseline. Time and heap
+ * allocations are reported per operation; for enumeration, one operation is
+ * one registry entry (player or audio source), so that numbers for
+ * different sizes can be compared directly.
+ */
+/*!@{*/
+
+static size_t number_of_allocations;
+
+void *operator new(size_t size)
+{
+    ++number_of_allocations;
+
+    void *p = malloc(size != 0 ? size : 1);
+
+    if(p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace DBus
+{
+
+/* proxies are dummies */
+template<>
+Proxy<_tdbusaupathPlayer>::~Proxy() {}
+
+template<>
+Proxy<_tdbusaupathSource>::~Proxy() {}
+
+}
+
+static int dummy_proxy;
+
+using Clock = std::chrono::steady_clock;
+
+/*!
+ * Accumulated time and allocations of some operation.
+ */
+class Measurement
+{
+  private:
+    const char *const name_;
+    const char *const mode_;
+    double total_ns_;
+    size_t allocations_;
+    size_t ops_;
+
+    Clock::time_point started_;
+    size_t allocations_at_start_;
+
+  public:
+    Measurement(const Measurement &) = delete;
+    Measurement &operator=(const Measurement &) = delete;
+
+    explicit Measurement(const char *name, const char *mode = ""):
+        name_(name),
+        mode_(mode),
+        total_ns_(0.0),
+        allocations_(0),
+        ops_(0),
+        allocations_at_start_(0)
+    {}
+
+    void start()
+    {
+        allocations_at_start_ = number_of_allocations;
+        started_ = Clock::now();
+    }
+
+    void stop(size_t ops)
+    {
+        const auto stopped = Clock::now();
+        allocations_ += number_of_allocations - allocations_at_start_;
+        total_ns_ += std::chrono::duration<double, std::nano>(stopped - started_).count();
+        ops_ += ops;
+    }
+
+    void print(size_t size, size_t rounds) const
+    {
+        printf("%s,%s,%zu,%zu,%.1f,%.2f\n", name_, mode_, size, rounds,
+               total_ns_ / ops_, double(allocations_) / ops_);
+    }
+};
+
+/* keep the compiler from optimizing away the work */
+static volatile size_t sink;
+
+static std::vector<AudioPath::Player> mk_players(size_t n)
+{
+    std::vector<AudioPath::Player> players;
+    players.reserve(n);
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        const std::string id("bench_player_" + std::to_string(i));
+        players.emplace_back(
+            id.c_str(), "Some player name",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<_tdbusaupathPlayer *>(&dummy_proxy)));
+    }
+
+    return players;
+}
+
+static std::vector<AudioPath::Source> mk_sources(size_t n)
+{
+    std::vector<AudioPath::Source> sources;
+    sources.reserve(n);
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        const std::string id("bench_source_" + std::to_string(i));
+        const std::string player_id(i < n * 3 / 4
+                                    ? "bench_player_" + std::to_string(i)
+                                    : "bench_missing_player_" + std::to_string(i));
+        sources.emplace_back(
+            id.c_str(), "Some audio source name", player_id.c_str(),
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<_tdbusaupathSource *>(&dummy_proxy)));
+    }
+
+    return sources;
+}
+
+static void run(size_t n, size_t rounds)
+{
+    static const std::pair<AudioPath::Paths::ForEach, const char *> modes[] =
+    {
+        { AudioPath::Paths::ForEach::ANY,                 "any" },
+        { AudioPath::Paths::ForEach::COMPLETE_PATHS,      "complete_paths" },
+        { AudioPath::Paths::ForEach::INCOMPLETE_PATHS,    "incomplete_paths" },
+        { AudioPath::Paths::ForEach::UNCONNECTED_SOURCES, "unconnected_sources" },
+        { AudioPath::Paths::ForEach::UNCONNECTED_PLAYERS, "unconnected_players" },
+    };
+
+    Measurement add_player("add_player");
+    Measurement add_source("add_source");
+    Measurement lookup_path_id("lookup_path", "id");
+    Measurement lookup_path_string("lookup_path", "string");
+    std::deque<Measurement> for_each;
+
+    for(const auto &m : modes)
+        for_each.emplace_back("for_each", m.second);
+
+    /* intern all IDs before measuring anything */
+    mk_players(n);
+    mk_sources(n);
+
+    std::vector<AudioPath::ID> lookup_ids;
+    std::vector<std::string> lookup_strings;
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        lookup_strings.push_back("bench_source_" + std::to_string(i));
+        lookup_ids.push_back(AudioPath::IDTable::get_singleton().find(lookup_strings.back()));
+    }
+
+    std::mt19937 rng(n);
+    std::shuffle(lookup_ids.begin(), lookup_ids.end(), rng);
+    std::shuffle(lookup_strings.begin(), lookup_strings.end(), rng);
+
+    for(size_t r = 0; r < rounds; ++r)
+    {
+        auto players(mk_players(n));
+        auto sources(mk_sources(n));
+        AudioPath::Paths paths;
+
+        add_player.start();
+
+        for(auto &p : players)
+            paths.add_player(std::move(p));
+
+        add_player.stop(n);
+
+        add_source.start();
+
+        for(auto &s : sources)
+            paths.add_source(std::move(s));
+
+        add_source.stop(n);
+
+        size_t found = 0;
+
+        lookup_path_id.start();
+
+        for(const auto &id : lookup_ids)
+            found += paths.lookup_path(id).second != nullptr;
+
+        lookup_path_id.stop(n);
+
+        lookup_path_string.start();
+
+        for(const auto &id : lookup_strings)
+            found += paths.lookup_path(AudioPath::StringRef(id)).second != nullptr;
+
+        lookup_path_string.stop(n);
+
+        for(size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+        {
+            for_each[i].start();
+            paths.for_each([&found] (const AudioPath::Paths::Path &) { ++found; },
+                           modes[i].first);
+            for_each[i].stop(2 * n);
+        }
+
+        sink = found;
+    }
+
+    add_player.print(n, rounds);
+    add_source.print(n, rounds);
+    lookup_path_id.print(n, rounds);
+    lookup_path_string.print(n, rounds);
+
+    for(const auto &m : for_each)
+        m.print(n, rounds);
+}
+
+int main()
+{
+    static const size_t sizes[] = { 10, 100, 1000, 10000, 100000 };
+
+    printf("operation,mode,size,rounds,ns_per_op,allocs_per_op\n");
+
+    for(const size_t n : sizes)
+        run(n, n < 1000 ? 2000 : (n < 100000 ? 50 : 3));
+
+    return 0;
+}
+
+/*!@}*/
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <memory>
+#include <cstdio>
+
+#include "audiopathstorage.hh"
+
+/*!
+ * \addtogroup audiopath_benchmarks Benchmarks
+ * \ingroup audiopath
+ *
+ * Compare storage backends for the audio path registry.
+ *
+ * For each backend from #AudioPath::Storage and each registry size, the cost
+ * of inserting all components, of looking up each component in random order,
+ * and of enumerating all components is measured. Results are printed as
+ * nanoseconds per operation (per component for enumeration).
+ */
+/*!@{*/
+
+/*!
+ * Stand-in for #AudioPath::Player and #AudioPath::Source.
+ *
+ * Same layout as the real thing: an ID, a name, and a pointer to a D-Bus
+ * proxy allocated on the heap.
+ */
+struct Component
+{
+    const AudioPath::ID id_;
+    const std::string name_;
+    std::unique_ptr<int> dbus_proxy_;
+
+    Component(const Component &) = delete;
+    Component(Component &&) = default;
+    Component &operator=(const Component &) = delete;
+
+    explicit Component(AudioPath::ID id, std::string &&name):
+        id_(id),
+        name_(std::move(name)),
+        dbus_proxy_(new int(0))
+    {}
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_op(Clock::time_point start, Clock::time_point stop,
+                        size_t ops)
+{
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ops;
+}
+
+/* keep the compiler from optimizing away the work */
+static volatile size_t sink;
+
+template <template <typename> class StorageType>
+static void run(const char *name, const std::vector<AudioPath::ID> &ids,
+                size_t rounds)
+{
+    const size_t n = ids.size();
+    std::vector<AudioPath::ID> shuffled(ids);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(n));
+
+    double insert_ns = 0.0;
+    double lookup_ns = 0.0;
+    double enumerate_ns = 0.0;
+
+    for(size_t r = 0; r < rounds; ++r)
+    {
+        StorageType<Component> storage;
+
+        auto t0 = Clock::now();
+
+        for(const auto &id : ids)
+            storage.insert(Component(id, "Some component name"));
+
+        auto t1 = Clock::now();
+
+        size_t found = 0;
+
+        for(const auto &id : shuffled)
+            found += storage.find(id) != nullptr;
+
+        auto t2 = Clock::now();
+
+        size_t total = 0;
+        storage.for_each([&total] (const Component &c) { total += c.id_.get_handle(); });
+
+        auto t3 = Clock::now();
+
+        sink = found + total;
+
+        insert_ns += ns_per_op(t0, t1, n);
+        lookup_ns += ns_per_op(t1, t2, n);
+        enumerate_ns += ns_per_op(t2, t3, n);
+    }
+
+    printf("%-10s %8zu %12.1f %12.1f %12.1f\n", name, n,
+           insert_ns / rounds, lookup_ns / rounds, enumerate_ns / rounds);
+}
+
+int main()
+{
+    static const size_t sizes[] = { 10, 1000, 100000 };
+
+    printf("%-10s %8s %12s %12s %12s\n",
+           "backend", "size", "insert ns", "lookup ns", "enum ns");
+
+    for(const size_t n : sizes)
+    {
+        std::vector<AudioPath::ID> ids;
+        ids.reserve(n);
+
+        for(size_t i = 0; i < n; ++i)
+            ids.push_back(AudioPath::IDTable::get_singleton().intern(
+                                "bench_component_" + std::to_string(i)));
+
+        const size_t rounds = n < 1000 ? 10000 : (n < 100000 ? 100 : 5);
+
+        run<AudioPath::Storage::Map>("map", ids, rounds);
+        run<AudioPath::Storage::FlatVector>("flat", ids, rounds);
+        run<AudioPath::Storage::OpenHash>("hash", ids, rounds);
+    }
+
+    return 0;
+}
+
+/*!@}*/
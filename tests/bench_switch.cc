@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "audiopath.hh"
+#include "audiopathswitch.hh"
+#include "de_tahifi_audiopath.h"
+#include "fake_peers.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks Benchmarks
+ * \ingroup audiopath
+ *
+ * Measure audio path switching latency with slow peers.
+ *
+ * The D-Bus methods of players and audio sources are replaced by fakes which
+ * answer from the GLib main loop after a delay drawn from a per-peer latency
+ * distribution.
+ *
+ * For the fixed scenarios, the switch alternates between two audio sources
+ * on two different players, and the average time from request to completion
+ * is printed next to the time a strictly serial switch would take.
+ *
+ * For the randomized scenarios, bursts of audio source requests, path
+ * releases, and deferred activations completed by the appliance becoming
+ * ready are thrown at the switch. Latency percentiles of all requests and
+ * the overall throughput are printed. The random sequence is the same for
+ * each run, so that numbers from before and after a change to the switch
+ * can be compared.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+static std::mt19937 rng(42);
+
+/*!
+ * Distribution of answer times of a peer.
+ *
+ * Most answers take between \c min_ms_ and \c max_ms_ milliseconds (uniformly
+ * distributed), but \c slow_permille_ out of 1000 answers take \c slow_ms_
+ * milliseconds to model hiccups.
+ */
+struct Latency
+{
+    unsigned int min_ms_;
+    unsigned int max_ms_;
+    unsigned int slow_ms_;
+    unsigned int slow_permille_;
+
+    static Latency fixed(unsigned int ms) { return Latency{ms, ms, 0, 0}; }
+
+    unsigned int sample() const
+    {
+        if(slow_permille_ > 0 &&
+           std::uniform_int_distribution<unsigned int>(0, 999)(rng) < slow_permille_)
+            return slow_ms_;
+
+        return std::uniform_int_distribution<unsigned int>(min_ms_, max_ms_)(rng);
+    }
+};
+
+/*!
+ * Fake peer, its address is used as D-Bus proxy.
+ */
+struct Peer
+{
+    Latency latency_;
+};
+
+namespace DBus
+{
+
+/* peers are owned by the benchmark */
+template<>
+Proxy<_tdbusaupathPlayer>::~Proxy() {}
+
+template<>
+Proxy<_tdbusaupathSource>::~Proxy() {}
+
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double switch_once(AudioPath::Switch &sw, const AudioPath::Paths &paths,
+                          const char *source_id)
+{
+    bool done = false;
+    const auto start = Clock::now();
+
+    sw.activate_source(paths, source_id, true,
+                       [&done]
+                       (AudioPath::Switch::ActivateResult,
+                        const AudioPath::ID *,
+                        AudioPath::Switch::DeselectedAudioSourceResult)
+                       {
+                           done = true;
+                       });
+
+    while(!done)
+        g_main_context_iteration(nullptr, TRUE);
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void run(const char *name, unsigned int source_latency_ms,
+                unsigned int player_latency_ms, size_t rounds)
+{
+    Peer sources[] = { { Latency::fixed(source_latency_ms) },
+                       { Latency::fixed(source_latency_ms) } };
+    Peer players[] = { { Latency::fixed(player_latency_ms) },
+                       { Latency::fixed(player_latency_ms) } };
+
+    AudioPath::Paths paths;
+
+    paths.add_source(AudioPath::Source(
+            "srcA", "Source A", "plA",
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<tdbusaupathSource *>(&sources[0]))));
+    paths.add_source(AudioPath::Source(
+            "srcB", "Source B", "plB",
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<tdbusaupathSource *>(&sources[1]))));
+    paths.add_player(AudioPath::Player(
+            "plA", "Player A",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<tdbusaupathPlayer *>(&players[0]))));
+    paths.add_player(AudioPath::Player(
+            "plB", "Player B",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<tdbusaupathPlayer *>(&players[1]))));
+
+    AudioPath::Switch sw;
+
+    /* initial activation is not measured, nothing to deselect yet */
+    switch_once(sw, paths, "srcA");
+
+    double total_ms = 0.0;
+
+    for(size_t r = 0; r < rounds; ++r)
+        total_ms += switch_once(sw, paths, (r & 1) == 0 ? "srcB" : "srcA");
+
+    /* deselect, deactivate, activate, select */
+    const unsigned int serial_ms =
+        2 * source_latency_ms + 2 * player_latency_ms;
+
+    printf("%-14s %10u %10u %10u %12.1f\n", name,
+           source_latency_ms, player_latency_ms, serial_ms, total_ms / rounds);
+}
+
+/*!
+ * Random workload on a set of fake players and audio sources.
+ */
+class RandomWorkload
+{
+  private:
+    AudioPath::Paths paths_;
+    AudioPath::Switch sw_;
+    std::vector<Peer> sources_;
+    std::vector<Peer> players_;
+    std::vector<std::string> source_ids_;
+
+    std::vector<double> latencies_ms_;
+    size_t requests_in_flight_;
+
+  public:
+    RandomWorkload(const RandomWorkload &) = delete;
+    RandomWorkload &operator=(const RandomWorkload &) = delete;
+
+    explicit RandomWorkload(size_t number_of_players, size_t sources_per_player,
+                            const Latency &source_latency,
+                            const Latency &player_latency):
+        sources_(number_of_players * sources_per_player, Peer{source_latency}),
+        players_(number_of_players, Peer{player_latency}),
+        requests_in_flight_(0)
+    {
+        for(size_t p = 0; p < number_of_players; ++p)
+        {
+            const std::string player_id("pl" + std::to_string(p));
+
+            paths_.add_player(AudioPath::Player(
+                player_id.c_str(), "Player",
+                std::make_unique<AudioPath::Player::PType>(
+                    reinterpret_cast<tdbusaupathPlayer *>(&players_[p]))));
+
+            for(size_t s = 0; s < sources_per_player; ++s)
+            {
+                const size_t i = p * sources_per_player + s;
+                source_ids_.push_back("src" + std::to_string(i));
+
+                paths_.add_source(AudioPath::Source(
+                    source_ids_.back().c_str(), "Source", player_id.c_str(),
+                    std::make_unique<AudioPath::Source::PType>(
+                        reinterpret_cast<tdbusaupathSource *>(&sources_[i]))));
+            }
+        }
+    }
+
+    /*!
+     * Issue bursts of random requests, wait for each burst to complete.
+     *
+     * \returns
+     *     Wall clock time in milliseconds.
+     */
+    double run(size_t number_of_requests)
+    {
+        latencies_ms_.clear();
+        latencies_ms_.reserve(number_of_requests);
+
+        const auto start = Clock::now();
+
+        for(size_t issued = 0; issued < number_of_requests;)
+        {
+            const size_t burst =
+                std::uniform_int_distribution<size_t>(1, 4)(rng);
+
+            for(size_t i = 0; i < burst && issued < number_of_requests; ++i, ++issued)
+                issue_random_request();
+
+            while(requests_in_flight_ > 0)
+                g_main_context_iteration(nullptr, TRUE);
+        }
+
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /*!
+     * Return percentile of request latencies in milliseconds.
+     */
+    double get_percentile(unsigned int percent)
+    {
+        if(latencies_ms_.empty())
+            return 0.0;
+
+        const size_t rank =
+            std::min(latencies_ms_.size() - 1,
+                     (latencies_ms_.size() * percent + 99) / 100 - (percent > 0 ? 1 : 0));
+        std::nth_element(latencies_ms_.begin(), latencies_ms_.begin() + rank,
+                         latencies_ms_.end());
+        return latencies_ms_[rank];
+    }
+
+  private:
+    template <typename... Args>
+    std::function<void(Args...)> mk_done_fn()
+    {
+        ++requests_in_flight_;
+
+        return [this, start = Clock::now()] (Args...)
+        {
+            latencies_ms_.push_back(
+                std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            --requests_in_flight_;
+        };
+    }
+
+    void issue_random_request()
+    {
+        const auto &source_id(source_ids_[std::uniform_int_distribution<size_t>(
+                                            0, source_ids_.size() - 1)(rng)]);
+        const unsigned int what = std::uniform_int_distribution<unsigned int>(0, 99)(rng);
+
+        if(what < 70)
+            sw_.activate_source(paths_, source_id.c_str(), true,
+                                mk_done_fn<AudioPath::Switch::ActivateResult,
+                                           const AudioPath::ID *,
+                                           AudioPath::Switch::DeselectedAudioSourceResult>());
+        else if(what < 80)
+            sw_.release_path(paths_, what < 75,
+                             mk_done_fn<AudioPath::Switch::ReleaseResult,
+                                        const AudioPath::ID *,
+                                        AudioPath::Switch::DeselectedAudioSourceResult>());
+        else
+        {
+            /* appliance not ready, then ready */
+            sw_.activate_source(paths_, source_id.c_str(), false,
+                                mk_done_fn<AudioPath::Switch::ActivateResult,
+                                           const AudioPath::ID *,
+                                           AudioPath::Switch::DeselectedAudioSourceResult>());
+            sw_.complete_pending_source_activation(
+                paths_,
+                mk_done_fn<AudioPath::Switch::ActivateResult,
+                           const AudioPath::ID &>());
+        }
+    }
+};
+
+static void run_random(const char *name, const Latency &source_latency,
+                       const Latency &player_latency, size_t requests)
+{
+    RandomWorkload workload(4, 3, source_latency, player_latency);
+    const double wall_ms = workload.run(requests);
+
+    printf("%-14s %8zu %8.1f %8.1f %8.1f %8.1f %10.1f\n", name, requests,
+           workload.get_percentile(50), workload.get_percentile(95),
+           workload.get_percentile(99), workload.get_percentile(100),
+           requests * 1000.0 / wall_ms);
+}
+
+int main()
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_NORMAL);
+
+    FakePeers::DelayedAnswers transport(
+        [] (const GObject *proxy)
+        {
+            return reinterpret_cast<const Peer *>(proxy)->latency_.sample();
+        });
+    FakePeers::set_transport(&transport);
+
+    printf("%-14s %10s %10s %10s %12s\n",
+           "scenario", "source ms", "player ms", "serial ms", "measured ms");
+
+    run("fast peers", 2, 2, 50);
+    run("slow sources", 40, 10, 20);
+    run("slow players", 10, 40, 20);
+    run("slow peers", 40, 40, 20);
+
+    printf("\n%-14s %8s %8s %8s %8s %8s %10s\n",
+           "random", "requests", "p50 ms", "p95 ms", "p99 ms", "max ms", "req/s");
+
+    run_random("fast peers", Latency{0, 2, 0, 0}, Latency{0, 2, 0, 0}, 2000);
+    run_random("typical peers", Latency{1, 10, 0, 0}, Latency{2, 20, 0, 0}, 1000);
+    run_random("hiccups", Latency{1, 10, 200, 10}, Latency{2, 20, 300, 10}, 1000);
+
+    return 0;
+}
+
+/*!@}*/
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "fake_peers.hh"
+#include "de_tahifi_audiopath.h"
+
+static FakePeers::Transport *transport;
+
+void FakePeers::set_transport(FakePeers::Transport *t)
+{
+    transport = t;
+}
+
+struct PendingAnswer
+{
+    GObject *source_object_;
+    GAsyncReadyCallback callback_;
+    gpointer user_data_;
+};
+
+static gboolean send_answer(gpointer user_data)
+{
+    auto *answer = static_cast<PendingAnswer *>(user_data);
+    answer->callback_(answer->source_object_,
+                      reinterpret_cast<GAsyncResult *>(answer),
+                      answer->user_data_);
+    delete answer;
+    return G_SOURCE_REMOVE;
+}
+
+void FakePeers::DelayedAnswers::call(GObject *proxy, GCancellable *,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    const unsigned int latency_ms = get_latency_ms_(proxy);
+    auto *answer = new PendingAnswer{proxy, callback, user_data};
+
+    if(latency_ms > 0)
+        g_timeout_add(latency_ms, send_answer, answer);
+    else
+        g_idle_add(send_answer, answer);
+}
+
+gboolean FakePeers::DelayedAnswers::finish(GAsyncResult *, GError **)
+{
+    return TRUE;
+}
+
+template <typename ProxyType>
+static void call_peer(ProxyType *proxy, GCancellable *cancellable,
+                      GAsyncReadyCallback callback, gpointer user_data)
+{
+    transport->call(reinterpret_cast<GObject *>(proxy), cancellable,
+                    callback, user_data);
+}
+
+void tdbus_aupath_player_call_activate(tdbusaupathPlayer *proxy, GVariant *, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    call_peer(proxy, cancellable, callback, user_data);
+}
+
+gboolean tdbus_aupath_player_call_activate_finish(tdbusaupathPlayer *, GAsyncResult *res, GError **error)
+{
+    return transport->finish(res, error);
+}
+
+void tdbus_aupath_player_call_deactivate(tdbusaupathPlayer *proxy, GVariant *, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    call_peer(proxy, cancellable, callback, user_data);
+}
+
+gboolean tdbus_aupath_player_call_deactivate_finish(tdbusaupathPlayer *, GAsyncResult *res, GError **error)
+{
+    return transport->finish(res, error);
+}
+
+void tdbus_aupath_source_call_selected_on_hold(tdbusaupathSource *proxy, const gchar *, GVariant *, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    call_peer(proxy, cancellable, callback, user_data);
+}
+
+gboolean tdbus_aupath_source_call_selected_on_hold_finish(tdbusaupathSource *, GAsyncResult *res, GError **error)
+{
+    return transport->finish(res, error);
+}
+
+void tdbus_aupath_source_call_selected(tdbusaupathSource *proxy, const gchar *, GVariant *, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    call_peer(proxy, cancellable, callback, user_data);
+}
+
+gboolean tdbus_aupath_source_call_selected_finish(tdbusaupathSource *, GAsyncResult *res, GError **error)
+{
+    return transport->finish(res, error);
+}
+
+void tdbus_aupath_source_call_deselected(tdbusaupathSource *proxy, const gchar *, GVariant *, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    call_peer(proxy, cancellable, callback, user_data);
+}
+
+gboolean tdbus_aupath_source_call_deselected_finish(tdbusaupathSource *, GAsyncResult *res, GError **error)
+{
+    return transport->finish(res, error);
+}
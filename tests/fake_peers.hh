@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef FAKE_PEERS_HH
+#define FAKE_PEERS_HH
+
+#include <functional>
+
+#include <gio/gio.h>
+
+/*!
+ * \addtogroup audiopath_benchmarks
+ */
+/*!@{*/
+
+/*!
+ * Fake players and audio sources for programs which drive an
+ * #AudioPath::Switch without D-Bus.
+ *
+ * The \c tdbus_aupath_player_call_*() and \c tdbus_aupath_source_call_*()
+ * functions defined in \c fake_peers.cc replace the generated D-Bus code
+ * and forward all calls to the transport set by
+ * #FakePeers::set_transport(). The address of a fake peer is used as its
+ * D-Bus proxy, so the transport is free to choose what a peer looks like.
+ */
+namespace FakePeers
+{
+
+class Transport
+{
+  protected:
+    explicit Transport() {}
+
+  public:
+    Transport(const Transport &) = delete;
+    Transport &operator=(const Transport &) = delete;
+
+    virtual ~Transport() {}
+
+    /*!
+     * Start a method call of a fake peer.
+     *
+     * The transport must call \p callback with \p proxy as source object and
+     * \p user_data exactly once, passing a \c GAsyncResult which is evaluated
+     * by #FakePeers::Transport::finish().
+     */
+    virtual void call(GObject *proxy, GCancellable *cancellable,
+                      GAsyncReadyCallback callback, gpointer user_data) = 0;
+
+    /*!
+     * Evaluate the answer of a fake peer.
+     */
+    virtual gboolean finish(GAsyncResult *res, GError **error) = 0;
+};
+
+/*!
+ * Fake peers which always succeed and answer from the GLib main loop.
+ *
+ * Each answer is sent after the number of milliseconds returned by the
+ * latency function for the called peer, or from an idle source if it
+ * returns 0. Cancellation is not honored.
+ */
+class DelayedAnswers: public Transport
+{
+  public:
+    using LatencyFn = std::function<unsigned int(const GObject *proxy)>;
+
+  private:
+    const LatencyFn get_latency_ms_;
+
+  public:
+    explicit DelayedAnswers(LatencyFn &&get_latency_ms):
+        get_latency_ms_(std::move(get_latency_ms))
+    {}
+
+    void call(GObject *proxy, GCancellable *cancellable,
+              GAsyncReadyCallback callback, gpointer user_data) final override;
+    gboolean finish(GAsyncResult *res, GError **error) final override;
+};
+
+/*!
+ * Set transport for all subsequent calls of fake peers.
+ *
+ * The transport is not owned.
+ */
+void set_transport(Transport *transport);
+
+}
+
+/*!@}*/
+
+#endif /* !FAKE_PEERS_HH */
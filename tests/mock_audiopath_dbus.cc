@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -30,37 +30,57 @@
 MockAudiopathDBus::Mock *MockAudiopathDBus::singleton = nullptr;
 
 
-gboolean tdbus_aupath_player_call_activate_sync(tdbusaupathPlayer *proxy, GVariant *arg_request_data, GCancellable *cancellable, GError **error)
+void tdbus_aupath_player_call_activate(tdbusaupathPlayer *proxy, GVariant *arg_request_data, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return
-        MockAudiopathDBus::singleton->check_next<MockAudiopathDBus::PlayerActivateSync>(
-            proxy, arg_request_data, cancellable, error);
+    MockAudiopathDBus::singleton->call_async<MockAudiopathDBus::PlayerActivate>(
+        proxy, cancellable, callback, user_data, arg_request_data);
 }
 
-gboolean tdbus_aupath_player_call_deactivate_sync(tdbusaupathPlayer *proxy, GVariant *arg_request_data, GCancellable *cancellable, GError **error)
+gboolean tdbus_aupath_player_call_activate_finish(tdbusaupathPlayer *proxy, GAsyncResult *res, GError **error)
 {
-    return
-        MockAudiopathDBus::singleton->check_next<MockAudiopathDBus::PlayerDeactivateSync>(
-            proxy, arg_request_data, cancellable, error);
+    return MockAudiopathDBus::singleton->finish_call(res, error);
 }
 
-gboolean tdbus_aupath_source_call_selected_on_hold_sync(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GError **error)
+void tdbus_aupath_player_call_deactivate(tdbusaupathPlayer *proxy, GVariant *arg_request_data, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return
-        MockAudiopathDBus::singleton->check_next<MockAudiopathDBus::SourceSelectedOnHoldSync>(
-            proxy, arg_source_id, arg_request_data, cancellable, error);
+    MockAudiopathDBus::singleton->call_async<MockAudiopathDBus::PlayerDeactivate>(
+        proxy, cancellable, callback, user_data, arg_request_data);
 }
 
-gboolean tdbus_aupath_source_call_selected_sync(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GError **error)
+gboolean tdbus_aupath_player_call_deactivate_finish(tdbusaupathPlayer *proxy, GAsyncResult *res, GError **error)
 {
-    return
-        MockAudiopathDBus::singleton->check_next<MockAudiopathDBus::SourceSelectedSync>(
-            proxy, arg_source_id, arg_request_data, cancellable, error);
+    return MockAudiopathDBus::singleton->finish_call(res, error);
 }
 
-gboolean tdbus_aupath_source_call_deselected_sync(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GError **error)
+void tdbus_aupath_source_call_selected_on_hold(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return
-        MockAudiopathDBus::singleton->check_next<MockAudiopathDBus::SourceDeselectedSync>(
-            proxy, arg_source_id, arg_request_data, cancellable, error);
+    MockAudiopathDBus::singleton->call_async<MockAudiopathDBus::SourceSelectedOnHold>(
+        proxy, cancellable, callback, user_data, arg_source_id, arg_request_data);
+}
+
+gboolean tdbus_aupath_source_call_selected_on_hold_finish(tdbusaupathSource *proxy, GAsyncResult *res, GError **error)
+{
+    return MockAudiopathDBus::singleton->finish_call(res, error);
+}
+
+void tdbus_aupath_source_call_selected(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    MockAudiopathDBus::singleton->call_async<MockAudiopathDBus::SourceSelected>(
+        proxy, cancellable, callback, user_data, arg_source_id, arg_request_data);
+}
+
+gboolean tdbus_aupath_source_call_selected_finish(tdbusaupathSource *proxy, GAsyncResult *res, GError **error)
+{
+    return MockAudiopathDBus::singleton->finish_call(res, error);
+}
+
+void tdbus_aupath_source_call_deselected(tdbusaupathSource *proxy, const gchar *arg_source_id, GVariant *arg_request_data, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    MockAudiopathDBus::singleton->call_async<MockAudiopathDBus::SourceDeselected>(
+        proxy, cancellable, callback, user_data, arg_source_id, arg_request_data);
+}
+
+gboolean tdbus_aupath_source_call_deselected_finish(tdbusaupathSource *proxy, GAsyncResult *res, GError **error)
+{
+    return MockAudiopathDBus::singleton->finish_call(res, error);
 }
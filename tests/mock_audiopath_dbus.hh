@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020, 2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020, 2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -26,6 +26,8 @@
 #include "gvariantwrapper.hh"
 #include "mock_expectation.hh"
 
+#include <deque>
+
 namespace MockAudiopathDBus
 {
 
@@ -58,6 +60,24 @@ class Mock
   private:
     MockExpectationsTemplate<Expectation> expectations_;
 
+    /*!
+     * Asynchronous D-Bus method call which has not been answered yet.
+     *
+     * A pointer to such an object is passed as \c GAsyncResult to the
+     * completion callback, and it is evaluated by the \c _finish() function.
+     */
+    struct AsyncCall
+    {
+        GObject *source_object_;
+        GAsyncReadyCallback callback_;
+        gpointer user_data_;
+        gboolean retval_;
+        GError *error_;
+        GCancellable *cancellable_;
+    };
+
+    std::deque<AsyncCall> calls_in_flight_;
+
   public:
     Mock(const Mock &) = delete;
     Mock &operator=(const Mock &) = delete;
@@ -91,7 +111,11 @@ class Mock
     template <typename T>
     void allow() { expectations_.allow<T>(); }
 
-    void done() const { expectations_.done(); }
+    void done() const
+    {
+        expectations_.done();
+        CHECK(calls_in_flight_.empty());
+    }
 
     template <typename T, typename ... Args>
     auto check_next(Args ... args) -> decltype(std::declval<T>().check(args...))
@@ -104,6 +128,89 @@ class Mock
     {
         return expectations_.next<T>(caller);
     }
+
+    /*!
+     * Check asynchronous call against expectation, answer it later.
+     *
+     * The answer is determined right away, but the completion callback is
+     * not called before #MockAudiopathDBus::Mock::complete_next_call() is
+     * called.
+     */
+    template <typename T, typename ProxyType, typename ... Args>
+    void call_async(ProxyType *proxy, GCancellable *cancellable,
+                    GAsyncReadyCallback callback, gpointer user_data,
+                    Args ... args)
+    {
+        GError *error = nullptr;
+        const gboolean retval =
+            check_next<T>(proxy, args..., nullptr, &error);
+
+        if(cancellable != nullptr)
+            g_object_ref(cancellable);
+
+        calls_in_flight_.push_back({reinterpret_cast<GObject *>(proxy),
+                                    callback, user_data, retval, error,
+                                    cancellable});
+    }
+
+    gboolean finish_call(GAsyncResult *res, GError **error)
+    {
+        auto *call = reinterpret_cast<AsyncCall *>(res);
+        REQUIRE(call != nullptr);
+
+        if(error != nullptr)
+        {
+            *error = call->error_;
+            call->error_ = nullptr;
+        }
+
+        return call->retval_;
+    }
+
+    size_t get_number_of_calls_in_flight() const { return calls_in_flight_.size(); }
+
+    /*!
+     * Answer the oldest asynchronous call still in flight.
+     *
+     * In case the call has been canceled by the caller, the expected answer
+     * is replaced by a cancellation error.
+     */
+    void complete_next_call()
+    {
+        REQUIRE_FALSE(calls_in_flight_.empty());
+
+        AsyncCall call(calls_in_flight_.front());
+        calls_in_flight_.pop_front();
+
+        if(g_cancellable_is_cancelled(call.cancellable_))
+        {
+            if(call.error_ != nullptr)
+                g_error_free(call.error_);
+
+            call.retval_ = FALSE;
+            call.error_ = g_error_new(G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                      "Operation was cancelled");
+        }
+
+        call.callback_(call.source_object_,
+                       reinterpret_cast<GAsyncResult *>(&call),
+                       call.user_data_);
+
+        if(call.error_ != nullptr)
+            g_error_free(call.error_);
+
+        if(call.cancellable_ != nullptr)
+            g_object_unref(call.cancellable_);
+    }
+
+    /*!
+     * Answer all calls, including those started while answering.
+     */
+    void complete_all_calls()
+    {
+        while(!calls_in_flight_.empty())
+            complete_next_call();
+    }
 };
 
 
@@ -164,19 +271,19 @@ class PlayerCall: public Expectation
     }
 };
 
-class PlayerActivateSync: public PlayerCall
+class PlayerActivate: public PlayerCall
 {
   public:
-    explicit PlayerActivateSync(gboolean retval, tdbusaupathPlayer *object):
-        PlayerActivateSync(retval, object, GVariantWrapper())
+    explicit PlayerActivate(gboolean retval, tdbusaupathPlayer *object):
+        PlayerActivate(retval, object, GVariantWrapper())
     {}
 
-    explicit PlayerActivateSync(gboolean retval, tdbusaupathPlayer *object,
-                                GVariantWrapper &&request_data):
+    explicit PlayerActivate(gboolean retval, tdbusaupathPlayer *object,
+                            GVariantWrapper &&request_data):
         PlayerCall(retval, object, std::move(request_data))
     {}
 
-    virtual ~PlayerActivateSync() = default;
+    virtual ~PlayerActivate() = default;
 
     bool check(tdbusaupathPlayer *proxy, GVariant *request_data,
                GCancellable *cancellable, GError **error) const
@@ -197,19 +304,19 @@ class PlayerActivateSync: public PlayerCall
     }
 };
 
-class PlayerDeactivateSync: public PlayerCall
+class PlayerDeactivate: public PlayerCall
 {
   public:
-    explicit PlayerDeactivateSync(gboolean retval, tdbusaupathPlayer *object):
-        PlayerDeactivateSync(retval, object, GVariantWrapper())
+    explicit PlayerDeactivate(gboolean retval, tdbusaupathPlayer *object):
+        PlayerDeactivate(retval, object, GVariantWrapper())
     {}
 
-    explicit PlayerDeactivateSync(gboolean retval, tdbusaupathPlayer *object,
-                                  GVariantWrapper &&request_data):
+    explicit PlayerDeactivate(gboolean retval, tdbusaupathPlayer *object,
+                              GVariantWrapper &&request_data):
         PlayerCall(retval, object, std::move(request_data))
     {}
 
-    virtual ~PlayerDeactivateSync() = default;
+    virtual ~PlayerDeactivate() = default;
 
     bool check(tdbusaupathPlayer *proxy, GVariant *request_data,
                GCancellable *cancellable, GError **error) const
@@ -260,21 +367,21 @@ class SourceCall: public Expectation
     }
 };
 
-class SourceSelectedSync: public SourceCall
+class SourceSelected: public SourceCall
 {
   public:
-    explicit SourceSelectedSync(gboolean retval, tdbusaupathSource *object,
-                                std::string &&source_id):
-        SourceSelectedSync(retval, object, std::move(source_id), GVariantWrapper())
+    explicit SourceSelected(gboolean retval, tdbusaupathSource *object,
+                            std::string &&source_id):
+        SourceSelected(retval, object, std::move(source_id), GVariantWrapper())
     {}
 
-    explicit SourceSelectedSync(gboolean retval, tdbusaupathSource *object,
-                                std::string &&source_id,
-                                GVariantWrapper &&request_data):
+    explicit SourceSelected(gboolean retval, tdbusaupathSource *object,
+                            std::string &&source_id,
+                            GVariantWrapper &&request_data):
         SourceCall(retval, object, std::move(source_id), std::move(request_data))
     {}
 
-    virtual ~SourceSelectedSync() = default;
+    virtual ~SourceSelected() = default;
 
     bool check(tdbusaupathSource *proxy, const char *source_id,
                GVariant *request_data, GCancellable *cancellable,
@@ -296,22 +403,22 @@ class SourceSelectedSync: public SourceCall
     }
 };
 
-class SourceSelectedOnHoldSync: public SourceCall
+class SourceSelectedOnHold: public SourceCall
 {
   public:
-    explicit SourceSelectedOnHoldSync(gboolean retval, tdbusaupathSource *object,
-                                      std::string &&source_id):
-        SourceSelectedOnHoldSync(retval, object, std::move(source_id),
-                                 GVariantWrapper())
+    explicit SourceSelectedOnHold(gboolean retval, tdbusaupathSource *object,
+                                  std::string &&source_id):
+        SourceSelectedOnHold(retval, object, std::move(source_id),
+                             GVariantWrapper())
     {}
 
-    explicit SourceSelectedOnHoldSync(gboolean retval, tdbusaupathSource *object,
-                                      std::string &&source_id,
-                                      GVariantWrapper &&request_data):
+    explicit SourceSelectedOnHold(gboolean retval, tdbusaupathSource *object,
+                                  std::string &&source_id,
+                                  GVariantWrapper &&request_data):
         SourceCall(retval, object, std::move(source_id), std::move(request_data))
     {}
 
-    virtual ~SourceSelectedOnHoldSync() = default;
+    virtual ~SourceSelectedOnHold() = default;
 
     bool check(tdbusaupathSource *proxy, const char *source_id,
                GVariant *request_data, GCancellable *cancellable,
@@ -333,21 +440,21 @@ class SourceSelectedOnHoldSync: public SourceCall
     }
 };
 
-class SourceDeselectedSync: public SourceCall
+class SourceDeselected: public SourceCall
 {
   public:
-    explicit SourceDeselectedSync(gboolean retval, tdbusaupathSource *object,
-                                  std::string &&source_id):
-        SourceDeselectedSync(retval, object, std::move(source_id), GVariantWrapper())
+    explicit SourceDeselected(gboolean retval, tdbusaupathSource *object,
+                              std::string &&source_id):
+        SourceDeselected(retval, object, std::move(source_id), GVariantWrapper())
     {}
 
-    explicit SourceDeselectedSync(gboolean retval, tdbusaupathSource *object,
-                                  std::string &&source_id,
-                                  GVariantWrapper &&request_data):
+    explicit SourceDeselected(gboolean retval, tdbusaupathSource *object,
+                              std::string &&source_id,
+                              GVariantWrapper &&request_data):
         SourceCall(retval, object, std::move(source_id), std::move(request_data))
     {}
 
-    virtual ~SourceDeselectedSync() = default;
+    virtual ~SourceDeselected() = default;
 
     bool check(tdbusaupathSource *proxy, const char *source_id,
                GVariant *request_data, GCancellable *cancellable,
@@ -0,0 +1,521 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <malloc.h>
+
+#include <glib.h>
+
+#include "audiopath.hh"
+#include "audiopathswitch.hh"
+#include "de_tahifi_audiopath.h"
+#include "fake_peers.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks
+ *
+ * Soak test: look for slow drift of memory usage and latency.
+ *
+ * Millions of random operations are thrown at an #AudioPath::Switch:
+ * audio source activations and path releases with request data, deferred
+ * activations which are completed or canceled, and re-registrations of
+ * players and audio sources which replace the D-Bus proxies of existing
+ * registry entries (see #AudioPath::Player::take_proxy_from()).
+ *
+ * The fake players and audio sources answer from the GLib main loop right
+ * away. Each registration allocates a new fake peer which is freed along
+ * with its proxy, so that the number of live fake peers must always match
+ * the number of registered players and audio sources; any difference is a
+ * leaked or prematurely destroyed proxy.
+ *
+ * The run is split into windows of equal size. At the end of each window,
+ * RSS, heap usage and fragmentation as reported by \c mallinfo(), and the
+ * latency percentiles within that window are printed. The first window is
+ * considered warm-up; the second one is the baseline. The test fails if the
+ * last window exceeds the baseline by more than the configured thresholds.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+static std::mt19937 rng(42);
+
+static size_t number_of_live_peers;
+
+/*!
+ * Fake peer, its address is used as D-Bus proxy.
+ */
+struct Peer
+{
+    Peer(const Peer &) = delete;
+    Peer &operator=(const Peer &) = delete;
+
+    explicit Peer() { ++number_of_live_peers; }
+    ~Peer() { --number_of_live_peers; }
+};
+
+namespace DBus
+{
+
+/* each proxy owns its fake peer */
+template<>
+Proxy<_tdbusaupathPlayer>::~Proxy()
+{
+    delete reinterpret_cast<Peer *>(proxy_);
+}
+
+template<>
+Proxy<_tdbusaupathSource>::~Proxy()
+{
+    delete reinterpret_cast<Peer *>(proxy_);
+}
+
+}
+
+using Clock = std::chrono::steady_clock;
+
+/*!
+ * Memory usage of this process.
+ */
+struct MemoryUsage
+{
+    size_t rss_kib_;
+    size_t heap_in_use_kib_;
+    size_t heap_free_kib_;
+
+    static MemoryUsage sample()
+    {
+        MemoryUsage m{0, 0, 0};
+
+        FILE *f = fopen("/proc/self/statm", "r");
+
+        if(f != nullptr)
+        {
+            unsigned long size;
+            unsigned long resident;
+
+            if(fscanf(f, "%lu %lu", &size, &resident) == 2)
+                m.rss_kib_ = resident * (sysconf(_SC_PAGESIZE) / 1024);
+
+            fclose(f);
+        }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        const struct mallinfo2 mi = mallinfo2();
+#elif defined(__GLIBC__)
+        const struct mallinfo mi = mallinfo();
+#endif
+
+#if defined(__GLIBC__)
+        m.heap_in_use_kib_ = (mi.uordblks + mi.hblkhd) / 1024;
+        m.heap_free_kib_ = mi.fordblks / 1024;
+#endif
+
+        return m;
+    }
+
+    /*!
+     * Free heap memory in percent of all heap memory held by the allocator.
+     */
+    double get_fragmentation() const
+    {
+        const size_t total = heap_in_use_kib_ + heap_free_kib_;
+        return total > 0 ? 100.0 * heap_free_kib_ / total : 0.0;
+    }
+};
+
+struct Thresholds
+{
+    size_t max_rss_growth_kib_;
+    size_t max_heap_growth_kib_;
+    double max_fragmentation_percent_;
+    double max_latency_growth_;
+};
+
+/*!
+ * Random workload on a set of fake players and audio sources.
+ */
+class Soak
+{
+  private:
+    AudioPath::Paths paths_;
+    AudioPath::Switch sw_;
+    const size_t number_of_players_;
+    const size_t sources_per_player_;
+    std::vector<std::string> source_ids_;
+
+    AudioPath::LatencyHistogram latencies_;
+    size_t requests_in_flight_;
+    size_t registrations_;
+
+  public:
+    Soak(const Soak &) = delete;
+    Soak &operator=(const Soak &) = delete;
+
+    explicit Soak(size_t number_of_players, size_t sources_per_player):
+        number_of_players_(number_of_players),
+        sources_per_player_(sources_per_player),
+        requests_in_flight_(0),
+        registrations_(0)
+    {
+        for(size_t p = 0; p < number_of_players_; ++p)
+        {
+            register_player(p);
+
+            for(size_t s = 0; s < sources_per_player_; ++s)
+            {
+                source_ids_.push_back(
+                    "src" + std::to_string(p * sources_per_player_ + s));
+                register_source(p * sources_per_player_ + s);
+            }
+        }
+    }
+
+    size_t get_number_of_peers() const { return source_ids_.size() + number_of_players_; }
+    size_t get_number_of_registrations() const { return registrations_; }
+    const AudioPath::LatencyHistogram &get_latencies() const { return latencies_; }
+
+    void run(size_t number_of_operations)
+    {
+        latencies_.reset();
+
+        for(size_t i = 0; i < number_of_operations; ++i)
+        {
+            issue_random_operation();
+
+            while(requests_in_flight_ > 0)
+                g_main_context_iteration(nullptr, TRUE);
+        }
+
+        /* drain idle sources left over from completed operations */
+        while(g_main_context_iteration(nullptr, FALSE))
+            ;
+    }
+
+  private:
+    void register_player(size_t p)
+    {
+        const std::string player_id("pl" + std::to_string(p));
+
+        paths_.add_player(AudioPath::Player(
+            player_id.c_str(), "Player",
+            std::make_unique<AudioPath::Player::PType>(
+                reinterpret_cast<tdbusaupathPlayer *>(new Peer))));
+        ++registrations_;
+    }
+
+    void register_source(size_t i)
+    {
+        const std::string player_id("pl" + std::to_string(i / sources_per_player_));
+
+        paths_.add_source(AudioPath::Source(
+            source_ids_[i].c_str(), "Source", player_id.c_str(),
+            std::make_unique<AudioPath::Source::PType>(
+                reinterpret_cast<tdbusaupathSource *>(new Peer))));
+        ++registrations_;
+    }
+
+    GVariantWrapper mk_request_data()
+    {
+        GVariantDict dict;
+        g_variant_dict_init(&dict, nullptr);
+        g_variant_dict_insert_value(&dict, "soak",
+                                    g_variant_new_uint64(registrations_));
+        return GVariantWrapper(g_variant_dict_end(&dict));
+    }
+
+    template <typename... Args>
+    std::function<void(Args...)> mk_done_fn()
+    {
+        ++requests_in_flight_;
+
+        return [this, start = Clock::now()] (Args...)
+        {
+            latencies_.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                Clock::now() - start).count());
+            --requests_in_flight_;
+        };
+    }
+
+    void issue_random_operation()
+    {
+        const size_t i =
+            std::uniform_int_distribution<size_t>(0, source_ids_.size() - 1)(rng);
+        const unsigned int what = std::uniform_int_distribution<unsigned int>(0, 99)(rng);
+
+        if(what < 60)
+            sw_.activate_source(paths_, source_ids_[i].c_str(), true,
+                                mk_request_data(),
+                                mk_done_fn<AudioPath::Switch::ActivateResult,
+                                           const AudioPath::ID *,
+                                           AudioPath::Switch::DeselectedAudioSourceResult>());
+        else if(what < 70)
+            sw_.release_path(paths_, what < 65, mk_request_data(),
+                             mk_done_fn<AudioPath::Switch::ReleaseResult,
+                                        const AudioPath::ID *,
+                                        AudioPath::Switch::DeselectedAudioSourceResult>());
+        else if(what < 85)
+        {
+            /* appliance not ready, then ready or gone */
+            sw_.activate_source(paths_, source_ids_[i].c_str(), false,
+                                mk_request_data(),
+                                mk_done_fn<AudioPath::Switch::ActivateResult,
+                                           const AudioPath::ID *,
+                                           AudioPath::Switch::DeselectedAudioSourceResult>());
+
+            if(what < 80)
+                sw_.complete_pending_source_activation(
+                    paths_,
+                    mk_done_fn<AudioPath::Switch::ActivateResult,
+                               const AudioPath::ID &>());
+            else
+                sw_.cancel_pending_source_activation(
+                    paths_,
+                    mk_done_fn<AudioPath::Switch::ActivateResult,
+                               const AudioPath::ID &>());
+        }
+        else if(what < 95)
+            register_source(i);
+        else
+            register_player(i / sources_per_player_);
+    }
+};
+
+static void print_us(uint64_t us)
+{
+    printf(" %9.3f", us / 1000.0);
+}
+
+static void print_window(size_t window, const MemoryUsage &m,
+                         const AudioPath::LatencyHistogram &h)
+{
+    printf("%6zu %10zu %10zu %10zu %7.1f", window, m.rss_kib_,
+           m.heap_in_use_kib_, m.heap_free_kib_, m.get_fragmentation());
+    print_us(h.get_percentile(50));
+    print_us(h.get_percentile(99));
+    print_us(h.get_max());
+    printf("\n");
+}
+
+/*!
+ * Compare last window against baseline.
+ *
+ * \returns
+ *     True if all numbers are within limits.
+ */
+static bool check_drift(const MemoryUsage &base_mem, uint64_t base_p99_us,
+                        const MemoryUsage &last_mem, uint64_t last_p99_us,
+                        const Thresholds &limits)
+{
+    bool ok = true;
+
+    if(last_mem.rss_kib_ > base_mem.rss_kib_ + limits.max_rss_growth_kib_)
+    {
+        fprintf(stderr, "FAILED: RSS grew by %zu KiB (limit %zu KiB)\n",
+                last_mem.rss_kib_ - base_mem.rss_kib_, limits.max_rss_growth_kib_);
+        ok = false;
+    }
+
+    if(last_mem.heap_in_use_kib_ > base_mem.heap_in_use_kib_ + limits.max_heap_growth_kib_)
+    {
+        fprintf(stderr, "FAILED: Heap usage grew by %zu KiB (limit %zu KiB)\n",
+                last_mem.heap_in_use_kib_ - base_mem.heap_in_use_kib_,
+                limits.max_heap_growth_kib_);
+        ok = false;
+    }
+
+    if(last_mem.get_fragmentation() > limits.max_fragmentation_percent_)
+    {
+        fprintf(stderr, "FAILED: Heap fragmentation at %.1f%% (limit %.1f%%)\n",
+                last_mem.get_fragmentation(), limits.max_fragmentation_percent_);
+        ok = false;
+    }
+
+    /* histogram buckets are coarse, so don't fail on sub-millisecond noise */
+    const uint64_t allowed_p99_us =
+        std::max(uint64_t(base_p99_us * limits.max_latency_growth_), uint64_t(1000));
+
+    if(last_p99_us > allowed_p99_us)
+    {
+        fprintf(stderr, "FAILED: p99 latency grew from %.3f ms to %.3f ms "
+                "(limit %.3f ms)\n",
+                base_p99_us / 1000.0, last_p99_us / 1000.0,
+                allowed_p99_us / 1000.0);
+        ok = false;
+    }
+
+    return ok;
+}
+
+static bool parse_size(const char *str, size_t &value)
+{
+    char *endptr;
+    const unsigned long long v = strtoull(str, &endptr, 10);
+
+    if(*endptr != '\0' || endptr == str)
+        return false;
+
+    value = v;
+    return true;
+}
+
+static bool parse_double(const char *str, double &value)
+{
+    char *endptr;
+    value = strtod(str, &endptr);
+    return *endptr == '\0' && endptr != str && value >= 0.0;
+}
+
+static void usage(const char *program_name)
+{
+    printf("Usage: %s [options]\n"
+           "\n"
+           "Options:\n"
+           "  --help                 Show this help.\n"
+           "  --operations n         Total number of operations (default: 2000000).\n"
+           "  --windows n            Number of measurement windows (default: 20).\n"
+           "  --players n            Number of players (default: 8).\n"
+           "  --sources n            Number of audio sources per player (default: 4).\n"
+           "  --max-rss-growth KiB   Allowed RSS growth (default: 1024).\n"
+           "  --max-heap-growth KiB  Allowed heap growth (default: 256).\n"
+           "  --max-fragmentation %% Allowed free heap in percent of total\n"
+           "                         heap (default: 75).\n"
+           "  --max-latency-growth f Allowed growth factor of p99 latency\n"
+           "                         (default: 2).\n",
+           program_name);
+}
+
+int main(int argc, char *argv[])
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_QUIET);
+
+    FakePeers::DelayedAnswers transport([] (const GObject *) { return 0U; });
+    FakePeers::set_transport(&transport);
+
+    size_t operations = 2000000;
+    size_t windows = 20;
+    size_t players = 8;
+    size_t sources = 4;
+    Thresholds limits{1024, 256, 75.0, 2.0};
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        bool ok = true;
+
+        if(strcmp(arg, "--help") == 0)
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if(i + 1 >= argc)
+            ok = false;
+        else if(strcmp(arg, "--operations") == 0)
+            ok = parse_size(argv[++i], operations) && operations > 0;
+        else if(strcmp(arg, "--windows") == 0)
+            ok = parse_size(argv[++i], windows) && windows >= 3;
+        else if(strcmp(arg, "--players") == 0)
+            ok = parse_size(argv[++i], players) && players > 0;
+        else if(strcmp(arg, "--sources") == 0)
+            ok = parse_size(argv[++i], sources) && sources > 0;
+        else if(strcmp(arg, "--max-rss-growth") == 0)
+            ok = parse_size(argv[++i], limits.max_rss_growth_kib_);
+        else if(strcmp(arg, "--max-heap-growth") == 0)
+            ok = parse_size(argv[++i], limits.max_heap_growth_kib_);
+        else if(strcmp(arg, "--max-fragmentation") == 0)
+            ok = parse_double(argv[++i], limits.max_fragmentation_percent_);
+        else if(strcmp(arg, "--max-latency-growth") == 0)
+            ok = parse_double(argv[++i], limits.max_latency_growth_);
+        else
+            ok = false;
+
+        if(!ok)
+        {
+            fprintf(stderr, "Invalid option \"%s\". Please try --help.\n", arg);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Soak soak(players, sources);
+    const size_t per_window = (operations + windows - 1) / windows;
+
+    printf("%6s %10s %10s %10s %7s %9s %9s %9s\n",
+           "window", "RSS KiB", "heap KiB", "free KiB", "frag %",
+           "p50 ms", "p99 ms", "max ms");
+
+    MemoryUsage base_mem{0, 0, 0};
+    uint64_t base_p99_us = 0;
+    MemoryUsage last_mem{0, 0, 0};
+    uint64_t last_p99_us = 0;
+    bool ok = true;
+
+    for(size_t w = 0; w < windows; ++w)
+    {
+        soak.run(per_window);
+
+        last_mem = MemoryUsage::sample();
+        last_p99_us = soak.get_latencies().get_percentile(99);
+        print_window(w, last_mem, soak.get_latencies());
+        fflush(stdout);
+
+        if(w == 1)
+        {
+            base_mem = last_mem;
+            base_p99_us = last_p99_us;
+        }
+
+        if(number_of_live_peers != soak.get_number_of_peers())
+        {
+            fprintf(stderr,
+                    "FAILED: %zu fake peers alive, but %zu registered "
+                    "(proxy leaked or destroyed too early)\n",
+                    number_of_live_peers, soak.get_number_of_peers());
+            ok = false;
+            break;
+        }
+    }
+
+    printf("\n%zu operations, %zu registrations\n",
+           per_window * windows, soak.get_number_of_registrations());
+
+    if(ok)
+        ok = check_drift(base_mem, base_p99_us, last_mem, last_p99_us, limits);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!@}*/
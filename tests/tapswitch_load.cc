@@ -0,0 +1,821 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <array>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "bench_dbus.hh"
+#include "switchstatistics.hh"
+#include "de_tahifi_audiopath.h"
+#include "gerrorwrapper.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks
+ *
+ * Load generator for a running \c tapswitch.
+ *
+ * This program keeps a configurable number of \c RequestSource and
+ * \c ReleasePath calls in flight until a given number of calls have been
+ * answered. Audio sources are picked at random according to configurable
+ * weights, and a string of configurable size can be sent along as request
+ * data. Optionally, the appliance is made to flap between ready and not
+ * ready (or suspended) states in a fixed rhythm by calling
+ * \c SetReadyState.
+ *
+ * Answers are classified by the error messages sent by \c tapswitch for
+ * each #AudioPath::Switch::ActivateResult, and latency histograms with the
+ * same buckets as used by \c tapswitch itself are reported for each kind
+ * of method call.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+using Clock = std::chrono::steady_clock;
+
+enum class Method
+{
+    REQUEST_SOURCE,
+    RELEASE_PATH,
+    SET_READY_STATE,
+
+    LAST_METHOD = SET_READY_STATE,
+};
+
+static constexpr size_t NUMBER_OF_METHODS = size_t(Method::LAST_METHOD) + 1;
+
+static const char *method_name(Method method)
+{
+    switch(method)
+    {
+      case Method::REQUEST_SOURCE:
+        return "RequestSource";
+
+      case Method::RELEASE_PATH:
+        return "ReleasePath";
+
+      case Method::SET_READY_STATE:
+        return "SetReadyState";
+    }
+
+    return "???";
+}
+
+enum class Outcome
+{
+    OK_SWITCHED,
+    OK_NOT_SWITCHED,
+    OK,
+    SOURCE_UNKNOWN,
+    SOURCE_FAILED,
+    PLAYER_UNKNOWN,
+    PLAYER_FAILED,
+    DEADLINE_EXCEEDED,
+    SUPERSEDED,
+    PENDING_CANCELED,
+    TIMEOUT,
+    OTHER_ERROR,
+
+    LAST_OUTCOME = OTHER_ERROR,
+};
+
+static constexpr size_t NUMBER_OF_OUTCOMES = size_t(Outcome::LAST_OUTCOME) + 1;
+
+static const char *outcome_name(Outcome outcome)
+{
+    switch(outcome)
+    {
+      case Outcome::OK_SWITCHED:
+        return "ok, player switched";
+
+      case Outcome::OK_NOT_SWITCHED:
+        return "ok, same player";
+
+      case Outcome::OK:
+        return "ok";
+
+      case Outcome::SOURCE_UNKNOWN:
+        return "source unknown";
+
+      case Outcome::SOURCE_FAILED:
+        return "source failed";
+
+      case Outcome::PLAYER_UNKNOWN:
+        return "player unknown";
+
+      case Outcome::PLAYER_FAILED:
+        return "player failed";
+
+      case Outcome::DEADLINE_EXCEEDED:
+        return "deadline exceeded";
+
+      case Outcome::SUPERSEDED:
+        return "superseded";
+
+      case Outcome::PENDING_CANCELED:
+        return "pending canceled";
+
+      case Outcome::TIMEOUT:
+        return "D-Bus timeout";
+
+      case Outcome::OTHER_ERROR:
+        return "other error";
+    }
+
+    return "???";
+}
+
+/*!
+ * Map error returned by \c tapswitch to outcome.
+ *
+ * The messages are those sent by \c request_source_bottom_half() and the
+ * functions completing deferred activations in \c dbus_handlers.cc.
+ */
+static Outcome classify_error(const GError *error)
+{
+    static const std::pair<const char *, Outcome> messages[] =
+    {
+        { "Audio source unknown",                     Outcome::SOURCE_UNKNOWN },
+        { "Audio source process failed",              Outcome::SOURCE_FAILED },
+        { "Source process failed",                    Outcome::SOURCE_FAILED },
+        { "No player associated",                     Outcome::PLAYER_UNKNOWN },
+        { "Player process failed",                    Outcome::PLAYER_FAILED },
+        { "Audio path switch took too long",          Outcome::DEADLINE_EXCEEDED },
+        { "Canceled pending audio source activation", Outcome::PENDING_CANCELED },
+    };
+
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT))
+        return Outcome::TIMEOUT;
+
+    gchar *remote_error = g_dbus_error_get_remote_error(error);
+    const bool is_superseded =
+        remote_error != nullptr &&
+        strcmp(remote_error, "de.tahifi.AudioPath.Error.Superseded") == 0;
+    g_free(remote_error);
+
+    if(is_superseded)
+        return Outcome::SUPERSEDED;
+
+    GError *stripped = g_error_copy(error);
+    g_dbus_error_strip_remote_error(stripped);
+
+    Outcome result = Outcome::OTHER_ERROR;
+
+    for(const auto &m : messages)
+    {
+        if(strncmp(stripped->message, m.first, strlen(m.first)) == 0)
+        {
+            result = m.second;
+            break;
+        }
+    }
+
+    g_error_free(stripped);
+
+    return result;
+}
+
+/*!
+ * Classify and free error, if any.
+ *
+ * Errors are expected under load, so they are only counted, not logged.
+ */
+static Outcome finish_outcome(GError *error, Outcome success)
+{
+    if(error == nullptr)
+        return success;
+
+    const Outcome result = classify_error(error);
+    g_error_free(error);
+
+    return result;
+}
+
+struct Parameters
+{
+    std::vector<std::string> source_ids_;
+    std::vector<unsigned int> source_weights_;
+    unsigned int calls_;
+    unsigned int concurrency_;
+    unsigned int release_permille_;
+    bool release_deactivates_player_;
+    unsigned int request_data_size_;
+    unsigned int flap_ready_ms_;
+    unsigned int flap_blocked_ms_;
+    bool flap_suspends_;
+    unsigned int call_timeout_ms_;
+    bool connect_to_session_dbus_;
+};
+
+/*!
+ * Load generator state.
+ */
+class Load
+{
+  private:
+    const Parameters &params_;
+    tdbusaupathManager *manager_;
+    tdbusaupathAppliance *appliance_;
+    GVariant *request_data_;
+
+    std::mt19937 rng_;
+    std::discrete_distribution<size_t> pick_source_;
+    std::uniform_int_distribution<unsigned int> pick_permille_;
+
+    unsigned int issued_;
+    unsigned int answered_;
+    unsigned int in_flight_;
+
+    bool is_appliance_ready_;
+    guint flap_timer_;
+
+    std::array<AudioPath::LatencyHistogram, NUMBER_OF_METHODS> latencies_;
+    std::array<std::array<unsigned int, NUMBER_OF_OUTCOMES>, NUMBER_OF_METHODS> outcomes_;
+
+    struct Call
+    {
+        Load *load_;
+        Method method_;
+        Clock::time_point started_;
+    };
+
+  public:
+    Load(const Load &) = delete;
+    Load &operator=(const Load &) = delete;
+
+    explicit Load(const Parameters &params, tdbusaupathManager *manager,
+                  tdbusaupathAppliance *appliance):
+        params_(params),
+        manager_(manager),
+        appliance_(appliance),
+        rng_(42),
+        pick_source_(params.source_weights_.begin(), params.source_weights_.end()),
+        pick_permille_(0, 999),
+        issued_(0),
+        answered_(0),
+        in_flight_(0),
+        is_appliance_ready_(true),
+        flap_timer_(0)
+    {
+        GVariantDict dict;
+        g_variant_dict_init(&dict, nullptr);
+
+        if(params_.request_data_size_ > 0)
+            g_variant_dict_insert_value(
+                &dict, "tapswitch_load_padding",
+                g_variant_new_take_string(
+                    g_strnfill(params_.request_data_size_, 'x')));
+
+        request_data_ = g_variant_ref_sink(g_variant_dict_end(&dict));
+
+        for(auto &o : outcomes_)
+            o.fill(0);
+    }
+
+    ~Load()
+    {
+        if(flap_timer_ != 0)
+            g_source_remove(flap_timer_);
+
+        g_variant_unref(request_data_);
+    }
+
+    double run();
+    void print(double total_ms) const;
+
+  private:
+    void fill_up();
+    void issue_request_source();
+    void issue_release_path();
+    void issue_set_ready_state(bool is_ready);
+    void done(const Call &call, Outcome outcome);
+
+    static gboolean flap(gpointer user_data);
+    static void request_source_done(GObject *source_object, GAsyncResult *res,
+                                    gpointer user_data);
+    static void release_path_done(GObject *source_object, GAsyncResult *res,
+                                  gpointer user_data);
+    static void set_ready_state_done(GObject *source_object, GAsyncResult *res,
+                                     gpointer user_data);
+};
+
+double Load::run()
+{
+    const auto start = Clock::now();
+
+    if(params_.flap_ready_ms_ > 0 && params_.flap_blocked_ms_ > 0)
+        flap_timer_ = g_timeout_add(params_.flap_ready_ms_, flap, this);
+
+    fill_up();
+
+    while(answered_ < params_.calls_)
+        g_main_context_iteration(nullptr, TRUE);
+
+    const double total_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    if(flap_timer_ != 0)
+    {
+        g_source_remove(flap_timer_);
+        flap_timer_ = 0;
+    }
+
+    if(!is_appliance_ready_)
+    {
+        /* leave the appliance in a usable state */
+        issue_set_ready_state(true);
+        BenchDBus::run_until([this] { return in_flight_ == 0; },
+                             params_.call_timeout_ms_);
+    }
+
+    return total_ms;
+}
+
+void Load::fill_up()
+{
+    while(in_flight_ < params_.concurrency_ && issued_ < params_.calls_)
+    {
+        ++issued_;
+
+        if(pick_permille_(rng_) < params_.release_permille_)
+            issue_release_path();
+        else
+            issue_request_source();
+    }
+}
+
+void Load::issue_request_source()
+{
+    ++in_flight_;
+    tdbus_aupath_manager_call_request_source(
+        manager_, params_.source_ids_[pick_source_(rng_)].c_str(), request_data_,
+        nullptr, request_source_done,
+        new Call{this, Method::REQUEST_SOURCE, Clock::now()});
+}
+
+void Load::issue_release_path()
+{
+    ++in_flight_;
+    tdbus_aupath_manager_call_release_path(
+        manager_, params_.release_deactivates_player_, request_data_,
+        nullptr, release_path_done,
+        new Call{this, Method::RELEASE_PATH, Clock::now()});
+}
+
+void Load::issue_set_ready_state(bool is_ready)
+{
+    const guchar audio_state = is_ready ? 2 : 1;
+    const guchar power_state = (is_ready || !params_.flap_suspends_) ? 2 : 1;
+
+    is_appliance_ready_ = is_ready;
+
+    ++in_flight_;
+    tdbus_aupath_appliance_call_set_ready_state(
+        appliance_, audio_state, power_state, nullptr, set_ready_state_done,
+        new Call{this, Method::SET_READY_STATE, Clock::now()});
+}
+
+gboolean Load::flap(gpointer user_data)
+{
+    auto &load = *static_cast<Load *>(user_data);
+
+    load.issue_set_ready_state(!load.is_appliance_ready_);
+    load.flap_timer_ =
+        g_timeout_add(load.is_appliance_ready_
+                      ? load.params_.flap_ready_ms_
+                      : load.params_.flap_blocked_ms_,
+                      flap, user_data);
+
+    return G_SOURCE_REMOVE;
+}
+
+void Load::done(const Call &call, Outcome outcome)
+{
+    const auto duration_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - call.started_).count();
+
+    latencies_[size_t(call.method_)].add(duration_us);
+    ++outcomes_[size_t(call.method_)][size_t(outcome)];
+    --in_flight_;
+
+    /* appliance state changes are not part of the requested number of calls */
+    if(call.method_ == Method::SET_READY_STATE)
+        return;
+
+    ++answered_;
+    fill_up();
+}
+
+void Load::request_source_done(GObject *source_object, GAsyncResult *res,
+                               gpointer user_data)
+{
+    std::unique_ptr<Call> call(static_cast<Call *>(user_data));
+    GError *error = nullptr;
+    gchar *player_id = nullptr;
+    gboolean switched = FALSE;
+
+    tdbus_aupath_manager_call_request_source_finish(
+        TDBUS_AUPATH_MANAGER(source_object), &player_id, &switched, res,
+        &error);
+    g_free(player_id);
+
+    call->load_->done(*call, finish_outcome(error, switched
+                                                   ? Outcome::OK_SWITCHED
+                                                   : Outcome::OK_NOT_SWITCHED));
+}
+
+void Load::release_path_done(GObject *source_object, GAsyncResult *res,
+                             gpointer user_data)
+{
+    std::unique_ptr<Call> call(static_cast<Call *>(user_data));
+    GError *error = nullptr;
+
+    tdbus_aupath_manager_call_release_path_finish(
+        TDBUS_AUPATH_MANAGER(source_object), res, &error);
+
+    call->load_->done(*call, finish_outcome(error, Outcome::OK));
+}
+
+void Load::set_ready_state_done(GObject *source_object, GAsyncResult *res,
+                                gpointer user_data)
+{
+    std::unique_ptr<Call> call(static_cast<Call *>(user_data));
+    GError *error = nullptr;
+
+    tdbus_aupath_appliance_call_set_ready_state_finish(
+        TDBUS_AUPATH_APPLIANCE(source_object), res, &error);
+
+    call->load_->done(*call, finish_outcome(error, Outcome::OK));
+}
+
+static void print_us(uint64_t us)
+{
+    printf(" %9.2f", us / 1000.0);
+}
+
+void Load::print(double total_ms) const
+{
+    printf("%-14s %8s %8s %9s %9s %9s %9s %9s\n",
+           "method", "calls", "per s", "p50 ms", "p90 ms", "p99 ms",
+           "max ms", "mean ms");
+
+    for(size_t m = 0; m < NUMBER_OF_METHODS; ++m)
+    {
+        const auto &h(latencies_[m]);
+
+        if(h.get_count() == 0)
+            continue;
+
+        printf("%-14s %8llu %8.1f", method_name(Method(m)),
+               static_cast<unsigned long long>(h.get_count()),
+               h.get_count() * 1000.0 / total_ms);
+        print_us(h.get_percentile(50));
+        print_us(h.get_percentile(90));
+        print_us(h.get_percentile(99));
+        print_us(h.get_max());
+        print_us(h.get_sum() / h.get_count());
+        printf("\n");
+    }
+
+    printf("\n%-14s %-20s %8s\n", "method", "outcome", "count");
+
+    for(size_t m = 0; m < NUMBER_OF_METHODS; ++m)
+        for(size_t o = 0; o < NUMBER_OF_OUTCOMES; ++o)
+            if(outcomes_[m][o] > 0)
+                printf("%-14s %-20s %8u\n", method_name(Method(m)),
+                       outcome_name(Outcome(o)), outcomes_[m][o]);
+
+    printf("\n%-14s %12s", "histogram", "<= ms");
+
+    for(size_t m = 0; m < NUMBER_OF_METHODS; ++m)
+        if(latencies_[m].get_count() > 0)
+            printf(" %14s", method_name(Method(m)));
+
+    printf("\n");
+
+    for(size_t b = 0; b < AudioPath::LatencyHistogram::NUMBER_OF_BUCKETS; ++b)
+    {
+        if(b < AudioPath::LatencyHistogram::BOUNDS_US.size())
+            printf("%-14s %12.2f", "",
+                   AudioPath::LatencyHistogram::BOUNDS_US[b] / 1000.0);
+        else
+            printf("%-14s %12s", "", "inf");
+
+        for(size_t m = 0; m < NUMBER_OF_METHODS; ++m)
+            if(latencies_[m].get_count() > 0)
+                printf(" %14llu",
+                       static_cast<unsigned long long>(latencies_[m].get_buckets()[b]));
+
+        printf("\n");
+    }
+}
+
+/*!
+ * Use all usable audio paths if no audio sources were given.
+ */
+static bool get_usable_sources(tdbusaupathManager *proxy, Parameters &params)
+{
+    GErrorWrapper error;
+    GVariant *usable = nullptr;
+    GVariant *incomplete = nullptr;
+
+    tdbus_aupath_manager_call_get_paths_sync(proxy, &usable, &incomplete,
+                                             nullptr, error.await());
+
+    if(error.log_failure("Get audio paths"))
+        return false;
+
+    GVariantIter iter;
+    const gchar *source_id;
+    const gchar *player_id;
+
+    g_variant_iter_init(&iter, usable);
+
+    while(g_variant_iter_next(&iter, "(&s&s)", &source_id, &player_id))
+    {
+        params.source_ids_.emplace_back(source_id);
+        params.source_weights_.push_back(1);
+    }
+
+    g_variant_unref(usable);
+    g_variant_unref(incomplete);
+
+    if(params.source_ids_.empty())
+    {
+        fprintf(stderr, "No usable audio paths registered\n");
+        return false;
+    }
+
+    return true;
+}
+
+static void usage(const char *program_name)
+{
+    printf("Usage: %s [options]\n"
+           "\n"
+           "Options:\n"
+           "  --help              Show this help.\n"
+           "  --session-dbus      Connect to session D-Bus (default).\n"
+           "  --system-dbus       Connect to system D-Bus.\n"
+           "  --source id[:w]     Request audio source with relative weight w\n"
+           "                      (default: 1); may be given multiple times.\n"
+           "                      Default is all usable audio paths.\n"
+           "  --calls n           Number of RequestSource and ReleasePath calls\n"
+           "                      (default: 10000).\n"
+           "  --concurrency n     Number of calls in flight (default: 4).\n"
+           "  --release n         Per mille of ReleasePath calls (default: 50).\n"
+           "  --release-deactivates-player\n"
+           "                      Ask for player deactivation on ReleasePath.\n"
+           "  --request-data-size bytes\n"
+           "                      Size of padding string sent as request data\n"
+           "                      (default: 0).\n"
+           "  --flap ready:blocked[:suspend]\n"
+           "                      Let the appliance be ready for the given\n"
+           "                      number of ms, then not ready for the given\n"
+           "                      number of ms, and so on; if \"suspend\" is\n"
+           "                      given, the appliance is also suspended.\n"
+           "  --timeout ms        D-Bus call timeout (default: 25000).\n",
+           program_name);
+}
+
+static bool parse_source(const char *arg, Parameters &params)
+{
+    const char *sep = strrchr(arg, ':');
+    unsigned int weight = 1;
+
+    if(sep != nullptr &&
+       (!BenchDBus::parse_uint(sep + 1, weight) || weight == 0))
+        return false;
+
+    std::string id(sep != nullptr ? std::string(arg, sep - arg) : std::string(arg));
+
+    if(id.empty())
+        return false;
+
+    params.source_ids_.emplace_back(std::move(id));
+    params.source_weights_.push_back(weight);
+
+    return true;
+}
+
+static bool parse_flap(const char *arg, Parameters &params)
+{
+    gchar **fields = g_strsplit(arg, ":", 3);
+    const guint n = g_strv_length(fields);
+    bool ok = n >= 2 &&
+              BenchDBus::parse_uint(fields[0], params.flap_ready_ms_) &&
+              BenchDBus::parse_uint(fields[1], params.flap_blocked_ms_) &&
+              params.flap_ready_ms_ > 0 && params.flap_blocked_ms_ > 0;
+
+    if(ok && n == 3)
+    {
+        ok = strcmp(fields[2], "suspend") == 0;
+        params.flap_suspends_ = ok;
+    }
+
+    g_strfreev(fields);
+
+    return ok;
+}
+
+static int process_command_line(int argc, char *argv[], Parameters &params)
+{
+    params.calls_ = 10000;
+    params.concurrency_ = 4;
+    params.release_permille_ = 50;
+    params.release_deactivates_player_ = false;
+    params.request_data_size_ = 0;
+    params.flap_ready_ms_ = 0;
+    params.flap_blocked_ms_ = 0;
+    params.flap_suspends_ = false;
+    params.call_timeout_ms_ = 25000;
+    params.connect_to_session_dbus_ = true;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+
+        if(strcmp(arg, "--help") == 0)
+            return 1;
+        else if(strcmp(arg, "--session-dbus") == 0)
+        {
+            params.connect_to_session_dbus_ = true;
+            continue;
+        }
+        else if(strcmp(arg, "--system-dbus") == 0)
+        {
+            params.connect_to_session_dbus_ = false;
+            continue;
+        }
+        else if(strcmp(arg, "--release-deactivates-player") == 0)
+        {
+            params.release_deactivates_player_ = true;
+            continue;
+        }
+
+        if(i + 1 >= argc)
+        {
+            fprintf(stderr, "Option %s missing argument or unknown. "
+                    "Please try --help.\n", arg);
+            return -1;
+        }
+
+        bool ok;
+        const char *value = argv[++i];
+
+        if(strcmp(arg, "--source") == 0)
+            ok = parse_source(value, params);
+        else if(strcmp(arg, "--calls") == 0)
+            ok = BenchDBus::parse_uint(value, params.calls_) && params.calls_ > 0;
+        else if(strcmp(arg, "--concurrency") == 0)
+            ok = BenchDBus::parse_uint(value, params.concurrency_) &&
+                 params.concurrency_ > 0;
+        else if(strcmp(arg, "--release") == 0)
+            ok = BenchDBus::parse_uint(value, params.release_permille_) &&
+                 params.release_permille_ <= 1000;
+        else if(strcmp(arg, "--request-data-size") == 0)
+            ok = BenchDBus::parse_uint(value, params.request_data_size_);
+        else if(strcmp(arg, "--flap") == 0)
+            ok = parse_flap(value, params);
+        else if(strcmp(arg, "--timeout") == 0)
+            ok = BenchDBus::parse_uint(value, params.call_timeout_ms_) &&
+                 params.call_timeout_ms_ > 0 && params.call_timeout_ms_ <= G_MAXINT;
+        else
+        {
+            fprintf(stderr, "Unknown option \"%s\". Please try --help.\n", arg);
+            return -1;
+        }
+
+        if(!ok)
+        {
+            fprintf(stderr, "Invalid argument \"%s\" for option %s\n", value, arg);
+            return -1;
+        }
+    }
+
+    if(params.release_permille_ == 1000 && params.source_ids_.empty())
+    {
+        /* no audio sources needed */
+        params.source_ids_.emplace_back("");
+        params.source_weights_.push_back(1);
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_NORMAL);
+
+    Parameters params;
+    const int ret = process_command_line(argc, argv, params);
+
+    if(ret != 0)
+    {
+        usage(argv[0]);
+        return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    GErrorWrapper error;
+    GDBusConnection *connection =
+        g_bus_get_sync(params.connect_to_session_dbus_
+                       ? G_BUS_TYPE_SESSION
+                       : G_BUS_TYPE_SYSTEM,
+                       nullptr, error.await());
+
+    if(error.log_failure("Connect to D-Bus"))
+        return EXIT_FAILURE;
+
+    tdbusaupathManager *manager = nullptr;
+    tdbusaupathAppliance *appliance = nullptr;
+    bool ok = BenchDBus::wait_for_tapswitch(connection, params.call_timeout_ms_);
+
+    if(ok)
+    {
+        manager =
+            tdbus_aupath_manager_proxy_new_sync(connection,
+                                                G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+                                                BenchDBus::TAPSWITCH_BUS_NAME,
+                                                BenchDBus::TAPSWITCH_OBJECT_PATH,
+                                                nullptr, error.await());
+        ok = !error.log_failure("Create manager proxy");
+    }
+
+    if(ok)
+    {
+        appliance =
+            tdbus_aupath_appliance_proxy_new_sync(connection,
+                                                  G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+                                                  BenchDBus::TAPSWITCH_BUS_NAME,
+                                                  BenchDBus::TAPSWITCH_OBJECT_PATH,
+                                                  nullptr, error.await());
+        ok = !error.log_failure("Create appliance proxy");
+    }
+
+    if(ok)
+    {
+        g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(manager),
+                                         params.call_timeout_ms_);
+        g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(appliance),
+                                         params.call_timeout_ms_);
+    }
+
+    if(ok && params.source_ids_.empty())
+        ok = get_usable_sources(manager, params);
+
+    if(ok)
+    {
+        Load load(params, manager, appliance);
+        load.print(load.run());
+    }
+
+    if(appliance != nullptr)
+        g_object_unref(appliance);
+
+    if(manager != nullptr)
+        g_object_unref(manager);
+
+    g_object_unref(connection);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!@}*/
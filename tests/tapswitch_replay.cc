@@ -0,0 +1,669 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <functional>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "bench_dbus.hh"
+#include "trafficrecorder.hh"
+#include "switchstatistics.hh"
+#include "de_tahifi_audiopath.h"
+#include "gerrorwrapper.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks
+ *
+ * Replay D-Bus traffic recorded by \c tapswitch.
+ *
+ * This program reads a file written by #AudioPath::TrafficRecorder (see
+ * \c tapswitch option \c --record-traffic) and sends the recorded method
+ * calls to a running \c tapswitch, at the original pace or faster.
+ *
+ * Each bus name which has sent calls in the recording gets its own bus
+ * connection, so that \c tapswitch sees as many peers as in the original
+ * session. Players and audio sources registered in the recording are
+ * simulated on these connections; they answer calls from \c tapswitch
+ * after the latencies recorded for the same player or audio source and
+ * method, in the original order, and fail where the original calls failed.
+ * Peers which vanished in the recording are disconnected at the same point
+ * of the replay.
+ *
+ * Latency histograms of the replayed calls are reported per method, so
+ * that different builds of \c tapswitch can be compared on the identical
+ * workload.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+using Clock = std::chrono::steady_clock;
+
+class Replay;
+
+/*!
+ * Player or audio source object exported on behalf of a recorded peer.
+ */
+struct SimulatedObject
+{
+    Replay *replay_;
+    GDBusInterfaceSkeleton *skeleton_;
+
+    /*! Player ID for players, empty for audio sources. */
+    std::string player_id_;
+
+    explicit SimulatedObject(Replay *replay, GDBusInterfaceSkeleton *skeleton,
+                             std::string &&player_id):
+        replay_(replay),
+        skeleton_(skeleton),
+        player_id_(std::move(player_id))
+    {}
+
+    ~SimulatedObject()
+    {
+        g_dbus_interface_skeleton_unexport(skeleton_);
+        g_object_unref(skeleton_);
+    }
+};
+
+/*!
+ * Recorded answer of a player or audio source.
+ */
+struct PeerAnswer
+{
+    uint32_t duration_us_;
+    bool failed_;
+};
+
+struct MethodStatistics
+{
+    AudioPath::LatencyHistogram latency_;
+    unsigned int failed_;
+
+    explicit MethodStatistics(): failed_(0) {}
+};
+
+class Replay
+{
+  private:
+    std::vector<AudioPath::TrafficReader::Record> records_;
+    double speed_;
+    gchar *bus_address_;
+
+    /* connections by sender names in the recording */
+    std::map<std::string, GDBusConnection *> connections_;
+
+    /* simulated objects by connection and object path */
+    std::map<std::pair<GDBusConnection *, std::string>,
+             std::unique_ptr<SimulatedObject>> objects_;
+
+    /* recorded answers by player or audio source ID and method name */
+    std::map<std::pair<std::string, std::string>, std::deque<PeerAnswer>> answers_;
+
+    std::map<std::string, MethodStatistics> statistics_;
+    unsigned int in_flight_;
+    unsigned int unexpected_peer_calls_;
+
+    struct Call
+    {
+        Replay *replay_;
+        const std::string *method_name_;
+        Clock::time_point started_;
+    };
+
+  public:
+    Replay(const Replay &) = delete;
+    Replay &operator=(const Replay &) = delete;
+
+    explicit Replay(double speed, gchar *bus_address):
+        speed_(speed),
+        bus_address_(bus_address),
+        in_flight_(0),
+        unexpected_peer_calls_(0)
+    {}
+
+    ~Replay()
+    {
+        objects_.clear();
+
+        for(auto &c : connections_)
+            close_connection(c.second);
+
+        g_free(bus_address_);
+    }
+
+    bool load(const char *path);
+    bool run(unsigned int timeout_ms);
+    void print() const;
+
+    void answer(GDBusMethodInvocation *invocation, const char *method_name,
+                const std::string &peer_id, std::function<void()> &&complete);
+
+  private:
+    GDBusConnection *get_connection(const std::string &sender);
+    static void close_connection(GDBusConnection *connection);
+
+    bool prepare_peer(GDBusConnection *connection,
+                      const AudioPath::TrafficReader::Record &record);
+    void send(GDBusConnection *connection,
+              const AudioPath::TrafficReader::Record &record);
+
+    static void call_done(GObject *source_object, GAsyncResult *res,
+                          gpointer user_data);
+};
+
+bool Replay::load(const char *path)
+{
+    AudioPath::TrafficReader reader;
+
+    if(!reader.open(path))
+        return false;
+
+    AudioPath::TrafficReader::Record record;
+
+    while(reader.next(record))
+    {
+        if(record.type_ == AudioPath::TrafficRecorder::RecordType::PEER_CALL)
+            answers_[std::make_pair(record.peer_id_, record.method_name_)]
+                .push_back(PeerAnswer{record.duration_us_, record.failed_});
+
+        records_.emplace_back(std::move(record));
+    }
+
+    if(records_.empty())
+    {
+        fprintf(stderr, "No records in %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+GDBusConnection *Replay::get_connection(const std::string &sender)
+{
+    auto it = connections_.find(sender);
+
+    if(it != connections_.end())
+        return it->second;
+
+    GErrorWrapper error;
+    GDBusConnection *connection =
+        g_dbus_connection_new_for_address_sync(
+            bus_address_,
+            GDBusConnectionFlags(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                 G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+            nullptr, nullptr, error.await());
+
+    if(error.log_failure("Connect simulated peer"))
+        return nullptr;
+
+    connections_[sender] = connection;
+
+    return connection;
+}
+
+void Replay::close_connection(GDBusConnection *connection)
+{
+    g_dbus_connection_close_sync(connection, nullptr, nullptr);
+    g_object_unref(connection);
+}
+
+static gboolean complete_answer(gpointer user_data)
+{
+    auto *fn = static_cast<std::function<void()> *>(user_data);
+    (*fn)();
+    delete fn;
+    return G_SOURCE_REMOVE;
+}
+
+void Replay::answer(GDBusMethodInvocation *invocation, const char *method_name,
+                    const std::string &peer_id, std::function<void()> &&complete)
+{
+    auto it = answers_.find(std::make_pair(peer_id, std::string(method_name)));
+    PeerAnswer a{0, false};
+
+    if(it != answers_.end() && !it->second.empty())
+    {
+        a = it->second.front();
+        it->second.pop_front();
+    }
+    else
+        ++unexpected_peer_calls_;
+
+    const guint delay_ms =
+        speed_ > 0.0 ? guint(a.duration_us_ / speed_ / 1000.0) : 0;
+
+    std::function<void()> fn;
+
+    if(a.failed_)
+        fn = [invocation]
+             {
+                 g_dbus_method_invocation_return_error_literal(
+                    invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+                    "Failure replayed from recording");
+             };
+    else
+        fn = std::move(complete);
+
+    if(delay_ms == 0)
+        fn();
+    else
+        g_timeout_add(delay_ms, complete_answer,
+                      new std::function<void()>(std::move(fn)));
+}
+
+static gboolean handle_activate(tdbusaupathPlayer *object,
+                                GDBusMethodInvocation *invocation,
+                                GVariant *arg_request_data,
+                                SimulatedObject *so)
+{
+    so->replay_->answer(
+        invocation, "Activate", so->player_id_,
+        [object, invocation]
+        { tdbus_aupath_player_complete_activate(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_deactivate(tdbusaupathPlayer *object,
+                                  GDBusMethodInvocation *invocation,
+                                  GVariant *arg_request_data,
+                                  SimulatedObject *so)
+{
+    so->replay_->answer(
+        invocation, "Deactivate", so->player_id_,
+        [object, invocation]
+        { tdbus_aupath_player_complete_deactivate(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_selected_on_hold(tdbusaupathSource *object,
+                                        GDBusMethodInvocation *invocation,
+                                        const gchar *source_id,
+                                        GVariant *arg_request_data,
+                                        SimulatedObject *so)
+{
+    so->replay_->answer(
+        invocation, "SelectedOnHold", source_id,
+        [object, invocation]
+        { tdbus_aupath_source_complete_selected_on_hold(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_selected(tdbusaupathSource *object,
+                                GDBusMethodInvocation *invocation,
+                                const gchar *source_id,
+                                GVariant *arg_request_data,
+                                SimulatedObject *so)
+{
+    so->replay_->answer(
+        invocation, "Selected", source_id,
+        [object, invocation]
+        { tdbus_aupath_source_complete_selected(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_deselected(tdbusaupathSource *object,
+                                  GDBusMethodInvocation *invocation,
+                                  const gchar *source_id,
+                                  GVariant *arg_request_data,
+                                  SimulatedObject *so)
+{
+    so->replay_->answer(
+        invocation, "Deselected", source_id,
+        [object, invocation]
+        { tdbus_aupath_source_complete_deselected(object, invocation); });
+    return TRUE;
+}
+
+/*!
+ * Export simulated player or audio source before it is registered.
+ */
+bool Replay::prepare_peer(GDBusConnection *connection,
+                          const AudioPath::TrafficReader::Record &record)
+{
+    const bool is_player = record.method_name_ == "RegisterPlayer";
+
+    if(!is_player && record.method_name_ != "RegisterSource")
+        return true;
+
+    GVariant *params = GVariantWrapper::get(record.parameters_);
+    const gchar *id;
+    const gchar *path;
+
+    if(is_player)
+        g_variant_get(params, "(&s&s&s)", &id, nullptr, &path);
+    else
+        g_variant_get(params, "(&s&s&s&s)", &id, nullptr, nullptr, &path);
+
+    const auto key(std::make_pair(connection, std::string(path)));
+
+    if(objects_.find(key) != objects_.end())
+        return true;
+
+    GDBusInterfaceSkeleton *skeleton = is_player
+        ? G_DBUS_INTERFACE_SKELETON(tdbus_aupath_player_skeleton_new())
+        : G_DBUS_INTERFACE_SKELETON(tdbus_aupath_source_skeleton_new());
+    auto so = std::make_unique<SimulatedObject>(this, skeleton,
+                                                is_player ? id : "");
+
+    if(is_player)
+    {
+        g_signal_connect(skeleton, "handle-activate",
+                         G_CALLBACK(handle_activate), so.get());
+        g_signal_connect(skeleton, "handle-deactivate",
+                         G_CALLBACK(handle_deactivate), so.get());
+    }
+    else
+    {
+        g_signal_connect(skeleton, "handle-selected-on-hold",
+                         G_CALLBACK(handle_selected_on_hold), so.get());
+        g_signal_connect(skeleton, "handle-selected",
+                         G_CALLBACK(handle_selected), so.get());
+        g_signal_connect(skeleton, "handle-deselected",
+                         G_CALLBACK(handle_deselected), so.get());
+    }
+
+    GErrorWrapper error;
+    g_dbus_interface_skeleton_export(skeleton, connection, path, error.await());
+
+    if(error.log_failure("Export simulated peer"))
+        return false;
+
+    objects_.emplace(key, std::move(so));
+
+    return true;
+}
+
+void Replay::send(GDBusConnection *connection,
+                  const AudioPath::TrafficReader::Record &record)
+{
+    ++in_flight_;
+    g_dbus_connection_call(connection, BenchDBus::TAPSWITCH_BUS_NAME,
+                           BenchDBus::TAPSWITCH_OBJECT_PATH,
+                           record.interface_name_.c_str(),
+                           record.method_name_.c_str(),
+                           GVariantWrapper::get(record.parameters_),
+                           nullptr, G_DBUS_CALL_FLAGS_NONE, -1, nullptr,
+                           call_done,
+                           new Call{this, &record.method_name_, Clock::now()});
+}
+
+void Replay::call_done(GObject *source_object, GAsyncResult *res,
+                       gpointer user_data)
+{
+    std::unique_ptr<Call> call(static_cast<Call *>(user_data));
+    GError *error = nullptr;
+    GVariant *result =
+        g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+                                      &error);
+    auto &stats(call->replay_->statistics_[*call->method_name_]);
+
+    stats.latency_.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                            Clock::now() - call->started_).count());
+
+    if(result != nullptr)
+        g_variant_unref(result);
+
+    if(error != nullptr)
+    {
+        ++stats.failed_;
+        g_error_free(error);
+    }
+
+    --call->replay_->in_flight_;
+}
+
+bool Replay::run(unsigned int timeout_ms)
+{
+    const auto start = Clock::now();
+    const gint64 first_us = records_.front().timestamp_us_;
+
+    for(const auto &record : records_)
+    {
+        if(record.type_ == AudioPath::TrafficRecorder::RecordType::PEER_CALL)
+            continue;
+
+        if(speed_ > 0.0)
+        {
+            const auto due =
+                start + std::chrono::microseconds(
+                            gint64((record.timestamp_us_ - first_us) / speed_));
+
+            while(Clock::now() < due)
+            {
+                const auto remaining_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        due - Clock::now()).count();
+
+                BenchDBus::run_until([&due] { return Clock::now() >= due; },
+                                     remaining_ms > 0 ? remaining_ms : 1);
+            }
+        }
+
+        switch(record.type_)
+        {
+          case AudioPath::TrafficRecorder::RecordType::METHOD_CALL:
+            {
+                GDBusConnection *connection = get_connection(record.sender_);
+
+                if(connection == nullptr || !prepare_peer(connection, record))
+                    return false;
+
+                send(connection, record);
+            }
+
+            break;
+
+          case AudioPath::TrafficRecorder::RecordType::PEER_VANISHED:
+            {
+                auto it = connections_.find(record.sender_);
+
+                if(it == connections_.end())
+                    break;
+
+                for(auto obj = objects_.begin(); obj != objects_.end();)
+                {
+                    if(obj->first.first == it->second)
+                        obj = objects_.erase(obj);
+                    else
+                        ++obj;
+                }
+
+                close_connection(it->second);
+                connections_.erase(it);
+            }
+
+            break;
+
+          case AudioPath::TrafficRecorder::RecordType::PEER_CALL:
+            break;
+        }
+    }
+
+    if(!BenchDBus::run_until([this] { return in_flight_ == 0; }, timeout_ms))
+    {
+        fprintf(stderr, "Timeout waiting for %u answers\n", in_flight_);
+        return false;
+    }
+
+    return true;
+}
+
+static void print_us(uint64_t us)
+{
+    printf(" %9.2f", us / 1000.0);
+}
+
+void Replay::print() const
+{
+    printf("%-20s %8s %8s %9s %9s %9s %9s\n",
+           "method", "calls", "failed", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+    for(const auto &s : statistics_)
+    {
+        const auto &h(s.second.latency_);
+
+        printf("%-20s %8llu %8u", s.first.c_str(),
+               static_cast<unsigned long long>(h.get_count()), s.second.failed_);
+        print_us(h.get_percentile(50));
+        print_us(h.get_percentile(90));
+        print_us(h.get_percentile(99));
+        print_us(h.get_max());
+        printf("\n");
+    }
+
+    size_t unused_answers = 0;
+
+    for(const auto &a : answers_)
+        unused_answers += a.second.size();
+
+    if(unexpected_peer_calls_ > 0 || unused_answers > 0)
+        printf("\nPeer calls not in recording: %u, "
+               "recorded peer calls not replayed: %zu\n",
+               unexpected_peer_calls_, unused_answers);
+}
+
+static void usage(const char *program_name)
+{
+    printf("Usage: %s [options] FILE\n"
+           "\n"
+           "Options:\n"
+           "  --help              Show this help.\n"
+           "  --session-dbus      Connect to session D-Bus (default).\n"
+           "  --system-dbus       Connect to system D-Bus.\n"
+           "  --speed factor      Replay faster by given factor, 0 for no\n"
+           "                      pauses between calls (default: 1).\n"
+           "  --timeout ms        Time to wait for outstanding answers at the\n"
+           "                      end (default: 30000).\n",
+           program_name);
+}
+
+int main(int argc, char *argv[])
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_NORMAL);
+
+    bool connect_to_session_dbus = true;
+    double speed = 1.0;
+    unsigned int timeout_ms = 30000;
+    const char *path = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+
+        if(strcmp(arg, "--help") == 0)
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if(strcmp(arg, "--session-dbus") == 0)
+            connect_to_session_dbus = true;
+        else if(strcmp(arg, "--system-dbus") == 0)
+            connect_to_session_dbus = false;
+        else if(strcmp(arg, "--speed") == 0 && i + 1 < argc)
+        {
+            char *endptr;
+            speed = g_ascii_strtod(argv[++i], &endptr);
+
+            if(*endptr != '\0' || speed < 0.0)
+            {
+                fprintf(stderr, "Invalid speed \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(strcmp(arg, "--timeout") == 0 && i + 1 < argc)
+        {
+            if(!BenchDBus::parse_uint(argv[++i], timeout_ms) || timeout_ms == 0)
+            {
+                fprintf(stderr, "Invalid timeout \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg[0] != '-' && path == nullptr)
+            path = arg;
+        else
+        {
+            fprintf(stderr, "Unknown option \"%s\". Please try --help.\n", arg);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(path == nullptr)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const GBusType bus_type =
+        connect_to_session_dbus ? G_BUS_TYPE_SESSION : G_BUS_TYPE_SYSTEM;
+    GErrorWrapper error;
+    GDBusConnection *connection = g_bus_get_sync(bus_type, nullptr, error.await());
+
+    if(error.log_failure("Connect to D-Bus"))
+        return EXIT_FAILURE;
+
+    gchar *address = g_dbus_address_get_for_bus_sync(bus_type, nullptr,
+                                                     error.await());
+
+    if(error.log_failure("Get bus address"))
+    {
+        g_object_unref(connection);
+        return EXIT_FAILURE;
+    }
+
+    bool ok = BenchDBus::wait_for_tapswitch(connection, timeout_ms);
+
+    if(ok)
+    {
+        Replay replay(speed, address);
+
+        ok = replay.load(path) && replay.run(timeout_ms);
+
+        if(ok)
+            replay.print();
+    }
+    else
+        g_free(address);
+
+    g_object_unref(connection);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!@}*/
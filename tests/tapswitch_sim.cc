@@ -0,0 +1,798 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "bench_dbus.hh"
+#include "de_tahifi_audiopath.h"
+#include "gerrorwrapper.hh"
+#include "messages.h"
+#include "os.h"
+
+/*!
+ * \addtogroup audiopath_benchmarks Benchmarks
+ * \ingroup audiopath
+ *
+ * Measure a running \c tapswitch through D-Bus with simulated peers.
+ *
+ * This program connects to the session bus, waits for \c tapswitch to
+ * appear, and exports a configurable number of players and audio sources.
+ * Their D-Bus methods answer after a delay drawn from a configurable range.
+ *
+ * All players and audio sources are registered at the same time, and the
+ * time until \c tapswitch has answered all registrations is reported.
+ * Then, audio sources are requested one after another in random order, and
+ * percentiles of the RequestSource round trip time are reported. A number of
+ * extra bus connections listen for the \c PathActivated signal; the time
+ * until the signal has reached the last of them is reported as well, so
+ * that the cost of signal fan-out can be seen by comparing runs with
+ * different numbers of listeners.
+ *
+ * The program is meant to be run on a private bus, see \c bench_e2e.sh.
+ */
+/*!@{*/
+
+ssize_t (*os_read)(int fd, void *dest, size_t count) = read;
+ssize_t (*os_write)(int fd, const void *buf, size_t count) = write;
+
+static std::mt19937 rng(42);
+
+using Clock = std::chrono::steady_clock;
+
+static double ms_since(const Clock::time_point &start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/*!
+ * Range of answer times of a simulated peer, uniformly distributed.
+ */
+struct Delay
+{
+    unsigned int min_ms_;
+    unsigned int max_ms_;
+
+    unsigned int sample() const
+    {
+        return std::uniform_int_distribution<unsigned int>(min_ms_, max_ms_)(rng);
+    }
+};
+
+struct Parameters
+{
+    unsigned int players_;
+    unsigned int sources_per_player_;
+    Delay player_delay_;
+    Delay source_delay_;
+    unsigned int requests_;
+    unsigned int listeners_;
+    unsigned int timeout_ms_;
+};
+
+static gboolean run_deferred(gpointer user_data)
+{
+    auto *fn = static_cast<std::function<void()> *>(user_data);
+    (*fn)();
+    delete fn;
+    return G_SOURCE_REMOVE;
+}
+
+static void answer_after(const Delay &delay, std::function<void()> &&fn)
+{
+    const unsigned int ms = delay.sample();
+
+    if(ms == 0)
+        fn();
+    else
+        g_timeout_add(ms, run_deferred, new std::function<void()>(std::move(fn)));
+}
+
+/*!
+ * Percentiles of a series of measurements in milliseconds.
+ */
+class Series
+{
+  private:
+    std::vector<double> values_;
+    bool is_sorted_;
+
+  public:
+    Series(const Series &) = delete;
+    Series &operator=(const Series &) = delete;
+
+    explicit Series(): is_sorted_(true) {}
+
+    void add(double ms)
+    {
+        values_.push_back(ms);
+        is_sorted_ = false;
+    }
+
+    size_t size() const { return values_.size(); }
+
+    double get_percentile(unsigned int percent)
+    {
+        if(values_.empty())
+            return 0.0;
+
+        if(!is_sorted_)
+        {
+            std::sort(values_.begin(), values_.end());
+            is_sorted_ = true;
+        }
+
+        size_t idx = (values_.size() * percent + 99) / 100;
+        return values_[idx > 0 ? idx - 1 : 0];
+    }
+
+    void print(const char *name, double total_ms)
+    {
+        printf("%-20s %8zu %8.2f %8.2f %8.2f %8.2f %10.1f\n", name, size(),
+               get_percentile(50), get_percentile(95),
+               get_percentile(99), get_percentile(100),
+               total_ms > 0.0 ? size() * 1000.0 / total_ms : 0.0);
+    }
+};
+
+/*!
+ * Simulated player or audio source, exported on the bus.
+ */
+struct Peer
+{
+    std::string id_;
+    std::string player_id_;
+    std::string object_path_;
+    Delay delay_;
+    GDBusInterfaceSkeleton *skeleton_;
+    unsigned int calls_;
+};
+
+static gboolean handle_activate(tdbusaupathPlayer *object,
+                                GDBusMethodInvocation *invocation,
+                                GVariant *arg_request_data, Peer *peer)
+{
+    ++peer->calls_;
+    answer_after(peer->delay_,
+                 [object, invocation]
+                 { tdbus_aupath_player_complete_activate(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_deactivate(tdbusaupathPlayer *object,
+                                  GDBusMethodInvocation *invocation,
+                                  GVariant *arg_request_data, Peer *peer)
+{
+    ++peer->calls_;
+    answer_after(peer->delay_,
+                 [object, invocation]
+                 { tdbus_aupath_player_complete_deactivate(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_selected_on_hold(tdbusaupathSource *object,
+                                        GDBusMethodInvocation *invocation,
+                                        const gchar *source_id,
+                                        GVariant *arg_request_data, Peer *peer)
+{
+    ++peer->calls_;
+    answer_after(peer->delay_,
+                 [object, invocation]
+                 { tdbus_aupath_source_complete_selected_on_hold(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_selected(tdbusaupathSource *object,
+                                GDBusMethodInvocation *invocation,
+                                const gchar *source_id,
+                                GVariant *arg_request_data, Peer *peer)
+{
+    ++peer->calls_;
+    answer_after(peer->delay_,
+                 [object, invocation]
+                 { tdbus_aupath_source_complete_selected(object, invocation); });
+    return TRUE;
+}
+
+static gboolean handle_deselected(tdbusaupathSource *object,
+                                  GDBusMethodInvocation *invocation,
+                                  const gchar *source_id,
+                                  GVariant *arg_request_data, Peer *peer)
+{
+    ++peer->calls_;
+    answer_after(peer->delay_,
+                 [object, invocation]
+                 { tdbus_aupath_source_complete_deselected(object, invocation); });
+    return TRUE;
+}
+
+static bool export_peer(GDBusConnection *connection, Peer &peer)
+{
+    GErrorWrapper error;
+    g_dbus_interface_skeleton_export(peer.skeleton_, connection,
+                                     peer.object_path_.c_str(), error.await());
+    return !error.log_failure("Export simulated peer");
+}
+
+static void mk_peers(const Parameters &params,
+                     std::vector<Peer> &players, std::vector<Peer> &sources)
+{
+    players.reserve(params.players_);
+    sources.reserve(params.players_ * params.sources_per_player_);
+
+    for(unsigned int p = 0; p < params.players_; ++p)
+    {
+        const std::string pid("sim_player_" + std::to_string(p));
+
+        players.push_back(Peer{pid, pid,
+                               "/de/tahifi/TAPSwitchSim/Player" + std::to_string(p),
+                               params.player_delay_,
+                               G_DBUS_INTERFACE_SKELETON(tdbus_aupath_player_skeleton_new()),
+                               0});
+
+        for(unsigned int s = 0; s < params.sources_per_player_; ++s)
+        {
+            const std::string suffix(std::to_string(p) + "_" + std::to_string(s));
+
+            sources.push_back(Peer{"sim_source_" + suffix, pid,
+                                   "/de/tahifi/TAPSwitchSim/Source" + suffix,
+                                   params.source_delay_,
+                                   G_DBUS_INTERFACE_SKELETON(tdbus_aupath_source_skeleton_new()),
+                                   0});
+        }
+    }
+
+    /* signal handlers take pointers into the vectors, so connect them only
+     * after all elements have been added */
+    for(auto &p : players)
+    {
+        g_signal_connect(p.skeleton_, "handle-activate",
+                         G_CALLBACK(handle_activate), &p);
+        g_signal_connect(p.skeleton_, "handle-deactivate",
+                         G_CALLBACK(handle_deactivate), &p);
+    }
+
+    for(auto &s : sources)
+    {
+        g_signal_connect(s.skeleton_, "handle-selected-on-hold",
+                         G_CALLBACK(handle_selected_on_hold), &s);
+        g_signal_connect(s.skeleton_, "handle-selected",
+                         G_CALLBACK(handle_selected), &s);
+        g_signal_connect(s.skeleton_, "handle-deselected",
+                         G_CALLBACK(handle_deselected), &s);
+    }
+}
+
+static void free_peers(std::vector<Peer> &peers)
+{
+    for(auto &p : peers)
+    {
+        g_dbus_interface_skeleton_unexport(p.skeleton_);
+        g_object_unref(p.skeleton_);
+    }
+
+    peers.clear();
+}
+
+struct RegistrationStorm
+{
+    tdbusaupathManager *proxy_;
+    unsigned int outstanding_;
+    unsigned int failed_;
+};
+
+static void register_player_done(GObject *source_object, GAsyncResult *res,
+                                 gpointer user_data)
+{
+    auto &storm = *static_cast<RegistrationStorm *>(user_data);
+    GErrorWrapper error;
+
+    tdbus_aupath_manager_call_register_player_finish(storm.proxy_, res,
+                                                     error.await());
+
+    if(error.log_failure("Register player"))
+        ++storm.failed_;
+
+    --storm.outstanding_;
+}
+
+static void register_source_done(GObject *source_object, GAsyncResult *res,
+                                 gpointer user_data)
+{
+    auto &storm = *static_cast<RegistrationStorm *>(user_data);
+    GErrorWrapper error;
+
+    tdbus_aupath_manager_call_register_source_finish(storm.proxy_, res,
+                                                     error.await());
+
+    if(error.log_failure("Register source"))
+        ++storm.failed_;
+
+    --storm.outstanding_;
+}
+
+static bool run_registration_storm(tdbusaupathManager *proxy,
+                                   const std::vector<Peer> &players,
+                                   const std::vector<Peer> &sources,
+                                   unsigned int timeout_ms)
+{
+    RegistrationStorm storm{proxy, 0, 0};
+    const auto start = Clock::now();
+
+    for(const auto &s : sources)
+    {
+        ++storm.outstanding_;
+        tdbus_aupath_manager_call_register_source(
+            proxy, s.id_.c_str(), "Simulated audio source", s.player_id_.c_str(),
+            s.object_path_.c_str(), nullptr, register_source_done, &storm);
+    }
+
+    for(const auto &p : players)
+    {
+        ++storm.outstanding_;
+        tdbus_aupath_manager_call_register_player(
+            proxy, p.id_.c_str(), "Simulated player",
+            p.object_path_.c_str(), nullptr, register_player_done, &storm);
+    }
+
+    if(!BenchDBus::run_until([&storm] { return storm.outstanding_ == 0; },
+                             timeout_ms))
+    {
+        fprintf(stderr, "Timeout during registration storm\n");
+        return false;
+    }
+
+    const double total_ms = ms_since(start);
+    const size_t n = players.size() + sources.size();
+
+    printf("%-20s %8s %8s %10s %12s\n",
+           "registration", "players", "sources", "total ms", "us/register");
+    printf("%-20s %8zu %8zu %10.2f %12.1f\n\n",
+           "storm", players.size(), sources.size(), total_ms,
+           total_ms * 1000.0 / n);
+
+    return storm.failed_ == 0;
+}
+
+/*!
+ * Bus connection which only listens for \c PathActivated signals.
+ */
+struct Listener
+{
+    GDBusConnection *connection_;
+    tdbusaupathManager *proxy_;
+    const std::string *expected_source_id_;
+    bool has_seen_signal_;
+};
+
+static void path_activated(tdbusaupathManager *object, const gchar *source_id,
+                           const gchar *player_id, GVariant *request_data,
+                           Listener *listener)
+{
+    if(listener->expected_source_id_ != nullptr &&
+       *listener->expected_source_id_ == source_id)
+        listener->has_seen_signal_ = true;
+}
+
+static bool mk_listeners(std::vector<Listener> &listeners, unsigned int count)
+{
+    GErrorWrapper error;
+    gchar *address =
+        g_dbus_address_get_for_bus_sync(G_BUS_TYPE_SESSION, nullptr,
+                                        error.await());
+
+    if(error.log_failure("Get session bus address"))
+        return false;
+
+    listeners.resize(count);
+
+    bool ok = true;
+
+    for(auto &l : listeners)
+    {
+        l.connection_ =
+            g_dbus_connection_new_for_address_sync(
+                address,
+                GDBusConnectionFlags(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                     G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+                nullptr, nullptr, error.await());
+
+        if(error.log_failure("Connect listener"))
+        {
+            ok = false;
+            break;
+        }
+
+        l.proxy_ =
+            tdbus_aupath_manager_proxy_new_sync(l.connection_,
+                                                G_DBUS_PROXY_FLAGS_NONE,
+                                                BenchDBus::TAPSWITCH_BUS_NAME,
+                                                BenchDBus::TAPSWITCH_OBJECT_PATH,
+                                                nullptr, error.await());
+
+        if(error.log_failure("Create listener proxy"))
+        {
+            ok = false;
+            break;
+        }
+
+        l.expected_source_id_ = nullptr;
+        l.has_seen_signal_ = false;
+        g_signal_connect(l.proxy_, "path-activated",
+                         G_CALLBACK(path_activated), &l);
+    }
+
+    g_free(address);
+
+    return ok;
+}
+
+static void free_listeners(std::vector<Listener> &listeners)
+{
+    for(auto &l : listeners)
+    {
+        if(l.proxy_ != nullptr)
+            g_object_unref(l.proxy_);
+
+        if(l.connection_ != nullptr)
+        {
+            g_dbus_connection_close_sync(l.connection_, nullptr, nullptr);
+            g_object_unref(l.connection_);
+        }
+    }
+
+    listeners.clear();
+}
+
+struct Request
+{
+    tdbusaupathManager *proxy_;
+    bool is_done_;
+    bool failed_;
+};
+
+static void request_source_done(GObject *source_object, GAsyncResult *res,
+                                gpointer user_data)
+{
+    auto &req = *static_cast<Request *>(user_data);
+    GErrorWrapper error;
+    gchar *player_id = nullptr;
+    gboolean switched;
+
+    tdbus_aupath_manager_call_request_source_finish(req.proxy_, &player_id,
+                                                    &switched, res,
+                                                    error.await());
+
+    req.failed_ = error.log_failure("Request source");
+    req.is_done_ = true;
+    g_free(player_id);
+}
+
+static bool run_requests(tdbusaupathManager *proxy,
+                         const std::vector<Peer> &sources,
+                         std::vector<Listener> &listeners,
+                         unsigned int requests, unsigned int timeout_ms)
+{
+    Series round_trip;
+    Series signal_delivery;
+    unsigned int failed = 0;
+    size_t current = sources.size();
+    std::uniform_int_distribution<size_t> pick(0, sources.size() - 1);
+
+    const auto start = Clock::now();
+
+    for(unsigned int i = 0; i < requests; ++i)
+    {
+        size_t next;
+
+        do
+            next = pick(rng);
+        while(next == current && sources.size() > 1);
+
+        current = next;
+
+        for(auto &l : listeners)
+        {
+            l.expected_source_id_ = &sources[next].id_;
+            l.has_seen_signal_ = false;
+        }
+
+        Request req{proxy, false, false};
+        GVariantDict empty;
+        g_variant_dict_init(&empty, nullptr);
+
+        const auto request_start = Clock::now();
+
+        tdbus_aupath_manager_call_request_source(
+            proxy, sources[next].id_.c_str(), g_variant_dict_end(&empty),
+            nullptr, request_source_done, &req);
+
+        if(!BenchDBus::run_until([&req] { return req.is_done_; }, timeout_ms))
+        {
+            fprintf(stderr, "Timeout waiting for answer to request %u\n", i);
+            return false;
+        }
+
+        round_trip.add(ms_since(request_start));
+
+        if(req.failed_)
+        {
+            ++failed;
+            continue;
+        }
+
+        if(listeners.empty())
+            continue;
+
+        const bool all_seen =
+            BenchDBus::run_until(
+                [&listeners]
+                {
+                    return std::all_of(listeners.begin(), listeners.end(),
+                                       [] (const Listener &l)
+                                       { return l.has_seen_signal_; });
+                },
+                timeout_ms);
+
+        if(!all_seen)
+        {
+            fprintf(stderr, "Timeout waiting for signal after request %u\n", i);
+            return false;
+        }
+
+        signal_delivery.add(ms_since(request_start));
+    }
+
+    const double total_ms = ms_since(start);
+
+    for(auto &l : listeners)
+        l.expected_source_id_ = nullptr;
+
+    printf("%-20s %8s %8s %8s %8s %8s %10s\n",
+           "measurement", "count", "p50 ms", "p95 ms", "p99 ms", "max ms", "per s");
+    round_trip.print("request round trip", total_ms);
+
+    if(!listeners.empty())
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "signal to %zu", listeners.size());
+        signal_delivery.print(name, total_ms);
+    }
+
+    if(failed > 0)
+        fprintf(stderr, "%u of %u requests failed\n", failed, requests);
+
+    return failed == 0;
+}
+
+static bool set_appliance_ready(GDBusConnection *connection)
+{
+    GErrorWrapper error;
+    tdbusaupathAppliance *proxy =
+        tdbus_aupath_appliance_proxy_new_sync(connection,
+                                              G_DBUS_PROXY_FLAGS_NONE,
+                                              BenchDBus::TAPSWITCH_BUS_NAME,
+                                              BenchDBus::TAPSWITCH_OBJECT_PATH,
+                                              nullptr, error.await());
+
+    if(error.log_failure("Create appliance proxy"))
+        return false;
+
+    tdbus_aupath_appliance_call_set_ready_state_sync(proxy, 2, 2, nullptr,
+                                                     error.await());
+    g_object_unref(proxy);
+
+    return !error.log_failure("Set appliance ready");
+}
+
+static void usage(const char *program_name)
+{
+    printf("Usage: %s [options]\n"
+           "\n"
+           "Options:\n"
+           "  --help              Show this help.\n"
+           "  --players n         Number of simulated players (default: 4).\n"
+           "  --sources n         Number of audio sources per player (default: 4).\n"
+           "  --player-delay ms   Answer delay of players, may be given as\n"
+           "                      range min-max (default: 0).\n"
+           "  --source-delay ms   Answer delay of audio sources, may be given\n"
+           "                      as range min-max (default: 0).\n"
+           "  --requests n        Number of audio source requests (default: 1000).\n"
+           "  --listeners n       Number of extra bus connections listening for\n"
+           "                      signals (default: 8).\n"
+           "  --timeout ms        Timeout for each step (default: 10000).\n",
+           program_name);
+}
+
+static bool parse_delay(const char *arg, Delay &delay)
+{
+    const char *sep = strchr(arg, '-');
+
+    if(sep == nullptr)
+    {
+        if(!BenchDBus::parse_uint(arg, delay.min_ms_))
+            return false;
+
+        delay.max_ms_ = delay.min_ms_;
+        return true;
+    }
+
+    return BenchDBus::parse_uint(std::string(arg, sep - arg).c_str(),
+                                 delay.min_ms_) &&
+           BenchDBus::parse_uint(sep + 1, delay.max_ms_) &&
+           delay.min_ms_ <= delay.max_ms_;
+}
+
+static int process_command_line(int argc, char *argv[], Parameters &params)
+{
+    params.players_ = 4;
+    params.sources_per_player_ = 4;
+    params.player_delay_ = Delay{0, 0};
+    params.source_delay_ = Delay{0, 0};
+    params.requests_ = 1000;
+    params.listeners_ = 8;
+    params.timeout_ms_ = 10000;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--help") == 0)
+            return 1;
+
+        if(i + 1 >= argc)
+        {
+            fprintf(stderr, "Option %s missing argument or unknown. "
+                    "Please try --help.\n", argv[i]);
+            return -1;
+        }
+
+        bool ok;
+        const char *arg = argv[i];
+        const char *value = argv[++i];
+
+        if(strcmp(arg, "--players") == 0)
+            ok = BenchDBus::parse_uint(value, params.players_) &&
+                 params.players_ > 0;
+        else if(strcmp(arg, "--sources") == 0)
+            ok = BenchDBus::parse_uint(value, params.sources_per_player_) &&
+                 params.sources_per_player_ > 0;
+        else if(strcmp(arg, "--player-delay") == 0)
+            ok = parse_delay(value, params.player_delay_);
+        else if(strcmp(arg, "--source-delay") == 0)
+            ok = parse_delay(value, params.source_delay_);
+        else if(strcmp(arg, "--requests") == 0)
+            ok = BenchDBus::parse_uint(value, params.requests_);
+        else if(strcmp(arg, "--listeners") == 0)
+            ok = BenchDBus::parse_uint(value, params.listeners_);
+        else if(strcmp(arg, "--timeout") == 0)
+            ok = BenchDBus::parse_uint(value, params.timeout_ms_) &&
+                 params.timeout_ms_ > 0;
+        else
+        {
+            fprintf(stderr, "Unknown option \"%s\". Please try --help.\n", arg);
+            return -1;
+        }
+
+        if(!ok)
+        {
+            fprintf(stderr, "Invalid argument \"%s\" for option %s\n", value, arg);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_NORMAL);
+
+    Parameters params;
+    const int ret = process_command_line(argc, argv, params);
+
+    if(ret != 0)
+    {
+        usage(argv[0]);
+        return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    GErrorWrapper error;
+    GDBusConnection *connection =
+        g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, error.await());
+
+    if(error.log_failure("Connect to session bus"))
+        return EXIT_FAILURE;
+
+    std::vector<Peer> players;
+    std::vector<Peer> sources;
+    std::vector<Listener> listeners;
+    tdbusaupathManager *proxy = nullptr;
+    bool ok = BenchDBus::wait_for_tapswitch(connection, params.timeout_ms_);
+
+    if(ok)
+    {
+        proxy = tdbus_aupath_manager_proxy_new_sync(connection,
+                                                    G_DBUS_PROXY_FLAGS_NONE,
+                                                    BenchDBus::TAPSWITCH_BUS_NAME,
+                                                    BenchDBus::TAPSWITCH_OBJECT_PATH,
+                                                    nullptr, error.await());
+        ok = !error.log_failure("Create manager proxy");
+    }
+
+    if(ok)
+    {
+        mk_peers(params, players, sources);
+
+        for(auto &p : players)
+            ok = ok && export_peer(connection, p);
+
+        for(auto &s : sources)
+            ok = ok && export_peer(connection, s);
+    }
+
+    ok = ok && set_appliance_ready(connection);
+    ok = ok && run_registration_storm(proxy, players, sources, params.timeout_ms_);
+    ok = ok && mk_listeners(listeners, params.listeners_);
+    ok = ok && run_requests(proxy, sources, listeners,
+                            params.requests_, params.timeout_ms_);
+
+    if(ok)
+    {
+        unsigned int player_calls = 0;
+        unsigned int source_calls = 0;
+
+        for(const auto &p : players)
+            player_calls += p.calls_;
+
+        for(const auto &s : sources)
+            source_calls += s.calls_;
+
+        printf("\n%-20s %8u\n%-20s %8u\n",
+               "player calls", player_calls, "source calls", source_calls);
+    }
+
+    free_listeners(listeners);
+    free_peers(sources);
+    free_peers(players);
+
+    if(proxy != nullptr)
+        g_object_unref(proxy);
+
+    g_object_unref(connection);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!@}*/
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2020  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2020, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -25,8 +25,56 @@
 
 #include <doctest.h>
 
+#include <cstdlib>
+#include <new>
+#include <tuple>
+
 #include "audiopath.hh"
 
+/*
+ * Replacement of global allocation functions so that tests can find out
+ * whether or not some operation has allocated memory.
+ */
+static bool count_allocations;
+static size_t number_of_allocations;
+
+void *operator new(size_t size)
+{
+    if(count_allocations)
+        ++number_of_allocations;
+
+    void *p = malloc(size > 0 ? size : 1);
+
+    if(p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+class CountAllocations
+{
+  public:
+    CountAllocations(const CountAllocations &) = delete;
+    CountAllocations &operator=(const CountAllocations &) = delete;
+
+    explicit CountAllocations()
+    {
+        number_of_allocations = 0;
+        count_allocations = true;
+    }
+
+    ~CountAllocations() { count_allocations = false; }
+
+    size_t stop()
+    {
+        count_allocations = false;
+        return number_of_allocations;
+    }
+};
+
 /*!
  * \addtogroup audiopath_tests Unit tests
  * \ingroup audiopath
@@ -244,7 +292,7 @@ TEST_CASE("Lookup source without player returns only source")
     const auto ap(paths.lookup_path("src"));
 
     REQUIRE(ap.first != nullptr);
-    CHECK(ap.first->id_ == "src");
+    CHECK(ap.first->id_.str() == "src");
     CHECK(ap.second == nullptr);
 }
 
@@ -271,7 +319,7 @@ TEST_CASE("Add source then player")
                        ++called;
                        REQUIRE(p.first != nullptr);
                        CHECK(p.second == nullptr);
-                       CHECK(p.first->id_ == "s1");
+                       CHECK(p.first->id_.str() == "s1");
                    },
                    AudioPath::Paths::ForEach::UNCONNECTED_SOURCES);
     CHECK(called == 1);
@@ -282,7 +330,7 @@ TEST_CASE("Add source then player")
                        ++called;
                        REQUIRE(p.first != nullptr);
                        CHECK(p.second == nullptr);
-                       CHECK(p.first->id_ == "s1");
+                       CHECK(p.first->id_.str() == "s1");
                    },
                    AudioPath::Paths::ForEach::INCOMPLETE_PATHS);
     CHECK(called == 1);
@@ -296,13 +344,13 @@ TEST_CASE("Add source then player")
     const auto ap(paths.lookup_path("s1"));
 
     REQUIRE(ap.first != nullptr);
-    CHECK(ap.first->id_ == "s1");
+    CHECK(ap.first->id_.str() == "s1");
     CHECK(ap.first->name_ == "Test source");
     CHECK(ap.first->get_dbus_proxy().get()->const_string() == "dbus.source:/dbus/source");
-    CHECK(ap.first->player_id_ == "p1");
+    CHECK(ap.first->player_id_.str() == "p1");
 
     REQUIRE(ap.second != nullptr);
-    CHECK(ap.second->id_ == "p1");
+    CHECK(ap.second->id_.str() == "p1");
     CHECK(ap.second->name_ == "Test player");
     CHECK(ap.second->get_dbus_proxy().get()->const_string() == "dbus.player:/dbus/player");
 
@@ -343,7 +391,7 @@ TEST_CASE("Add player then source")
                        ++called;
                        CHECK(p.first == nullptr);
                        REQUIRE(p.second != nullptr);
-                       CHECK(p.second->id_ == "p1");
+                       CHECK(p.second->id_.str() == "p1");
                    },
                    AudioPath::Paths::ForEach::UNCONNECTED_PLAYERS);
     CHECK(called == 1);
@@ -354,7 +402,7 @@ TEST_CASE("Add player then source")
                        ++called;
                        CHECK(p.first == nullptr);
                        REQUIRE(p.second != nullptr);
-                       CHECK(p.second->id_ == "p1");
+                       CHECK(p.second->id_.str() == "p1");
                    },
                    AudioPath::Paths::ForEach::INCOMPLETE_PATHS);
     CHECK(called == 1);
@@ -368,13 +416,13 @@ TEST_CASE("Add player then source")
     const auto ap(paths.lookup_path("s1"));
 
     REQUIRE(ap.first != nullptr);
-    CHECK(ap.first->id_ == "s1");
+    CHECK(ap.first->id_.str() == "s1");
     CHECK(ap.first->name_ == "Test source");
     CHECK(ap.first->get_dbus_proxy().get()->const_string() == "dbus.source:/dbus/source");
-    CHECK(ap.first->player_id_ == "p1");
+    CHECK(ap.first->player_id_.str() == "p1");
 
     REQUIRE(ap.second != nullptr);
-    CHECK(ap.second->id_ == "p1");
+    CHECK(ap.second->id_.str() == "p1");
     CHECK(ap.second->name_ == "Test player");
     CHECK(ap.second->get_dbus_proxy().get()->const_string() == "dbus.player:/dbus/player");
 
@@ -394,7 +442,7 @@ TEST_CASE("Add player then source")
 
 /*!\test
  * In case a player restarts and registers (again, from our point of view),
- * then only the D-Bus proxy gets updated.
+ * then only the D-Bus proxy and the bus name get updated.
  */
 TEST_CASE("Add player twice updates dbus proxy only")
 {
@@ -409,35 +457,39 @@ TEST_CASE("Add player twice updates dbus proxy only")
     CHECK(static_cast<int>(paths.add_player(
             AudioPath::Player("p1", "Test player",
                               DBus::mk_proxy<AudioPath::Player::PType>("dbus.player",
-                                                                       "/dbus/player")))) ==
+                                                                       "/dbus/player"),
+                              ":1.5"))) ==
           static_cast<int>(AudioPath::Paths::AddResult::NEW_PATH));
 
     const auto ap_first(paths.lookup_path("s1"));
 
     REQUIRE(ap_first.first != nullptr);
     REQUIRE(ap_first.second != nullptr);
-    CHECK(ap_first.second->id_ == "p1");
+    CHECK(ap_first.second->id_.str() == "p1");
     CHECK(ap_first.second->name_ == "Test player");
     CHECK(ap_first.second->get_dbus_proxy().get()->const_string() == "dbus.player:/dbus/player");
+    CHECK(ap_first.second->get_bus_name() == ":1.5");
 
     CHECK(static_cast<int>(paths.add_player(
             AudioPath::Player("p1", "Funky Player",
                               DBus::mk_proxy<AudioPath::Player::PType>("dbus.funky",
-                                                                       "/dbus/funky")))) ==
+                                                                       "/dbus/funky"),
+                              ":1.9"))) ==
           static_cast<int>(AudioPath::Paths::AddResult::UPDATED_PATH));
 
     const auto ap_second(paths.lookup_path("s1"));
 
     REQUIRE(ap_second.first != nullptr);
     REQUIRE(ap_second.second != nullptr);
-    CHECK(ap_second.second->id_ == "p1");
+    CHECK(ap_second.second->id_.str() == "p1");
     CHECK(ap_second.second->name_ == "Test player");
     CHECK(ap_second.second->get_dbus_proxy().get()->const_string() == "dbus.funky:/dbus/funky");
+    CHECK(ap_second.second->get_bus_name() == ":1.9");
 }
 
 /*!\test
  * In case a source restarts and registers (again, from our point of view) as
- * single component, then only the D-Bus proxy gets updated.
+ * single component, then only the D-Bus proxy and the bus name get updated.
  */
 TEST_CASE("Add source component twice updates dbus proxy only")
 {
@@ -446,30 +498,34 @@ TEST_CASE("Add source component twice updates dbus proxy only")
     CHECK(static_cast<int>(paths.add_source(
             AudioPath::Source("s1", "Test source", "p1",
                               DBus::mk_proxy<AudioPath::Source::PType>("dbus.source",
-                                                                       "/dbus/source")))) ==
+                                                                       "/dbus/source"),
+                              ":1.6"))) ==
           static_cast<int>(AudioPath::Paths::AddResult::NEW_COMPONENT));
 
     const auto *src_first(paths.lookup_source("s1"));
 
     REQUIRE(src_first != nullptr);
-    CHECK(src_first->id_ == "s1");
+    CHECK(src_first->id_.str() == "s1");
     CHECK(src_first->name_ == "Test source");
     CHECK(src_first->get_dbus_proxy().get()->const_string() == "dbus.source:/dbus/source");
-    CHECK(src_first->player_id_ == "p1");
+    CHECK(src_first->player_id_.str() == "p1");
+    CHECK(src_first->get_bus_name() == ":1.6");
 
     CHECK(static_cast<int>(paths.add_source(
             AudioPath::Source("s1", "Foo Input", "funky",
                               DBus::mk_proxy<AudioPath::Source::PType>("dbus.foo",
-                                                                       "/dbus/foo")))) ==
+                                                                       "/dbus/foo"),
+                              ":1.8"))) ==
           static_cast<int>(AudioPath::Paths::AddResult::UPDATED_COMPONENT));
 
     const auto *src_second(paths.lookup_source("s1"));
 
     REQUIRE(src_second != nullptr);
-    CHECK(src_second->id_ == "s1");
+    CHECK(src_second->id_.str() == "s1");
     CHECK(src_second->name_ == "Test source");
     CHECK(src_second->get_dbus_proxy().get()->const_string() == "dbus.foo:/dbus/foo");
-    CHECK(src_second->player_id_ == "p1");
+    CHECK(src_second->player_id_.str() == "p1");
+    CHECK(src_second->get_bus_name() == ":1.8");
 }
 
 /*!\test
@@ -495,10 +551,10 @@ TEST_CASE("Add source twice into audio path updates dbus proxy only")
     const auto *src_first(paths.lookup_source("s1"));
 
     REQUIRE(src_first != nullptr);
-    CHECK(src_first->id_ == "s1");
+    CHECK(src_first->id_.str() == "s1");
     CHECK(src_first->name_ == "Test source");
     CHECK(src_first->get_dbus_proxy().get()->const_string() == "dbus.source:/dbus/source");
-    CHECK(src_first->player_id_ == "p1");
+    CHECK(src_first->player_id_.str() == "p1");
 
     CHECK(static_cast<int>(paths.add_source(
             AudioPath::Source("s1", "Foo Input", "funky",
@@ -509,10 +565,10 @@ TEST_CASE("Add source twice into audio path updates dbus proxy only")
     const auto *src_second(paths.lookup_source("s1"));
 
     REQUIRE(src_second != nullptr);
-    CHECK(src_second->id_ == "s1");
+    CHECK(src_second->id_.str() == "s1");
     CHECK(src_second->name_ == "Test source");
     CHECK(src_second->get_dbus_proxy().get()->const_string() == "dbus.foo:/dbus/foo");
-    CHECK(src_second->player_id_ == "p1");
+    CHECK(src_second->player_id_.str() == "p1");
 }
 
 /*!\test
@@ -583,9 +639,9 @@ TEST_CASE("Add multiple sources for same player then add player")
 
     paths.for_each([&seen] (const AudioPath::Paths::Path &p)
                    {
-                       CHECK(p.second->id_ == "ThePlayer");
-                       CHECK(seen.find(p.first->id_) != seen.end());
-                       seen[p.first->id_] = true;
+                       CHECK(p.second->id_.str() == "ThePlayer");
+                       CHECK(seen.find(p.first->id_.str()) != seen.end());
+                       seen[p.first->id_.str()] = true;
                    });
 
     CHECK(seen.size() == size_t(4));
@@ -598,4 +654,444 @@ TEST_CASE("Add multiple sources for same player then add player")
     expect_no_paths(paths, AudioPath::Paths::ForEach::UNCONNECTED_PLAYERS);
 }
 
+/*!\test
+ * Only the audio sources associated with a player are enumerated for that
+ * player, regardless of the order of registration.
+ */
+TEST_CASE("Enumerate audio sources of specific player")
+{
+    AudioPath::Paths paths;
+
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    paths.add_source(AudioPath::Source("s2", "Source 2", "p2",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source2",
+                                                                                "/dbus/source2")));
+    paths.add_source(AudioPath::Source("s3", "Source 3", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source3",
+                                                                                "/dbus/source3")));
+
+    std::vector<std::string> seen;
+    paths.for_each_source_of_player(AudioPath::IDTable::get_singleton().find("p1"),
+                                    [&seen] (const AudioPath::Paths::Path &p)
+                                    {
+                                        REQUIRE(p.first != nullptr);
+                                        CHECK(p.second == nullptr);
+                                        seen.push_back(p.first->id_.str());
+                                    });
+    REQUIRE(seen.size() == size_t(2));
+    CHECK(seen[0] == "s1");
+    CHECK(seen[1] == "s3");
+
+    CHECK(static_cast<int>(paths.add_player(
+            AudioPath::Player("p1", "Player 1",
+                              DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                       "/dbus/player1")))) ==
+          static_cast<int>(AudioPath::Paths::AddResult::NEW_PATH));
+    CHECK(static_cast<int>(paths.add_player(
+            AudioPath::Player("p3", "Player 3",
+                              DBus::mk_proxy<AudioPath::Player::PType>("dbus.player3",
+                                                                       "/dbus/player3")))) ==
+          static_cast<int>(AudioPath::Paths::AddResult::NEW_COMPONENT));
+
+    /* re-adding a source must not duplicate it in the index */
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+
+    seen.clear();
+    paths.for_each_source_of_player(AudioPath::IDTable::get_singleton().find("p1"),
+                                    [&seen] (const AudioPath::Paths::Path &p)
+                                    {
+                                        REQUIRE(p.second != nullptr);
+                                        CHECK(p.second->id_.str() == "p1");
+                                        seen.push_back(p.first->id_.str());
+                                    });
+    CHECK(seen.size() == size_t(2));
+
+    int called = 0;
+    paths.for_each_source_of_player(AudioPath::IDTable::get_singleton().find("p3"),
+                                    [&called] (const AudioPath::Paths::Path &p) { ++called; });
+    CHECK(called == 0);
+
+    paths.for_each([&called] (const AudioPath::Paths::Path &p)
+                   {
+                       ++called;
+                       REQUIRE(p.second != nullptr);
+                       CHECK(p.second->id_.str() == "p3");
+                   },
+                   AudioPath::Paths::ForEach::UNCONNECTED_PLAYERS);
+    CHECK(called == 1);
+}
+
+/*!\test
+ * Each modification of the registry changes its generation.
+ */
+TEST_CASE("Registry generation changes on modification")
+{
+    AudioPath::Paths paths;
+    const uint64_t initial = paths.get_generation();
+    CHECK(paths.get_generation() == initial);
+
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    const uint64_t after_source = paths.get_generation();
+    CHECK(after_source != initial);
+
+    /* lookups and enumeration do not modify anything */
+    CHECK(paths.lookup_source("s1") != nullptr);
+    paths.for_each([] (const AudioPath::Paths::Path &p) {},
+                   AudioPath::Paths::ForEach::ANY);
+    CHECK(paths.get_generation() == after_source);
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    const uint64_t after_player = paths.get_generation();
+    CHECK(after_player != after_source);
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    CHECK(paths.get_generation() != after_player);
+}
+
+/*!\test
+ * Components are marked dead when their owner vanishes, and revived when
+ * they register again.
+ */
+TEST_CASE("Dead components are revived by registering again")
+{
+    AudioPath::Paths paths;
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+
+    const auto &ids(AudioPath::IDTable::get_singleton());
+    CHECK_FALSE(paths.mark_player_dead(ids.find("p2")));
+    CHECK_FALSE(paths.mark_source_dead(ids.find("s2")));
+
+    CHECK(paths.mark_player_dead(ids.find("p1")));
+    CHECK(paths.mark_source_dead(ids.find("s1")));
+    CHECK_FALSE(paths.mark_player_dead(ids.find("p1")));
+    CHECK_FALSE(paths.mark_source_dead(ids.find("s1")));
+
+    auto path(paths.lookup_path("s1"));
+    REQUIRE(path.first != nullptr);
+    REQUIRE(path.second != nullptr);
+    CHECK_FALSE(path.first->is_alive());
+    CHECK_FALSE(path.second->is_alive());
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    CHECK(paths.lookup_player("p1")->is_alive());
+    CHECK_FALSE(paths.lookup_source("s1")->is_alive());
+
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    CHECK(paths.lookup_source("s1")->is_alive());
+}
+
+using ReportedChange = std::tuple<std::string, std::string, bool>;
+
+static std::vector<ReportedChange>
+collect_changes(const AudioPath::Paths &paths, uint64_t generation)
+{
+    REQUIRE(paths.can_report_changes_since(generation));
+
+    std::vector<ReportedChange> result;
+    paths.for_each_change_since(generation,
+        [&result]
+        (const AudioPath::ID &source_id, const AudioPath::ID &player_id,
+         bool removed)
+        {
+            result.emplace_back(source_id.str(), player_id.str(), removed);
+        });
+
+    return result;
+}
+
+/*!\test
+ * Changes of paths are reported relative to a given generation.
+ */
+TEST_CASE("Changes since some generation are reported")
+{
+    AudioPath::Paths paths;
+    const uint64_t initial = paths.get_generation();
+
+    CHECK(collect_changes(paths, initial).empty());
+
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    paths.add_player(AudioPath::Player("p2", "Player 2",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player2",
+                                                                                "/dbus/player2")));
+    const uint64_t before_p1 = paths.get_generation();
+
+    auto changes(collect_changes(paths, initial));
+    REQUIRE(changes.size() == size_t(2));
+    CHECK(changes[0] == ReportedChange("", "p2", false));
+    CHECK(changes[1] == ReportedChange("s1", "", false));
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+
+    /* incomplete path has been replaced by complete path */
+    changes = collect_changes(paths, before_p1);
+    REQUIRE(changes.size() == size_t(2));
+    CHECK(changes[0] == ReportedChange("s1", "", true));
+    CHECK(changes[1] == ReportedChange("s1", "p1", false));
+
+    paths.add_source(AudioPath::Source("s2", "Source 2", "p2",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source2",
+                                                                                "/dbus/source2")));
+
+    /* changes of the same path are folded */
+    changes = collect_changes(paths, initial);
+    REQUIRE(changes.size() == size_t(4));
+    CHECK(changes[0] == ReportedChange("", "p2", true));
+    CHECK(changes[1] == ReportedChange("s1", "", true));
+    CHECK(changes[2] == ReportedChange("s1", "p1", false));
+    CHECK(changes[3] == ReportedChange("s2", "p2", false));
+
+    CHECK(collect_changes(paths, paths.get_generation()).empty());
+}
+
+/*!\test
+ * Re-registration of a component is reported as update of its paths.
+ */
+TEST_CASE("Updated components are reported as changed paths")
+{
+    AudioPath::Paths paths;
+
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    const uint64_t generation = paths.get_generation();
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+
+    const auto changes(collect_changes(paths, generation));
+    REQUIRE(changes.size() == size_t(1));
+    CHECK(changes[0] == ReportedChange("s1", "p1", false));
+}
+
+/*!\test
+ * Paths of dead components are reported as removed, and as changed again
+ * when the components are revived.
+ */
+TEST_CASE("Dead components are reported as removed paths")
+{
+    AudioPath::Paths paths;
+
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+    paths.add_source(AudioPath::Source("s1", "Source 1", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source1",
+                                                                                "/dbus/source1")));
+    paths.add_source(AudioPath::Source("s2", "Source 2", "p1",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source2",
+                                                                                "/dbus/source2")));
+    const uint64_t before_player_death = paths.get_generation();
+
+    /* audio sources of dead player remain as incomplete paths */
+    const auto &ids(AudioPath::IDTable::get_singleton());
+    CHECK(paths.mark_player_dead(ids.find("p1")));
+    CHECK(paths.get_generation() != before_player_death);
+
+    auto changes(collect_changes(paths, before_player_death));
+    REQUIRE(changes.size() == size_t(4));
+    CHECK(changes[0] == ReportedChange("s1", "", false));
+    CHECK(changes[1] == ReportedChange("s1", "p1", true));
+    CHECK(changes[2] == ReportedChange("s2", "", false));
+    CHECK(changes[3] == ReportedChange("s2", "p1", true));
+
+    const uint64_t before_source_death = paths.get_generation();
+
+    CHECK(paths.mark_source_dead(ids.find("s2")));
+    CHECK(paths.get_generation() != before_source_death);
+
+    changes = collect_changes(paths, before_source_death);
+    REQUIRE(changes.size() == size_t(1));
+    CHECK(changes[0] == ReportedChange("s2", "", true));
+
+    const uint64_t before_revival = paths.get_generation();
+
+    /* the dead audio source does not form a path with the revived player */
+    paths.add_player(AudioPath::Player("p1", "Player 1",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player1",
+                                                                                "/dbus/player1")));
+
+    changes = collect_changes(paths, before_revival);
+    REQUIRE(changes.size() == size_t(2));
+    CHECK(changes[0] == ReportedChange("s1", "", true));
+    CHECK(changes[1] == ReportedChange("s1", "p1", false));
+}
+
+/*!\test
+ * Clients must fetch a full snapshot if the change log has wrapped around.
+ */
+TEST_CASE("Changes are not available after change log has wrapped")
+{
+    AudioPath::Paths paths(4);
+    const uint64_t initial = paths.get_generation();
+
+    CHECK_FALSE(paths.can_report_changes_since(0));
+    CHECK(paths.can_report_changes_since(initial));
+    CHECK_FALSE(paths.can_report_changes_since(initial + 1));
+
+    for(int i = 0; i < 4; ++i)
+    {
+        const std::string id("p" + std::to_string(i));
+        paths.add_player(AudioPath::Player(id.c_str(), "Player",
+                                           DBus::mk_proxy<AudioPath::Player::PType>("dbus.player",
+                                                                                    "/dbus/player")));
+    }
+
+    CHECK(collect_changes(paths, initial).size() == size_t(4));
+
+    const uint64_t before_wrap = paths.get_generation();
+
+    paths.add_player(AudioPath::Player("p4", "Player",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player",
+                                                                                "/dbus/player")));
+
+    CHECK_FALSE(paths.can_report_changes_since(initial));
+    CHECK(paths.can_report_changes_since(initial + 1));
+
+    const auto changes(collect_changes(paths, before_wrap));
+    REQUIRE(changes.size() == size_t(1));
+    CHECK(changes[0] == ReportedChange("", "p4", false));
+}
+
+/*!\test
+ * Interning the same ID string twice yields the same handle, and the string
+ * can be retrieved from the handle.
+ */
+TEST_CASE("Interned IDs are compared by handle")
+{
+    auto &table(AudioPath::IDTable::get_singleton());
+
+    const auto a(table.intern("interned_a"));
+    const auto b(table.intern("interned_b"));
+
+    CHECK_FALSE(a.empty());
+    CHECK_FALSE(b.empty());
+    CHECK(a != b);
+    CHECK(table.intern(std::string("interned_a")) == a);
+    CHECK(table.find("interned_b") == b);
+    CHECK(a.str() == "interned_a");
+    CHECK(b.str() == "interned_b");
+
+    const auto size_before(table.size());
+    CHECK(table.find("never_interned").empty());
+    CHECK(table.size() == size_before);
+
+    CHECK(table.intern("").empty());
+    CHECK(AudioPath::ID().str() == "");
+}
+
+/*!\test
+ * Looking up components and paths by string ID does not allocate memory,
+ * regardless of whether the ID is known or not.
+ */
+TEST_CASE("Lookups by string ID do not allocate memory")
+{
+    AudioPath::Paths paths;
+
+    paths.add_source(AudioPath::Source("alloc_src", "Source", "alloc_player",
+                                       DBus::mk_proxy<AudioPath::Source::PType>("dbus.source",
+                                                                                "/dbus/source")));
+    paths.add_player(AudioPath::Player("alloc_player", "Player",
+                                       DBus::mk_proxy<AudioPath::Player::PType>("dbus.player",
+                                                                                "/dbus/player")));
+
+    const std::string source_id("alloc_src");
+    const std::string long_unknown_id("this is an unknown ID which is too long for SSO");
+
+    CountAllocations counter;
+
+    const auto *player = paths.lookup_player("alloc_player");
+    const auto *source = paths.lookup_source(source_id);
+    const auto path = paths.lookup_path("alloc_src");
+    const auto *unknown_player = paths.lookup_player(long_unknown_id.c_str());
+    const auto *unknown_source = paths.lookup_source(long_unknown_id);
+    const auto unknown_path = paths.lookup_path("");
+
+    const size_t allocations = counter.stop();
+
+    CHECK(allocations == 0);
+    REQUIRE(player != nullptr);
+    REQUIRE(source != nullptr);
+    CHECK(player->id_.str() == "alloc_player");
+    CHECK(source->id_.str() == "alloc_src");
+    CHECK(path.first == source);
+    CHECK(path.second == player);
+    CHECK(unknown_player == nullptr);
+    CHECK(unknown_source == nullptr);
+    CHECK(unknown_path.first == nullptr);
+    CHECK(unknown_path.second == nullptr);
+}
+
+template <template <typename> class StorageType>
+static void check_storage_backend()
+{
+    struct Item
+    {
+        const AudioPath::ID id_;
+        int value_;
+    };
+
+    auto &table(AudioPath::IDTable::get_singleton());
+    StorageType<Item> storage;
+
+    CHECK(storage.find(table.intern("storage_item_0")) == nullptr);
+
+    for(int i = 0; i < 100; ++i)
+        storage.insert(Item{table.intern("storage_item_" + std::to_string(i)), i});
+
+    CHECK(storage.size() == size_t(100));
+
+    for(int i = 0; i < 100; ++i)
+    {
+        const auto *item = storage.find(table.find("storage_item_" + std::to_string(i)));
+        REQUIRE(item != nullptr);
+        CHECK(item->value_ == i);
+    }
+
+    CHECK(storage.find(table.intern("storage_item_100")) == nullptr);
+
+    int sum = 0;
+    size_t count = 0;
+    storage.for_each([&sum, &count] (const Item &item) { sum += item.value_; ++count; });
+    CHECK(count == size_t(100));
+    CHECK(sum == 4950);
+}
+
+/*!\test
+ * All registry storage backends implement the same semantics.
+ */
+TEST_CASE("Registry storage backends store and find items")
+{
+    check_storage_backend<AudioPath::Storage::Map>();
+    check_storage_backend<AudioPath::Storage::FlatVector>();
+    check_storage_backend<AudioPath::Storage::OpenHash>();
+}
+
 /*!@}*/
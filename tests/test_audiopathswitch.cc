@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2017, 2018, 2020--2022  T+A elektroakustik GmbH & Co. KG
+ * Copyright (C) 2017, 2018, 2020--2022, 2026  T+A elektroakustik GmbH & Co. KG
  *
  * This file is part of TAPSwitch.
  *
@@ -25,11 +25,15 @@
 
 #include <doctest.h>
 
+#include <algorithm>
+
 #include <glib.h>
 
 #include "audiopath.hh"
 #include "audiopathswitch.hh"
 #include "appliance.hh"
+#include "flightrecorder.hh"
+#include "peerstatistics.hh"
 
 #include "mock_messages.hh"
 #include "mock_audiopath_dbus.hh"
@@ -121,32 +125,41 @@ class Fixture
 
         paths->add_source(AudioPath::Source(
                 "srcA1", "Source A", "pl1",
-                DBus::mk_proxy<AudioPath::Source::PType>("A", "/dbus/sourceA")));
+                DBus::mk_proxy<AudioPath::Source::PType>("A", "/dbus/sourceA"),
+                ":1.10"));
         paths->add_source(AudioPath::Source(
                 "srcB1", "Source B", "pl1",
-                DBus::mk_proxy<AudioPath::Source::PType>("B", "/dbus/sourceB")));
+                DBus::mk_proxy<AudioPath::Source::PType>("B", "/dbus/sourceB"),
+                ":1.11"));
         paths->add_source(AudioPath::Source(
                 "srcC2", "Source C", "pl2",
-                DBus::mk_proxy<AudioPath::Source::PType>("C", "/dbus/sourceC")));
+                DBus::mk_proxy<AudioPath::Source::PType>("C", "/dbus/sourceC"),
+                ":1.12"));
         paths->add_source(AudioPath::Source(
                 "srcD-", "Source D", "player_does_not_exist",
-                DBus::mk_proxy<AudioPath::Source::PType>("D", "/dbus/sourceD")));
+                DBus::mk_proxy<AudioPath::Source::PType>("D", "/dbus/sourceD"),
+                ":1.13"));
         paths->add_source(AudioPath::Source(
                 "srcE3", "Source E", "pl3",
-                DBus::mk_proxy<AudioPath::Source::PType>("E", "/dbus/sourceE")));
+                DBus::mk_proxy<AudioPath::Source::PType>("E", "/dbus/sourceE"),
+                ":1.14"));
 
         paths->add_player(AudioPath::Player(
                 "pl1", "Player 1",
-                DBus::mk_proxy<AudioPath::Player::PType>("1", "/dbus/player1")));
+                DBus::mk_proxy<AudioPath::Player::PType>("1", "/dbus/player1"),
+                ":1.1"));
         paths->add_player(AudioPath::Player(
                 "pl2", "Player 2",
-                DBus::mk_proxy<AudioPath::Player::PType>("2", "/dbus/player2")));
+                DBus::mk_proxy<AudioPath::Player::PType>("2", "/dbus/player2"),
+                ":1.2"));
         paths->add_player(AudioPath::Player(
                 "pl3", "Player 3",
-                DBus::mk_proxy<AudioPath::Player::PType>("3", "/dbus/player3")));
+                DBus::mk_proxy<AudioPath::Player::PType>("3", "/dbus/player3"),
+                ":1.3"));
         paths->add_player(AudioPath::Player(
                 "pl-", "Unused player",
-                DBus::mk_proxy<AudioPath::Player::PType>("-", "/dbus/player-")));
+                DBus::mk_proxy<AudioPath::Player::PType>("-", "/dbus/player-"),
+                ":1.4"));
 
         mock_messages->ignore_messages_above(MESSAGE_LEVEL_DIAG);
     }
@@ -166,6 +179,112 @@ class Fixture
         MockMessages::singleton = nullptr;
         MockAudiopathDBus::singleton = nullptr;
     }
+
+  protected:
+    /*
+     * The following functions start an asynchronous switch operation, answer
+     * all D-Bus calls emitted by the switch, and return the result.
+     */
+
+    AudioPath::Switch::ActivateResult
+    activate_source(const char *source_id, const AudioPath::ID *&player_id,
+                    AudioPath::Switch::DeselectedAudioSourceResult &deselected_result,
+                    bool select_source_now,
+                    GVariantWrapper &&request_data = GVariantWrapper())
+    {
+        bool done = false;
+        AudioPath::Switch::ActivateResult result;
+        auto fn =
+            [&done, &result, &player_id, &deselected_result]
+            (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+             AudioPath::Switch::DeselectedAudioSourceResult dres)
+            {
+                done = true;
+                result = res;
+                player_id = pid;
+                deselected_result = dres;
+            };
+
+        if(request_data == nullptr)
+            pswitch->activate_source(*paths, source_id, select_source_now,
+                                     std::move(fn));
+        else
+            pswitch->activate_source(*paths, source_id, select_source_now,
+                                     std::move(request_data), std::move(fn));
+
+        mock_audiopath_dbus->complete_all_calls();
+        REQUIRE(done);
+        CHECK_FALSE(pswitch->is_busy());
+        return result;
+    }
+
+    AudioPath::Switch::ReleaseResult
+    release_path(bool kill_player, const AudioPath::ID *&player_id,
+                 AudioPath::Switch::DeselectedAudioSourceResult &deselected_result)
+    {
+        bool done = false;
+        AudioPath::Switch::ReleaseResult result;
+
+        pswitch->release_path(*paths, kill_player,
+            [&done, &result, &player_id, &deselected_result]
+            (AudioPath::Switch::ReleaseResult res, const AudioPath::ID *pid,
+             AudioPath::Switch::DeselectedAudioSourceResult dres)
+            {
+                done = true;
+                result = res;
+                player_id = pid;
+                deselected_result = dres;
+            });
+
+        mock_audiopath_dbus->complete_all_calls();
+        REQUIRE(done);
+        CHECK_FALSE(pswitch->is_busy());
+        return result;
+    }
+
+    AudioPath::Switch::ActivateResult
+    complete_pending_source_activation(std::string *source_id)
+    {
+        bool done = false;
+        AudioPath::Switch::ActivateResult result;
+
+        pswitch->complete_pending_source_activation(*paths,
+            [&done, &result, source_id]
+            (AudioPath::Switch::ActivateResult res, const AudioPath::ID &sid)
+            {
+                done = true;
+                result = res;
+
+                if(source_id != nullptr)
+                    *source_id = sid.str();
+            });
+
+        mock_audiopath_dbus->complete_all_calls();
+        REQUIRE(done);
+        CHECK_FALSE(pswitch->is_busy());
+        return result;
+    }
+
+    AudioPath::Switch::ActivateResult
+    cancel_pending_source_activation(std::string &source_id)
+    {
+        bool done = false;
+        AudioPath::Switch::ActivateResult result;
+
+        pswitch->cancel_pending_source_activation(*paths,
+            [&done, &result, &source_id]
+            (AudioPath::Switch::ActivateResult res, const AudioPath::ID &sid)
+            {
+                done = true;
+                result = res;
+                source_id = sid.str();
+            });
+
+        mock_audiopath_dbus->complete_all_calls();
+        REQUIRE(done);
+        CHECK_FALSE(pswitch->is_busy());
+        return result;
+    }
 };
 
 /*!\test
@@ -175,48 +294,48 @@ TEST_CASE_FIXTURE(Fixture, "Switch complete path")
 {
     CHECK(pswitch->get_player_id().empty());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* switch to other source */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
 
     /* switch back to first source */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -226,7 +345,7 @@ TEST_CASE_FIXTURE(Fixture, "Switch complete path with request data")
 {
     CHECK(pswitch->get_player_id().empty());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
@@ -236,16 +355,16 @@ TEST_CASE_FIXTURE(Fixture, "Switch complete path with request data")
     g_variant_dict_insert_value(&dict, "my", g_variant_new_string("data"));
     auto request_data(GVariantWrapper(g_variant_dict_end(&dict)));
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'), std::move(GVariantWrapper(request_data)));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'), std::move(GVariantWrapper(request_data)));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true, std::move(request_data))) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true, std::move(request_data))) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* switch to other source */
     g_variant_dict_init(&dict, nullptr);
@@ -253,36 +372,36 @@ TEST_CASE_FIXTURE(Fixture, "Switch complete path with request data")
     g_variant_dict_insert_value(&dict, "dadada", g_variant_new_string("dadata"));
     request_data = std::move(GVariantWrapper(g_variant_dict_end(&dict)));
 
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'), GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'), GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2", GVariantWrapper(request_data));
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true, std::move(request_data))) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true, std::move(request_data))) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
 
     /* switch back to first source */
     g_variant_dict_init(&dict, nullptr);
     g_variant_dict_insert_value(&dict, "foo", g_variant_new_string("qux"));
     request_data = std::move(GVariantWrapper(g_variant_dict_end(&dict)));
 
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2", GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'), GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'), GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1", GVariantWrapper(request_data));
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true, std::move(request_data))) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true, std::move(request_data))) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -290,44 +409,44 @@ TEST_CASE_FIXTURE(Fixture, "Switch complete path with request data")
  */
 TEST_CASE_FIXTURE(Fixture, "Sources for same player")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* switch to other source */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SAME));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* switch back to first source */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SAME));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -335,30 +454,30 @@ TEST_CASE_FIXTURE(Fixture, "Sources for same player")
  */
 TEST_CASE_FIXTURE(Fixture, "Switching to same source is NOP")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
 
     /* second activation */
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_UNCHANGED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -366,45 +485,45 @@ TEST_CASE_FIXTURE(Fixture, "Switching to same source is NOP")
  */
 TEST_CASE_FIXTURE(Fixture, "Switching to nonexistent source keeps current source")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
 
     /* failed activation */
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
             "AUDIO SOURCE SWITCH: Unknown audio source srcD2", false);
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcD2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcD2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN));
 
     CHECK(player_id == nullptr);
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
 
     /* other activation */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -412,43 +531,43 @@ TEST_CASE_FIXTURE(Fixture, "Switching to nonexistent source keeps current source
  */
 TEST_CASE_FIXTURE(Fixture, "Switching to existent source without player keeps current source")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
 
     /* failed activation */
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcD-", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcD-", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN));
 
     CHECK(player_id == nullptr);
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
 
     /* other activation */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -456,52 +575,52 @@ TEST_CASE_FIXTURE(Fixture, "Switching to existent source without player keeps cu
  */
 TEST_CASE_FIXTURE(Fixture, "Switch to failing source for same player kills audio path and keeps player active")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* second activation fails */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, false, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, false, aupath_source_proxy('A'), "srcA1");
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
             "Select source: Got g-io-error-quark error 0: Mock source A selection failure",
             false);
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
             "AUDIO SOURCE SWITCH: Selecting audio source srcA1 failed", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* prove that expected player was still active */
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcE3", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcE3", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl3");
+    CHECK(player_id->str() == "pl3");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl3");
+    CHECK(pswitch->get_player_id().str() == "pl3");
 }
 
 /*!\test
@@ -509,54 +628,54 @@ TEST_CASE_FIXTURE(Fixture, "Switch to failing source for same player kills audio
  */
 TEST_CASE_FIXTURE(Fixture, "Switch to failing source for other player kills audio path and keeps new player active")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* second activation fails */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
             "Select source: Got g-io-error-quark error 0: Mock source C selection failure",
             false);
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
             "AUDIO SOURCE SWITCH: Selecting audio source srcC2 failed", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* prove that expected player was still active */
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcE3", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcE3", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl3");
+    CHECK(player_id->str() == "pl3");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl3");
+    CHECK(pswitch->get_player_id().str() == "pl3");
 }
 
 /*!\test
@@ -564,52 +683,52 @@ TEST_CASE_FIXTURE(Fixture, "Switch to failing source for other player kills audi
  */
 TEST_CASE_FIXTURE(Fixture, "Switch to failing player kills audio path completely")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* first activation */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 
     /* second activation fails */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, false, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, false, aupath_player_proxy('2'));
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
             "Activate player: Got g-io-error-quark error 0: Mock player 2 activation failure",
             false);
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
             "AUDIO SOURCE SWITCH: Activating player pl2 failed", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_PLAYER_FAILED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
     CHECK(pswitch->get_player_id().empty());
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* prove that no player was active */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('3'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('E'), "srcE3");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcE3", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcE3", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl3");
+    CHECK(player_id->str() == "pl3");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl3");
+    CHECK(pswitch->get_player_id().str() == "pl3");
 }
 
 /*!\test
@@ -617,13 +736,13 @@ TEST_CASE_FIXTURE(Fixture, "Switch to failing player kills audio path completely
  */
 TEST_CASE_FIXTURE(Fixture, "Switch to nameless source is rejected")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     expect<MockMessages::MsgError>(mock_messages, EINVAL, LOG_ERR,
             "AUDIO SOURCE SWITCH: Empty audio source ID (Invalid argument)", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN));
 
     CHECK(player_id == nullptr);
@@ -636,25 +755,25 @@ TEST_CASE_FIXTURE(Fixture, "Switch to nameless source is rejected")
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing path deselects source and can deactivate player")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
 
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
 
-    CHECK(static_cast<int>((pswitch->release_path(*paths, true, player_id, deselected_result))) ==
+    CHECK(static_cast<int>((release_path(true, player_id, deselected_result))) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::COMPLETE_RELEASE));
 
     CHECK(player_id == nullptr);
@@ -667,30 +786,30 @@ TEST_CASE_FIXTURE(Fixture, "Releasing path deselects source and can deactivate p
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing path deselects source and can keep player active")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcA1", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
 
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
 
-    CHECK(static_cast<int>(pswitch->release_path(*paths, false, player_id, deselected_result)) ==
+    CHECK(static_cast<int>(release_path(false, player_id, deselected_result)) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::SOURCE_DESELECTED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
 }
 
 /*!\test
@@ -698,10 +817,10 @@ TEST_CASE_FIXTURE(Fixture, "Releasing path deselects source and can keep player
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path with player deactivation request is nop")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    CHECK(static_cast<int>(pswitch->release_path(*paths, false, player_id, deselected_result)) ==
+    CHECK(static_cast<int>(release_path(false, player_id, deselected_result)) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::UNCHANGED));
 
     CHECK(player_id == nullptr);
@@ -714,10 +833,10 @@ TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path with player deactivation re
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path without player deactivation request is nop")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    CHECK(static_cast<int>(pswitch->release_path(*paths, true, player_id, deselected_result)) ==
+    CHECK(static_cast<int>(release_path(true, player_id, deselected_result)) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::UNCHANGED));
 
     CHECK(player_id == nullptr);
@@ -731,30 +850,30 @@ TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path without player deactivation
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path with active player can deactivate player")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
             "Select source: Got g-io-error-quark error 0: Mock source C selection failure",
             false);
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
             "AUDIO SOURCE SWITCH: Selecting audio source srcC2 failed", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
 
-    CHECK(static_cast<int>(pswitch->release_path(*paths, true, player_id, deselected_result)) ==
+    CHECK(static_cast<int>(release_path(true, player_id, deselected_result)) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::PLAYER_DEACTIVATED));
 
     CHECK(player_id == nullptr);
@@ -768,34 +887,34 @@ TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path with active player can deac
  */
 TEST_CASE_FIXTURE(Fixture, "Releasing nonactive path with active player can keep player active")
 {
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, false, aupath_source_proxy('C'), "srcC2");
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
             "Select source: Got g-io-error-quark error 0: Mock source C selection failure",
             false);
     expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
             "AUDIO SOURCE SWITCH: Selecting audio source srcC2 failed", false);
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result, true)) ==
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_FAILED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
-    CHECK(static_cast<int>(pswitch->release_path(*paths, false, player_id, deselected_result)) ==
+    CHECK(static_cast<int>(release_path(false, player_id, deselected_result)) ==
           static_cast<int>(AudioPath::Switch::ReleaseResult::UNCHANGED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
 }
 
 /*!\test
@@ -806,32 +925,32 @@ TEST_CASE_FIXTURE(Fixture, "Switch path while appliance is not ready")
     AudioPath::Appliance appliance;
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                     appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance was blocked, now assume it has told us it is ready */
     CHECK(appliance.set_audio_path_ready());
 
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->complete_pending_source_activation(*paths, &source_id)) ==
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     CHECK(source_id == "srcB1");
 }
 
@@ -843,49 +962,49 @@ TEST_CASE_FIXTURE(Fixture, "Switch path during path switch while appliance is no
     AudioPath::Appliance appliance;
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                     appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* activate another source, canceling the deferred source selection */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result,
                                     appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_PENDING);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance was blocked, now assume it has told us it is ready */
     CHECK(appliance.set_audio_path_ready());
 
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->complete_pending_source_activation(*paths, &source_id)) ==
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     CHECK(source_id == "srcC2");
 }
 
@@ -897,7 +1016,7 @@ TEST_CASE_FIXTURE(Fixture, "Switch path with request data while appliance is not
     AudioPath::Appliance appliance;
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate */
@@ -908,29 +1027,29 @@ TEST_CASE_FIXTURE(Fixture, "Switch path with request data while appliance is not
     g_variant_dict_insert_value(&dict, "frog", g_variant_new_string("ribbit"));
     auto request_data(GVariantWrapper(g_variant_dict_end(&dict)));
 
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1", GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1", GVariantWrapper(request_data));
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                             appliance.is_audio_path_ready() == true,
                                             GVariantWrapper(request_data))) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance was blocked, now assume it has told us it is ready */
     CHECK(appliance.set_audio_path_ready());
 
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1", std::move(request_data));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1", std::move(request_data));
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->complete_pending_source_activation(*paths, &source_id)) ==
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     CHECK(source_id == "srcB1");
 }
 
@@ -945,49 +1064,49 @@ TEST_CASE_FIXTURE(Fixture, "Switch path twice while appliance is not ready")
     AudioPath::Appliance appliance;
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate the first time */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                         appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* try to activate the second time */
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
-    expect<MockAudiopathDBus::PlayerDeactivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcC2", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result,
                                         appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl2");
+    CHECK(player_id->str() == "pl2");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_PENDING);
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance was blocked, now assume it has told us it is ready */
     CHECK(appliance.set_audio_path_ready());
 
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->complete_pending_source_activation(*paths, &source_id)) ==
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
-    CHECK(pswitch->get_player_id() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
     CHECK(source_id == "srcC2");
 }
 
@@ -1000,44 +1119,44 @@ TEST_CASE_FIXTURE(Fixture, "Switch to same path twice while appliance is not rea
     AudioPath::Appliance appliance;
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate the first time */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                         appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* try to activate the same audio source again */
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                         appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance was blocked, now assume it has told us it is ready */
     CHECK(appliance.set_audio_path_ready());
 
-    expect<MockAudiopathDBus::SourceSelectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->complete_pending_source_activation(*paths, &source_id)) ==
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     CHECK(source_id == "srcB1");
 }
 
@@ -1050,32 +1169,1113 @@ TEST_CASE_FIXTURE(Fixture, "Activate audio path while appliance is not ready and
     CHECK(appliance.set_up_and_running());
     CHECK(appliance.set_audio_path_blocked());
 
-    const std::string *player_id;
+    const AudioPath::ID *player_id;
     AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
 
     /* try to activate */
-    expect<MockAudiopathDBus::PlayerActivateSync>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
-    expect<MockAudiopathDBus::SourceSelectedOnHoldSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
 
-    CHECK(static_cast<int>(pswitch->activate_source(*paths, "srcB1", player_id, deselected_result,
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
                                         appliance.is_audio_path_ready() == true)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
 
     REQUIRE(player_id != nullptr);
-    CHECK(*player_id == "pl1");
+    CHECK(player_id->str() == "pl1");
     CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     mock_audiopath_dbus->done();
     mock_messages->done();
 
     /* appliance enters suspend mode */
     CHECK(appliance.set_suspend_mode());
-    expect<MockAudiopathDBus::SourceDeselectedSync>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
     std::string source_id;
-    CHECK(static_cast<int>(pswitch->cancel_pending_source_activation(*paths, source_id)) ==
+    CHECK(static_cast<int>(cancel_pending_source_activation(source_id)) ==
           static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
-    CHECK(pswitch->get_player_id() == "pl1");
+    CHECK(pswitch->get_player_id().str() == "pl1");
     CHECK(source_id == "srcB1");
 }
 
+/*!\test
+ * Switch operations are processed one after the other.
+ *
+ * A second request received while the first one is still waiting for
+ * answers from peers must not emit any D-Bus calls until the first request
+ * has been completed.
+ */
+TEST_CASE_FIXTURE(Fixture, "Requests are queued while switching is in progress")
+{
+    const AudioPath::ID *first_player_id = nullptr;
+    const AudioPath::ID *second_player_id = nullptr;
+    auto first_result = AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN;
+    auto second_result = AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN;
+    bool first_done = false;
+    bool second_done = false;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->activate_source(*paths, "srcA1", true,
+        [&first_done, &first_result, &first_player_id]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            first_done = true;
+            first_result = res;
+            first_player_id = pid;
+        });
+
+    CHECK(pswitch->is_busy());
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    pswitch->activate_source(*paths, "srcC2", true,
+        [&second_done, &second_result, &second_player_id]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            second_done = true;
+            second_result = res;
+            second_player_id = pid;
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    /* player 1 answers, source A is selected next */
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    mock_audiopath_dbus->complete_next_call();
+    CHECK_FALSE(first_done);
+    CHECK(pswitch->get_player_id().str() == "pl1");
+
+    /* source A answers, first request is done and second one starts */
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+    REQUIRE(first_done);
+    CHECK_FALSE(second_done);
+    CHECK(static_cast<int>(first_result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    REQUIRE(first_player_id != nullptr);
+    CHECK(first_player_id->str() == "pl1");
+    CHECK(pswitch->is_busy());
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    mock_audiopath_dbus->complete_all_calls();
+
+    REQUIRE(second_done);
+    CHECK(static_cast<int>(second_result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    REQUIRE(second_player_id != nullptr);
+    CHECK(second_player_id->str() == "pl2");
+    CHECK(pswitch->get_player_id().str() == "pl2");
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * The old audio source and the old player are notified at the same time, and
+ * the new player is activated only after both have answered.
+ */
+TEST_CASE_FIXTURE(Fixture, "Old source and old player are notified concurrently")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    bool done = false;
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->activate_source(*paths, "srcC2", true,
+        [&done]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            CHECK(static_cast<int>(res) ==
+                  static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+
+    /* source A answers, player 1 has not answered yet */
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+    CHECK(pswitch->get_source_id().empty());
+    CHECK(pswitch->get_player_id().str() == "pl1");
+
+    /* player 1 answers, player 2 is activated */
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+    CHECK(pswitch->get_player_id().empty());
+
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    mock_audiopath_dbus->complete_all_calls();
+
+    REQUIRE(done);
+    CHECK(pswitch->get_player_id().str() == "pl2");
+    CHECK(pswitch->get_source_id().str() == "srcC2");
+
+    /* releasing the path also notifies both at the same time */
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+
+    done = false;
+    pswitch->release_path(*paths, true,
+        [&done]
+        (AudioPath::Switch::ReleaseResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            CHECK(static_cast<int>(res) ==
+                  static_cast<int>(AudioPath::Switch::ReleaseResult::COMPLETE_RELEASE));
+            CHECK(pid == nullptr);
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+    mock_audiopath_dbus->complete_next_call();
+    CHECK_FALSE(done);
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(done);
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * Players and sources whose process has vanished are not called anymore.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching away from dead peers does not call them")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    /* process owning source A and player 1 crashes */
+    CHECK(paths->mark_source_dead(AudioPath::IDTable::get_singleton().find("srcA1")));
+    CHECK(paths->mark_player_dead(AudioPath::IDTable::get_singleton().find("pl1")));
+    CHECK_FALSE(paths->mark_player_dead(AudioPath::IDTable::get_singleton().find("pl1")));
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+
+    REQUIRE(player_id != nullptr);
+    CHECK(player_id->str() == "pl2");
+    CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::DESELECTED_ACTIVE);
+    CHECK(pswitch->get_source_id().str() == "srcC2");
+    mock_audiopath_dbus->done();
+
+    /* player 2 crashes, its source is still there */
+    CHECK(paths->mark_player_dead(AudioPath::IDTable::get_singleton().find("pl2")));
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+
+    CHECK(static_cast<int>((release_path(true, player_id, deselected_result))) ==
+          static_cast<int>(AudioPath::Switch::ReleaseResult::COMPLETE_RELEASE));
+
+    CHECK(player_id == nullptr);
+    CHECK(pswitch->get_player_id().empty());
+    CHECK(pswitch->get_source_id().empty());
+}
+
+/*!\test
+ * Activation of an audio source fails right away if the audio source or its
+ * player has vanished; the current path is left alone.
+ *
+ * The request fails as if the audio source or player was unknown, and no
+ * player ID is reported. These results do not lead to emission of the
+ * \c PathActivated signal, so clients stay in sync with the audio path which
+ * is still active.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching to dead peers fails without calling anyone")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    CHECK(paths->mark_source_dead(AudioPath::IDTable::get_singleton().find("srcC2")));
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+            "AUDIO SOURCE SWITCH: Audio source srcC2 has vanished from the bus", false);
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN));
+    CHECK(player_id == nullptr);
+    CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
+
+    CHECK(paths->mark_player_dead(AudioPath::IDTable::get_singleton().find("pl3")));
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+            "AUDIO SOURCE SWITCH: Player pl3 has vanished from the bus", false);
+    CHECK(static_cast<int>(activate_source("srcE3", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_PLAYER_UNKNOWN));
+    CHECK(player_id == nullptr);
+    CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
+
+    CHECK(pswitch->get_player_id().str() == "pl1");
+    CHECK(pswitch->get_source_id().str() == "srcA1");
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * A failed attempt to activate a vanished audio source does not cancel the
+ * deferred activation of another audio source.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching to dead peers leaves pending activation alone")
+{
+    AudioPath::Appliance appliance;
+    CHECK(appliance.set_audio_path_blocked());
+
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelectedOnHold>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+
+    CHECK(static_cast<int>(activate_source("srcB1", player_id, deselected_result,
+                                    appliance.is_audio_path_ready() == true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
+    mock_audiopath_dbus->done();
+
+    CHECK(paths->mark_source_dead(AudioPath::IDTable::get_singleton().find("srcC2")));
+
+    /* nobody is called, in particular, srcB1 is not deselected */
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_NOTICE,
+            "AUDIO SOURCE SWITCH: Audio source srcC2 has vanished from the bus", false);
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result,
+                                    appliance.is_audio_path_ready() == true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SOURCE_UNKNOWN));
+    CHECK(player_id == nullptr);
+    CHECK(deselected_result == AudioPath::Switch::DeselectedAudioSourceResult::NONE);
+    mock_audiopath_dbus->done();
+    mock_messages->done();
+
+    REQUIRE(pswitch->get_pending_activation().have_pending_activation());
+    CHECK(pswitch->get_pending_activation().get_audio_source_id().str() == "srcB1");
+
+    CHECK(appliance.set_audio_path_ready());
+
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    std::string source_id;
+    CHECK(static_cast<int>(complete_pending_source_activation(&source_id)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED_SOURCE_DEFERRED));
+    CHECK(pswitch->get_player_id().str() == "pl1");
+    CHECK(source_id == "srcB1");
+}
+
+/*!\test
+ * An audio source activation which takes too long is aborted, and the audio
+ * path is released.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching is aborted when the deadline has passed")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    pswitch->set_deadline(100);
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    /* timer has been removed after successful switch */
+    g_usleep(150 * 1000);
+    CHECK_FALSE(g_main_context_iteration(nullptr, FALSE));
+
+    bool done = false;
+    auto result = AudioPath::Switch::ActivateResult::OK_UNCHANGED;
+    player_id = nullptr;
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+
+    pswitch->activate_source(*paths, "srcC2", true,
+        [&done, &result, &player_id]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            result = res;
+            player_id = pid;
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+    mock_audiopath_dbus->complete_next_call();
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    /* player 2 does not answer in time */
+    g_usleep(150 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    CHECK_FALSE(done);
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
+            "Audio path switch: Got g-io-error-quark error 19: Operation was cancelled",
+            false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Activating audio source srcC2 took longer "
+            "than 100 ms, releasing audio path", false);
+
+    mock_audiopath_dbus->complete_next_call();
+
+    REQUIRE(done);
+    CHECK(static_cast<int>(result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED));
+    CHECK(player_id == nullptr);
+    CHECK(pswitch->get_source_id().empty());
+    CHECK(pswitch->get_player_id().empty());
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * In case the deadline passes while the old source and the old player are
+ * both being notified, the first canceled answer aborts the switch and the
+ * second one is ignored.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching with concurrent calls is aborted when the deadline has passed")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    bool done = false;
+    auto result = AudioPath::Switch::ActivateResult::OK_UNCHANGED;
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->set_deadline(100);
+    pswitch->activate_source(*paths, "srcC2", true,
+        [&done, &result]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            result = res;
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+
+    g_usleep(150 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
+            "Audio path switch: Got g-io-error-quark error 19: Operation was cancelled",
+            false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Activating audio source srcC2 took longer "
+            "than 100 ms, releasing audio path", false);
+
+    mock_audiopath_dbus->complete_next_call();
+
+    REQUIRE(done);
+    CHECK(static_cast<int>(result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED));
+    CHECK_FALSE(pswitch->is_busy());
+
+    /* late answer from player 1 */
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 0);
+    CHECK(pswitch->get_source_id().empty());
+    CHECK(pswitch->get_player_id().empty());
+}
+
+/*!\test
+ * The deadline can be set for each request by passing it in the request data.
+ */
+TEST_CASE_FIXTURE(Fixture, "Switching deadline can be overridden in request data")
+{
+    GVariantDict dict;
+    g_variant_dict_init(&dict, nullptr);
+    g_variant_dict_insert_value(&dict, "deadline_ms", g_variant_new_uint32(50));
+    auto request_data(GVariantWrapper(g_variant_dict_end(&dict)));
+
+    bool done = false;
+    auto result = AudioPath::Switch::ActivateResult::OK_UNCHANGED;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'), GVariantWrapper(request_data));
+
+    pswitch->activate_source(*paths, "srcA1", true, std::move(request_data),
+        [&done, &result]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            result = res;
+        });
+
+    g_usleep(100 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
+            "Audio path switch: Got g-io-error-quark error 19: Operation was cancelled",
+            false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Activating audio source srcA1 took longer "
+            "than 50 ms, releasing audio path", false);
+
+    mock_audiopath_dbus->complete_next_call();
+
+    REQUIRE(done);
+    CHECK(static_cast<int>(result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED));
+    CHECK(pswitch->get_player_id().empty());
+}
+
+/*!\test
+ * The deadline starts when the activation is requested. An activation whose
+ * deadline passes while it is waiting for another operation is dropped
+ * without contacting any peers.
+ */
+TEST_CASE_FIXTURE(Fixture, "Queued activation fails when its deadline passes before it is started")
+{
+    bool first_done = false;
+    auto first_result = AudioPath::Switch::ActivateResult::OK_UNCHANGED;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->activate_source(*paths, "srcA1", true,
+        [&first_done, &first_result]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            first_done = true;
+            first_result = res;
+        });
+
+    GVariantDict dict;
+    g_variant_dict_init(&dict, nullptr);
+    g_variant_dict_insert_value(&dict, "deadline_ms", g_variant_new_uint32(50));
+
+    bool second_done = false;
+    auto second_result = AudioPath::Switch::ActivateResult::OK_UNCHANGED;
+
+    pswitch->activate_source(*paths, "srcC2", true,
+        GVariantWrapper(g_variant_dict_end(&dict)),
+        [&second_done, &second_result]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            second_done = true;
+            second_result = res;
+            CHECK(pid == nullptr);
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Activation of audio source srcC2 not "
+            "started within 50 ms", false);
+
+    g_usleep(100 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    REQUIRE(second_done);
+    CHECK(static_cast<int>(second_result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_DEADLINE_EXCEEDED));
+    CHECK_FALSE(first_done);
+    CHECK(pswitch->is_busy());
+
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    mock_audiopath_dbus->complete_all_calls();
+
+    REQUIRE(first_done);
+    CHECK(static_cast<int>(first_result) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    CHECK(pswitch->get_source_id().str() == "srcA1");
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * Releasing the audio path is subject to the deadline as well. If the peers
+ * do not answer in time, the audio path is released without waiting for
+ * them.
+ */
+TEST_CASE_FIXTURE(Fixture, "Releasing is finished when the deadline has passed")
+{
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    REQUIRE(player_id != nullptr);
+    mock_audiopath_dbus->done();
+
+    bool done = false;
+    auto result = AudioPath::Switch::ReleaseResult::UNCHANGED;
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->set_deadline(100);
+    pswitch->release_path(*paths, true,
+        [&done, &result, &player_id]
+        (AudioPath::Switch::ReleaseResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+            result = res;
+            player_id = pid;
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 2);
+
+    g_usleep(150 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    CHECK_FALSE(done);
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
+            "Audio path release: Got g-io-error-quark error 19: Operation was cancelled",
+            false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Releasing audio path took longer than "
+            "100 ms, releasing without waiting", false);
+
+    mock_audiopath_dbus->complete_next_call();
+
+    REQUIRE(done);
+    CHECK(static_cast<int>(result) ==
+          static_cast<int>(AudioPath::Switch::ReleaseResult::COMPLETE_RELEASE));
+    CHECK(player_id == nullptr);
+    CHECK(pswitch->get_source_id().empty());
+    CHECK(pswitch->get_player_id().empty());
+    CHECK_FALSE(pswitch->is_busy());
+
+    /* late answer from player 1 */
+    mock_audiopath_dbus->complete_next_call();
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 0);
+}
+
+/*!\test
+ * With coalescing enabled, an audio source activation waiting in the queue is
+ * dropped when another activation is requested.
+ */
+TEST_CASE_FIXTURE(Fixture, "Queued activations are superseded by newer requests")
+{
+    std::vector<AudioPath::Switch::ActivateResult> results;
+    auto fn =
+        [&results]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            results.push_back(res);
+
+            if(res == AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED)
+                CHECK(pid == nullptr);
+        };
+
+    pswitch->set_coalescing(true);
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+    pswitch->activate_source(*paths, "srcC2", true, fn);
+    CHECK(results.empty());
+
+    pswitch->activate_source(*paths, "srcB1", true, fn);
+    REQUIRE(results.size() == 1);
+    CHECK(static_cast<int>(results[0]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED));
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    /* source C and player 2 are never contacted */
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    mock_audiopath_dbus->complete_all_calls();
+
+    REQUIRE(results.size() == 3);
+    CHECK(static_cast<int>(results[1]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    CHECK(static_cast<int>(results[2]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SAME));
+    CHECK(pswitch->get_source_id().str() == "srcB1");
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * Activations queued before a release request are not superseded.
+ */
+TEST_CASE_FIXTURE(Fixture, "Activations followed by other requests are not superseded")
+{
+    std::vector<AudioPath::Switch::ActivateResult> results;
+    auto fn =
+        [&results]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            results.push_back(res);
+        };
+    bool released = false;
+
+    pswitch->set_coalescing(true);
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+    pswitch->activate_source(*paths, "srcC2", true, fn);
+    pswitch->release_path(*paths, false,
+        [&released]
+        (AudioPath::Switch::ReleaseResult, const AudioPath::ID *,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            released = true;
+        });
+    pswitch->activate_source(*paths, "srcB1", true, fn);
+    CHECK(results.empty());
+
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('C'), "srcC2");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('2'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('B'), "srcB1");
+    mock_audiopath_dbus->complete_all_calls();
+
+    CHECK(released);
+    CHECK(results.size() == 3);
+    CHECK(pswitch->get_source_id().str() == "srcB1");
+}
+
+/*!\test
+ * Bursts of requests arriving within the coalescing window are folded into
+ * the last request, even if the switch is idle.
+ */
+TEST_CASE_FIXTURE(Fixture, "Requests within coalescing window are folded into one")
+{
+    std::vector<AudioPath::Switch::ActivateResult> results;
+    auto fn =
+        [&results]
+        (AudioPath::Switch::ActivateResult res, const AudioPath::ID *pid,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            results.push_back(res);
+        };
+
+    pswitch->set_coalescing(true, 50);
+
+    pswitch->activate_source(*paths, "srcC2", true, fn);
+    pswitch->activate_source(*paths, "srcB1", true, fn);
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 0);
+    CHECK(pswitch->is_busy());
+    REQUIRE(results.size() == 2);
+    CHECK(static_cast<int>(results[0]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED));
+    CHECK(static_cast<int>(results[1]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED));
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    g_usleep(60 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    mock_audiopath_dbus->complete_all_calls();
+
+    REQUIRE(results.size() == 3);
+    CHECK(static_cast<int>(results[2]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    CHECK_FALSE(pswitch->is_busy());
+    results.clear();
+
+    /* repeated requests for the active source are reported only once */
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+    pswitch->activate_source(*paths, "srcA1", true, fn);
+
+    g_usleep(60 * 1000);
+    while(g_main_context_iteration(nullptr, FALSE))
+        ;
+
+    REQUIRE(results.size() == 3);
+    CHECK(std::count(results.begin(), results.end(),
+                     AudioPath::Switch::ActivateResult::ERROR_SUPERSEDED) == 2);
+    CHECK(static_cast<int>(results[2]) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_UNCHANGED));
+    CHECK_FALSE(pswitch->is_busy());
+}
+
+/*!\test
+ * Answers received after the switch object has been destroyed are ignored.
+ */
+TEST_CASE("Latency histogram percentiles are rounded up to bucket boundaries")
+{
+    AudioPath::LatencyHistogram h;
+
+    CHECK(h.get_count() == 0);
+    CHECK(h.get_percentile(50) == 0);
+
+    for(int i = 0; i < 90; ++i)
+        h.add(300);
+
+    for(int i = 0; i < 9; ++i)
+        h.add(40000);
+
+    h.add(12000000);
+
+    CHECK(h.get_count() == 100);
+    CHECK(h.get_sum() == 90 * 300 + 9 * 40000 + 12000000);
+    CHECK(h.get_max() == 12000000);
+    CHECK(h.get_buckets()[1] == 90);
+    CHECK(h.get_buckets()[7] == 9);
+    CHECK(h.get_buckets().back() == 1);
+    CHECK(h.get_percentile(50) == 500);
+    CHECK(h.get_percentile(95) == 50000);
+    CHECK(h.get_percentile(99) == 50000);
+    CHECK(h.get_percentile(100) == 12000000);
+
+    h.reset();
+    CHECK(h.get_count() == 0);
+    CHECK(h.get_max() == 0);
+    CHECK(h.get_percentile(99) == 0);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Durations of switching phases are recorded")
+{
+    using Phase = AudioPath::SwitchStatistics::Phase;
+
+    const auto &stats(pswitch->get_statistics());
+    bool done = false;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->activate_source(*paths, "srcA1", true,
+        [&done]
+        (AudioPath::Switch::ActivateResult, const AudioPath::ID *,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+        });
+
+    g_usleep(3000);
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    mock_audiopath_dbus->complete_next_call();
+
+    g_usleep(30000);
+    mock_audiopath_dbus->complete_all_calls();
+    mock_audiopath_dbus->done();
+
+    REQUIRE(done);
+
+    CHECK(stats.get(Phase::ACTIVATE_PLAYER).get_count() == 1);
+    CHECK(stats.get(Phase::ACTIVATE_PLAYER).get_max() >= 3000);
+    CHECK(stats.get(Phase::ACTIVATE_PLAYER).get_max() < 30000);
+    CHECK(stats.get(Phase::SELECT_SOURCE).get_count() == 1);
+    CHECK(stats.get(Phase::SELECT_SOURCE).get_max() >= 30000);
+    CHECK(stats.get(Phase::ACTIVATION).get_count() == 1);
+    CHECK(stats.get(Phase::ACTIVATION).get_max() >= 33000);
+    CHECK(stats.get(Phase::DESELECT_SOURCE).get_count() == 0);
+    CHECK(stats.get(Phase::DEACTIVATE_PLAYER).get_count() == 0);
+    CHECK(stats.get(Phase::DEFERRED).get_count() == 0);
+
+    pswitch->reset_statistics();
+
+    for(size_t i = 0; i < AudioPath::SwitchStatistics::NUMBER_OF_PHASES; ++i)
+        CHECK(stats.get(Phase(i)).get_count() == 0);
+}
+
+/*!\test
+ * Results of activations and failed calls to peers are counted.
+ */
+TEST_CASE_FIXTURE(Fixture, "Activation results and failed peer calls are counted")
+{
+    using Phase = AudioPath::SwitchStatistics::Phase;
+    using Result = AudioPath::Switch::ActivateResult;
+
+    const auto &stats(pswitch->get_statistics());
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(Result::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    expect<MockAudiopathDBus::SourceDeselected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+    expect<MockAudiopathDBus::PlayerDeactivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, false, aupath_player_proxy('2'));
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_EMERG,
+            "Activate player: Got g-io-error-quark error 0: Mock player 2 activation failure",
+            false);
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_ERR,
+            "AUDIO SOURCE SWITCH: Activating player pl2 failed", false);
+
+    CHECK(static_cast<int>(activate_source("srcC2", player_id, deselected_result, true)) ==
+          static_cast<int>(Result::ERROR_PLAYER_FAILED));
+    mock_audiopath_dbus->done();
+    mock_messages->done();
+
+    CHECK(pswitch->get_activate_result_count(Result::OK_PLAYER_SWITCHED) == 1);
+    CHECK(pswitch->get_activate_result_count(Result::ERROR_PLAYER_FAILED) == 1);
+    CHECK(pswitch->get_activate_result_count(Result::OK_UNCHANGED) == 0);
+    CHECK(stats.get(Phase::ACTIVATE_PLAYER).get_count() == 2);
+    CHECK(stats.get_failures(Phase::ACTIVATE_PLAYER) == 1);
+    CHECK(stats.get_failures(Phase::SELECT_SOURCE) == 0);
+    CHECK(stats.get_failures(Phase::DESELECT_SOURCE) == 0);
+    CHECK(stats.get_failures(Phase::DEACTIVATE_PLAYER) == 0);
+
+    pswitch->reset_statistics();
+
+    CHECK(pswitch->get_activate_result_count(Result::OK_PLAYER_SWITCHED) == 0);
+    CHECK(pswitch->get_activate_result_count(Result::ERROR_PLAYER_FAILED) == 0);
+    CHECK(stats.get_failures(Phase::ACTIVATE_PLAYER) == 0);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Calls to peers are recorded in the flight recorder")
+{
+    using EventType = AudioPath::FlightRecorder::EventType;
+
+    auto &recorder(AudioPath::FlightRecorder::get_singleton());
+    recorder.reset();
+
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    std::vector<AudioPath::FlightRecorder::Event> events;
+    recorder.for_each([&events] (const AudioPath::FlightRecorder::Event &ev)
+                      { events.push_back(ev); });
+
+    REQUIRE(events.size() == 4);
+
+    CHECK(events[0].type_ == EventType::CALL_STARTED);
+    CHECK(std::string(events[0].name_) == "Activate");
+    CHECK(AudioPath::ID(events[0].id_).str() == "pl1");
+    CHECK(events[1].type_ == EventType::CALL_FINISHED);
+    CHECK(events[1].arg_ == events[0].arg_);
+    CHECK_FALSE(events[1].failed_);
+
+    CHECK(events[2].type_ == EventType::CALL_STARTED);
+    CHECK(std::string(events[2].name_) == "Selected");
+    CHECK(AudioPath::ID(events[2].id_).str() == "srcA1");
+    CHECK(events[2].arg_ != events[0].arg_);
+    CHECK(events[3].type_ == EventType::CALL_FINISHED);
+    CHECK(events[3].arg_ == events[2].arg_);
+
+    CHECK(events[0].timestamp_us_ <= events[1].timestamp_us_);
+    CHECK(events[1].timestamp_us_ <= events[2].timestamp_us_);
+}
+
+TEST_CASE("Flight recorder keeps most recent events and exports Chrome trace")
+{
+    using EventType = AudioPath::FlightRecorder::EventType;
+
+    auto &recorder(AudioPath::FlightRecorder::get_singleton());
+    recorder.reset();
+
+    CHECK(recorder.size() == 0);
+
+    const auto id(AudioPath::IDTable::get_singleton().intern("odd\"id\\"));
+
+    for(size_t i = 0; i < AudioPath::FlightRecorder::CAPACITY + 10; ++i)
+        recorder.record(EventType::REQUEST_RECEIVED, "RequestSource", id, i);
+
+    CHECK(recorder.size() == AudioPath::FlightRecorder::CAPACITY);
+    CHECK(recorder.get_number_of_lost_events() == 10);
+
+    uint32_t expected = 10;
+    bool in_order = true;
+
+    recorder.for_each(
+        [&expected, &in_order] (const AudioPath::FlightRecorder::Event &ev)
+        {
+            if(ev.arg_ != expected++)
+                in_order = false;
+        });
+
+    CHECK(in_order);
+
+    recorder.reset();
+    recorder.record(EventType::APPLIANCE_STATE, "SetReadyState",
+                    AudioPath::ID(), 2 | (1 << 8));
+    recorder.record(EventType::PENDING_QUEUED, "RequestSource", id, 1);
+    const uint32_t call = recorder.record_call_started("Deselected", id);
+    recorder.record_call_finished("Deselected", id, call, true);
+
+    const std::string trace(recorder.to_chrome_trace());
+
+    CHECK(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+    CHECK(trace.find("\"audio_state\":2,\"power_state\":1") != std::string::npos);
+    CHECK(trace.find("\"cat\":\"pending_queued\"") != std::string::npos);
+    CHECK(trace.find("\"ph\":\"b\"") != std::string::npos);
+    CHECK(trace.find("\"ph\":\"e\"") != std::string::npos);
+    CHECK(trace.find("\"failed\":true") != std::string::npos);
+    CHECK(trace.find("\"odd\\\"id\\\\\"") != std::string::npos);
+    CHECK(trace.find("\"lost_events\":0") != std::string::npos);
+    CHECK(trace.substr(trace.length() - 3) == "]}\n");
+}
+
+/*!\test
+ * Answers of peers are accounted per peer and method.
+ */
+TEST_CASE_FIXTURE(Fixture, "Calls to peers are accounted in peer statistics")
+{
+    using Method = AudioPath::PeerStatistics::Method;
+
+    auto &stats(AudioPath::PeerStatistics::get_singleton());
+    stats.reset();
+
+    const AudioPath::ID *player_id;
+    AudioPath::Switch::DeselectedAudioSourceResult deselected_result;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+    expect<MockAudiopathDBus::SourceSelected>(mock_audiopath_dbus, true, aupath_source_proxy('A'), "srcA1");
+
+    CHECK(static_cast<int>(activate_source("srcA1", player_id, deselected_result, true)) ==
+          static_cast<int>(AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED));
+    mock_audiopath_dbus->done();
+
+    const auto &peers(stats.get_peers());
+    const auto &ids(AudioPath::IDTable::get_singleton());
+
+    const auto player(peers.find(ids.find("pl1")));
+    REQUIRE(player != peers.end());
+    CHECK(player->second.bus_name_ == ":1.1");
+    CHECK(player->second.methods_[size_t(Method::ACTIVATE)].durations_.get_count() == 1);
+    CHECK(player->second.methods_[size_t(Method::ACTIVATE)].failures_ == 0);
+    CHECK(player->second.methods_[size_t(Method::DEACTIVATE)].durations_.get_count() == 0);
+
+    const auto source(peers.find(ids.find("srcA1")));
+    REQUIRE(source != peers.end());
+    CHECK(source->second.bus_name_ == ":1.10");
+    CHECK(source->second.methods_[size_t(Method::SELECTED)].durations_.get_count() == 1);
+    CHECK(source->second.methods_[size_t(Method::SELECTED_ON_HOLD)].durations_.get_count() == 0);
+
+    stats.reset();
+
+    CHECK(player->second.methods_[size_t(Method::ACTIVATE)].durations_.get_count() == 0);
+}
+
+/*!\test
+ * A call taking longer than the 99th percentile of previous calls is logged,
+ * and a peer restarted under a new bus name starts over.
+ */
+TEST_CASE_FIXTURE(Fixture, "Peer calls slower than historical p99 are logged")
+{
+    using Method = AudioPath::PeerStatistics::Method;
+
+    auto &stats(AudioPath::PeerStatistics::get_singleton());
+    stats.reset();
+
+    const auto id(AudioPath::IDTable::get_singleton().intern("slowpl"));
+
+    for(uint64_t i = 0; i < AudioPath::PeerStatistics::MIN_CALLS_FOR_P99; ++i)
+        stats.add("Activate", id, ":1.50", i < 10 ? 5000 : 1000, i == 0);
+
+    const auto &m(stats.get_peers().at(id).methods_[size_t(Method::ACTIVATE)]);
+
+    CHECK(m.durations_.get_count() == AudioPath::PeerStatistics::MIN_CALLS_FOR_P99);
+    CHECK(m.failures_ == 1);
+    CHECK(m.above_p99_ == 0);
+    CHECK(m.ewma_us_ >= 1000);
+    CHECK(m.ewma_us_ < 1100);
+
+    /* not above p99 */
+    stats.add("Activate", id, ":1.50", 5000, false);
+    CHECK(m.above_p99_ == 0);
+
+    expect<MockMessages::MsgError>(mock_messages, 0, LOG_WARNING,
+            "Activate of slowpl (:1.50) took 50.0 ms, above its p99 of 5.0 ms (average 1.5 ms)",
+            false);
+    stats.add("Activate", id, ":1.50", 50000, false);
+    mock_messages->done();
+    CHECK(m.above_p99_ == 1);
+
+    /* unknown methods are ignored */
+    stats.add("GetPaths", id, ":1.50", 50000, false);
+    CHECK(m.durations_.get_count() == AudioPath::PeerStatistics::MIN_CALLS_FOR_P99 + 2);
+
+    /* restarted peer */
+    expect<MockMessages::MsgVinfo>(mock_messages, MESSAGE_LEVEL_DIAG,
+            "Peer slowpl moved from :1.50 to :1.51, restarting its statistics", false);
+    stats.add("Deactivate", id, ":1.51", 2000, false);
+    mock_messages->done();
+
+    CHECK(stats.get_peers().at(id).bus_name_ == ":1.51");
+    CHECK(m.durations_.get_count() == 0);
+    CHECK(m.above_p99_ == 0);
+    CHECK(stats.get_peers().at(id).methods_[size_t(Method::DEACTIVATE)].ewma_us_ == 2000);
+}
+
+TEST_CASE_FIXTURE(Fixture, "Late answers from peers are ignored after shutdown")
+{
+    bool done = false;
+
+    expect<MockAudiopathDBus::PlayerActivate>(mock_audiopath_dbus, true, aupath_player_proxy('1'));
+
+    pswitch->activate_source(*paths, "srcA1", true,
+        [&done]
+        (AudioPath::Switch::ActivateResult, const AudioPath::ID *,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+        });
+
+    pswitch->release_path(*paths, true,
+        [&done]
+        (AudioPath::Switch::ReleaseResult, const AudioPath::ID *,
+         AudioPath::Switch::DeselectedAudioSourceResult)
+        {
+            done = true;
+        });
+
+    CHECK(mock_audiopath_dbus->get_number_of_calls_in_flight() == 1);
+
+    pswitch = nullptr;
+    mock_audiopath_dbus->complete_all_calls();
+
+    CHECK_FALSE(done);
+}
+
 /*!@}*/
@@ -0,0 +1,648 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of TAPSwitch.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include <map>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "audiopath.hh"
+#include "audiopathswitch.hh"
+#include "scheduler.hh"
+#include "de_tahifi_audiopath.h"
+#include "fake_peers.hh"
+#include "messages.h"
+
+/*!
+ * \addtogroup audiopath_tests
+ *
+ * Deterministic simulation of audio path switching on a virtual clock.
+ *
+ * The switch runs on a #AudioPath::Scheduler whose clock only advances from
+ * one timer to the next, and the D-Bus methods of players and audio sources
+ * are replaced by fakes which answer through that scheduler after a random
+ * latency, honoring cancellation like GDBus does. This way, thousands of
+ * random interleavings of audio source requests, path releases, appliance
+ * state changes, and slow peers run in a fraction of a second, and each of
+ * them can be reproduced from its seed.
+ *
+ * For each interleaving, it is checked that each request is answered exactly
+ * once and within a latency budget derived from the operations queued in
+ * front of it, that nothing is left in flight afterwards, and that the switch
+ * ends up in a consistent state.
+ */
+/*!@{*/
+
+/*!
+ * Virtual clock with one-shot timers.
+ *
+ * Timers due at the same time fire in order of creation.
+ */
+class VirtualScheduler: public AudioPath::Scheduler
+{
+  private:
+    int64_t now_us_;
+    unsigned int next_timer_id_;
+    std::map<std::pair<int64_t, unsigned int>, TimerFn> timers_;
+    std::map<unsigned int, int64_t> due_times_;
+
+  public:
+    VirtualScheduler(const VirtualScheduler &) = delete;
+    VirtualScheduler &operator=(const VirtualScheduler &) = delete;
+
+    explicit VirtualScheduler():
+        now_us_(0),
+        next_timer_id_(0)
+    {}
+
+    int64_t now_us() const final override { return now_us_; }
+
+    unsigned int add_timer(unsigned int timeout_ms, TimerFn &&fn) final override
+    {
+        const unsigned int id = ++next_timer_id_;
+        const int64_t due = now_us_ + int64_t(timeout_ms) * 1000;
+
+        timers_.emplace(std::make_pair(due, id), std::move(fn));
+        due_times_[id] = due;
+
+        return id;
+    }
+
+    void remove_timer(unsigned int timer_id) final override
+    {
+        const auto it = due_times_.find(timer_id);
+        REQUIRE(it != due_times_.end());
+
+        timers_.erase(std::make_pair(it->second, timer_id));
+        due_times_.erase(it);
+    }
+
+    size_t get_number_of_timers() const { return timers_.size(); }
+
+    /*!
+     * Fire all timers due up to given time, then set clock to that time.
+     */
+    void run_until(int64_t time_us)
+    {
+        while(!timers_.empty() && timers_.begin()->first.first <= time_us)
+            fire_next();
+
+        now_us_ = std::max(now_us_, time_us);
+    }
+
+    /*!
+     * Fire timers until there are none left.
+     */
+    void run_until_idle()
+    {
+        while(!timers_.empty())
+            fire_next();
+    }
+
+  private:
+    void fire_next()
+    {
+        auto it = timers_.begin();
+        auto fn(std::move(it->second));
+
+        now_us_ = it->first.first;
+        due_times_.erase(it->first.second);
+        timers_.erase(it);
+
+        fn();
+    }
+};
+
+/*!
+ * Answer time and reliability of a simulated peer.
+ */
+struct SimPeer
+{
+    unsigned int min_ms_;
+    unsigned int max_ms_;
+    unsigned int fail_permille_;
+};
+
+class Simulation;
+
+static Simulation *simulation;
+
+/*!
+ * D-Bus method call to a simulated peer which has not been answered yet.
+ *
+ * A pointer to this structure is passed as \c GAsyncResult to the completion
+ * callback, and it is evaluated by the \c _finish() functions.
+ */
+struct SimCall
+{
+    GObject *source_object_;
+    GAsyncReadyCallback callback_;
+    gpointer user_data_;
+    GCancellable *cancellable_;
+    gulong cancel_handler_;
+    unsigned int timer_;
+    bool failed_;
+    bool cancelled_;
+};
+
+/*!
+ * One random interleaving of requests, appliance state changes, and peer
+ * answers.
+ */
+class Simulation: public FakePeers::Transport
+{
+  public:
+    struct Parameters
+    {
+        size_t number_of_players_;
+        size_t sources_per_player_;
+        SimPeer fast_peer_;
+        SimPeer slow_peer_;
+        unsigned int slow_peers_permille_;
+        unsigned int deadline_ms_;
+        bool coalesce_;
+        unsigned int coalescing_window_ms_;
+        unsigned int appliance_flaps_permille_;
+        size_t number_of_events_;
+        unsigned int max_event_gap_ms_;
+    };
+
+  private:
+    enum class Kind
+    {
+        ACTIVATE,
+        RELEASE,
+        COMPLETE_PENDING,
+        CANCEL_PENDING,
+    };
+
+    /*!
+     * Request submitted to the switch, not answered yet.
+     */
+    struct Request
+    {
+        unsigned int serial_;
+        Kind kind_;
+        int64_t issued_us_;
+        int64_t budget_us_;
+    };
+
+    const Parameters &params_;
+    std::mt19937 rng_;
+    VirtualScheduler scheduler_;
+    AudioPath::Paths paths_;
+    std::unique_ptr<AudioPath::Switch> sw_;
+
+    std::vector<SimPeer> players_;
+    std::vector<SimPeer> sources_;
+    std::vector<std::string> source_ids_;
+    unsigned int max_peer_latency_ms_;
+    bool reliable_peers_only_;
+
+    bool appliance_ready_;
+    std::deque<Request> requests_in_flight_;
+    unsigned int next_serial_;
+    size_t answered_;
+    size_t calls_in_flight_;
+
+  public:
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+    explicit Simulation(const Parameters &params, unsigned int seed):
+        params_(params),
+        rng_(seed),
+        max_peer_latency_ms_(0),
+        reliable_peers_only_(false),
+        appliance_ready_(true),
+        next_serial_(0),
+        answered_(0),
+        calls_in_flight_(0)
+    {
+        simulation = this;
+        FakePeers::set_transport(this);
+
+        players_.reserve(params_.number_of_players_);
+        sources_.reserve(params_.number_of_players_ * params_.sources_per_player_);
+
+        for(size_t p = 0; p < params_.number_of_players_; ++p)
+        {
+            const std::string player_id("pl" + std::to_string(p));
+
+            players_.push_back(mk_peer());
+            paths_.add_player(AudioPath::Player(
+                player_id.c_str(), "Player",
+                std::make_unique<AudioPath::Player::PType>(
+                    reinterpret_cast<tdbusaupathPlayer *>(&players_.back()))));
+
+            for(size_t s = 0; s < params_.sources_per_player_; ++s)
+            {
+                source_ids_.push_back("src" + std::to_string(sources_.size()));
+                sources_.push_back(mk_peer());
+                paths_.add_source(AudioPath::Source(
+                    source_ids_.back().c_str(), "Source", player_id.c_str(),
+                    std::make_unique<AudioPath::Source::PType>(
+                        reinterpret_cast<tdbusaupathSource *>(&sources_.back()))));
+            }
+        }
+
+        sw_ = std::make_unique<AudioPath::Switch>(scheduler_);
+        sw_->set_deadline(params_.deadline_ms_);
+        sw_->set_coalescing(params_.coalesce_, params_.coalescing_window_ms_);
+    }
+
+    ~Simulation()
+    {
+        sw_ = nullptr;
+        FakePeers::set_transport(nullptr);
+        simulation = nullptr;
+    }
+
+    /*!
+     * Throw random events at the switch, then let everything settle.
+     */
+    void run()
+    {
+        for(size_t i = 0; i < params_.number_of_events_; ++i)
+        {
+            scheduler_.run_until(
+                scheduler_.now_us() +
+                int64_t(random(0, params_.max_event_gap_ms_)) * 1000);
+            issue_random_event();
+        }
+
+        scheduler_.run_until_idle();
+    }
+
+    /*!
+     * Check that everything has settled and the switch is consistent.
+     */
+    void check_final_state()
+    {
+        CHECK(requests_in_flight_.empty());
+        CHECK(answered_ == next_serial_);
+        CHECK(calls_in_flight_ == 0);
+        CHECK(scheduler_.get_number_of_timers() == 0);
+        CHECK_FALSE(sw_->is_busy());
+
+        if(appliance_ready_)
+            CHECK_FALSE(sw_->get_pending_activation().have_pending_activation());
+
+        if(!sw_->get_source_id().empty())
+        {
+            const auto path(paths_.lookup_path(sw_->get_source_id()));
+            REQUIRE(path.second != nullptr);
+            CHECK(path.second->id_ == sw_->get_player_id());
+        }
+
+        /* appliance gets ready and stays, all peers behave */
+        if(!appliance_ready_)
+        {
+            appliance_ready_ = true;
+            complete_pending();
+            scheduler_.run_until_idle();
+            CHECK_FALSE(sw_->get_pending_activation().have_pending_activation());
+        }
+
+        reliable_peers_only_ = true;
+
+        const size_t i = random(0, source_ids_.size() - 1);
+        const auto &source_id(source_ids_[i]);
+        bool is_ok = false;
+
+        sw_->activate_source(paths_, source_id.c_str(), true,
+            [&is_ok]
+            (AudioPath::Switch::ActivateResult result, const AudioPath::ID *,
+             AudioPath::Switch::DeselectedAudioSourceResult)
+            {
+                is_ok = result == AudioPath::Switch::ActivateResult::OK_UNCHANGED ||
+                        result == AudioPath::Switch::ActivateResult::OK_PLAYER_SAME ||
+                        result == AudioPath::Switch::ActivateResult::OK_PLAYER_SWITCHED;
+            });
+        scheduler_.run_until_idle();
+
+        CHECK(is_ok);
+        CHECK(sw_->get_source_id() == AudioPath::IDTable::get_singleton().find(source_id));
+        CHECK(sw_->get_player_id() ==
+              AudioPath::IDTable::get_singleton().find(
+                "pl" + std::to_string(i / params_.sources_per_player_)));
+        CHECK(calls_in_flight_ == 0);
+        CHECK(scheduler_.get_number_of_timers() == 0);
+    }
+
+    const AudioPath::Switch &get_switch() const { return *sw_; }
+
+    void call(GObject *proxy, GCancellable *cancellable,
+              GAsyncReadyCallback callback, gpointer user_data) final override;
+    gboolean finish(GAsyncResult *res, GError **error) final override;
+
+  private:
+    unsigned int random(unsigned int min, unsigned int max)
+    {
+        return std::uniform_int_distribution<unsigned int>(min, max)(rng_);
+    }
+
+    SimPeer mk_peer()
+    {
+        const SimPeer &peer(random(0, 999) < params_.slow_peers_permille_
+                            ? params_.slow_peer_
+                            : params_.fast_peer_);
+        max_peer_latency_ms_ = std::max(max_peer_latency_ms_, peer.max_ms_);
+        return peer;
+    }
+
+    /*!
+     * Upper bound for the time the switch needs for one operation.
+     *
+     * Activations call at most three peers in sequence (old audio source and
+     * old player concurrently, then new player, then new audio source) and
+     * are cut short by the deadline, if any. Other operations call fewer
+     * peers.
+     */
+    int64_t get_operation_budget_us(Kind kind) const
+    {
+        int64_t budget_ms = 3 * max_peer_latency_ms_;
+
+        if(kind == Kind::ACTIVATE)
+        {
+            if(params_.deadline_ms_ > 0)
+                budget_ms = std::min(budget_ms, int64_t(params_.deadline_ms_));
+
+            budget_ms += params_.coalescing_window_ms_;
+        }
+
+        return budget_ms * 1000;
+    }
+
+    /*!
+     * Register request, return function to be called when it is answered.
+     *
+     * The switch executes operations one after the other, so the budget for
+     * a request is the sum of the budgets of all requests in flight plus its
+     * own.
+     */
+    template <typename... Args>
+    std::function<void(Args...)> mk_done_fn(Kind kind)
+    {
+        int64_t budget_us = get_operation_budget_us(kind);
+
+        for(const auto &r : requests_in_flight_)
+            budget_us += get_operation_budget_us(r.kind_);
+
+        const unsigned int serial = next_serial_++;
+        requests_in_flight_.push_back(Request{serial, kind,
+                                              scheduler_.now_us(), budget_us});
+
+        return [this, serial] (Args...) { request_answered(serial); };
+    }
+
+    void request_answered(unsigned int serial)
+    {
+        const auto it =
+            std::find_if(requests_in_flight_.begin(), requests_in_flight_.end(),
+                         [serial] (const Request &r) { return r.serial_ == serial; });
+
+        REQUIRE(it != requests_in_flight_.end());
+        CHECK(scheduler_.now_us() - it->issued_us_ <= it->budget_us_);
+
+        requests_in_flight_.erase(it);
+        ++answered_;
+    }
+
+    void complete_pending()
+    {
+        sw_->complete_pending_source_activation(
+            paths_,
+            mk_done_fn<AudioPath::Switch::ActivateResult,
+                       const AudioPath::ID &>(Kind::COMPLETE_PENDING));
+    }
+
+    void issue_random_event()
+    {
+        const unsigned int what = random(0, 999);
+
+        if(what < params_.appliance_flaps_permille_)
+        {
+            /* same as D-Bus method SetReadyState() */
+            appliance_ready_ = !appliance_ready_;
+
+            if(appliance_ready_)
+                complete_pending();
+            else if(random(0, 1) == 0)
+                sw_->cancel_pending_source_activation(
+                    paths_,
+                    mk_done_fn<AudioPath::Switch::ActivateResult,
+                               const AudioPath::ID &>(Kind::CANCEL_PENDING));
+
+            return;
+        }
+
+        if(random(0, 99) < 80)
+            sw_->activate_source(
+                paths_,
+                source_ids_[random(0, source_ids_.size() - 1)].c_str(),
+                appliance_ready_,
+                mk_done_fn<AudioPath::Switch::ActivateResult,
+                           const AudioPath::ID *,
+                           AudioPath::Switch::DeselectedAudioSourceResult>(Kind::ACTIVATE));
+        else
+            sw_->release_path(
+                paths_, random(0, 1) == 0,
+                mk_done_fn<AudioPath::Switch::ReleaseResult,
+                           const AudioPath::ID *,
+                           AudioPath::Switch::DeselectedAudioSourceResult>(Kind::RELEASE));
+    }
+
+    static void answer(SimCall *c)
+    {
+        if(c->cancellable_ != nullptr)
+        {
+            if(c->cancel_handler_ != 0)
+                g_cancellable_disconnect(c->cancellable_, c->cancel_handler_);
+
+            g_object_unref(c->cancellable_);
+        }
+
+        --simulation->calls_in_flight_;
+        c->callback_(c->source_object_, reinterpret_cast<GAsyncResult *>(c),
+                     c->user_data_);
+        delete c;
+    }
+
+    /*!
+     * GDBus reports cancellation right away, not when the peer answers.
+     */
+    static void cancelled(GCancellable *cancellable, gpointer user_data)
+    {
+        auto *c = static_cast<SimCall *>(user_data);
+
+        if(c->cancelled_)
+            return;
+
+        c->cancelled_ = true;
+        simulation->scheduler_.remove_timer(c->timer_);
+        c->timer_ = simulation->scheduler_.add_timer(0, [c] { answer(c); });
+    }
+};
+
+void Simulation::call(GObject *proxy, GCancellable *cancellable,
+                      GAsyncReadyCallback callback, gpointer user_data)
+{
+    const auto &peer(*reinterpret_cast<const SimPeer *>(proxy));
+    auto *c = new SimCall{proxy, callback,
+                          user_data, cancellable, 0, 0,
+                          !reliable_peers_only_ &&
+                          random(0, 999) < peer.fail_permille_,
+                          false};
+
+    ++calls_in_flight_;
+
+    const unsigned int latency_ms =
+        reliable_peers_only_ ? 0 : random(peer.min_ms_, peer.max_ms_);
+
+    if(cancellable != nullptr)
+    {
+        g_object_ref(cancellable);
+
+        if(g_cancellable_is_cancelled(cancellable))
+        {
+            c->cancelled_ = true;
+            c->timer_ = scheduler_.add_timer(0, [c] { answer(c); });
+            return;
+        }
+    }
+
+    c->timer_ = scheduler_.add_timer(latency_ms, [c] { answer(c); });
+
+    if(cancellable != nullptr)
+        c->cancel_handler_ =
+            g_cancellable_connect(cancellable, G_CALLBACK(cancelled), c, nullptr);
+}
+
+gboolean Simulation::finish(GAsyncResult *res, GError **error)
+{
+    const auto *c = reinterpret_cast<const SimCall *>(res);
+
+    if(c->cancelled_)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                            "Operation was cancelled");
+        return FALSE;
+    }
+
+    if(c->failed_)
+    {
+        g_set_error_literal(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+                            "Simulated failure");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+namespace DBus
+{
+
+/* peers are owned by the simulation */
+template<>
+Proxy<_tdbusaupathPlayer>::~Proxy() {}
+
+template<>
+Proxy<_tdbusaupathSource>::~Proxy() {}
+
+}
+
+static void simulate(const Simulation::Parameters &params,
+                     unsigned int number_of_runs)
+{
+    msg_enable_syslog(false);
+    msg_set_verbose_level(MESSAGE_LEVEL_QUIET);
+
+    for(unsigned int seed = 1; seed <= number_of_runs; ++seed)
+    {
+        INFO("Seed " << seed);
+
+        Simulation sim(params, seed);
+        sim.run();
+        sim.check_final_state();
+    }
+}
+
+TEST_SUITE_BEGIN("Audio path switch simulation");
+
+TEST_CASE("Random requests with fast peers")
+{
+    static const Simulation::Parameters params
+    {
+        3, 2, SimPeer{0, 5, 0}, SimPeer{0, 5, 0}, 0,
+        0, false, 0, 0, 40, 10,
+    };
+
+    simulate(params, 1000);
+}
+
+TEST_CASE("Random requests with slow peers and deadline")
+{
+    static const Simulation::Parameters params
+    {
+        3, 2, SimPeer{1, 10, 0}, SimPeer{200, 2000, 0}, 300,
+        500, false, 0, 0, 40, 300,
+    };
+
+    simulate(params, 1000);
+}
+
+TEST_CASE("Random requests with appliance flapping")
+{
+    static const Simulation::Parameters params
+    {
+        3, 2, SimPeer{1, 10, 0}, SimPeer{50, 300, 0}, 200,
+        0, false, 0, 250, 40, 100,
+    };
+
+    simulate(params, 1000);
+}
+
+TEST_CASE("Random requests with coalescing, flapping, slow and failing peers")
+{
+    static const Simulation::Parameters params
+    {
+        4, 3, SimPeer{1, 10, 20}, SimPeer{100, 1500, 50}, 250,
+        800, true, 20, 150, 60, 200,
+    };
+
+    simulate(params, 1000);
+}
+
+TEST_SUITE_END();
+
+/*!@}*/